@@ -20,6 +20,13 @@ std::string generateRandomString(size_t length, std::mt19937 &gen) {
     return result;
 }
 
+// The engine takes the row cache capacity in bytes; this fits about ROW_CACHE_ENTRIES keys with values of value_size
+constexpr size_t ROW_CACHE_ENTRIES = 1000;
+
+size_t rowCacheBytes(size_t value_size) {
+    return ROW_CACHE_ENTRIES * RowCache::charge("key_000000", Entry{std::string(value_size, 'x'), 0, EntryType::PUT});
+}
+
 struct BenchmarkResult {
     double throughput_ops_sec;
     double latency_avg_us;
@@ -269,7 +276,7 @@ int main() {
     std::vector<BenchmarkResult> write_results;
     for (size_t threads : thread_counts) {
         std::filesystem::remove_all("data");
-        StorageEngine engine("data", 0);
+        StorageEngine engine("data", EngineOptions{.row_cache_bytes = 0});
 
         auto result = benchmarkConcurrentWrites(engine, threads, ops_per_thread, value_size);
         write_results.push_back(result);
@@ -283,7 +290,7 @@ int main() {
     // Pre-populate data once
     {
         std::filesystem::remove_all("data");
-        StorageEngine engine("data", 1000);
+        StorageEngine engine("data", EngineOptions{.row_cache_bytes = rowCacheBytes(value_size)});
         std::mt19937 gen(42);
         for (size_t i = 0; i < total_keys; ++i) {
             std::string key = "key_" + std::to_string(i);
@@ -294,7 +301,7 @@ int main() {
 
     std::vector<BenchmarkResult> read_results;
     for (size_t threads : thread_counts) {
-        StorageEngine engine("data", 1000);
+        StorageEngine engine("data", EngineOptions{.row_cache_bytes = rowCacheBytes(value_size)});
         engine.recover();
 
         auto result = benchmarkConcurrentReads(engine, threads, ops_per_thread, total_keys);
@@ -309,7 +316,7 @@ int main() {
     std::vector<BenchmarkResult> mixed_results;
     for (size_t threads : thread_counts) {
         std::filesystem::remove_all("data");
-        StorageEngine engine("data", 1000);
+        StorageEngine engine("data", EngineOptions{.row_cache_bytes = rowCacheBytes(value_size)});
 
         // Pre-populate with half the keys
         std::mt19937 gen(42);
@@ -331,7 +338,7 @@ int main() {
     std::vector<BenchmarkResult> write_heavy_results;
     for (size_t threads : thread_counts) {
         std::filesystem::remove_all("data");
-        StorageEngine engine("data", 1000);
+        StorageEngine engine("data", EngineOptions{.row_cache_bytes = rowCacheBytes(value_size)});
 
         auto result = benchmarkMixedWorkload(engine, threads, ops_per_thread, value_size, total_keys, 20);
         write_heavy_results.push_back(result);
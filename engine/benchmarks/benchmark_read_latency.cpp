@@ -1,6 +1,7 @@
 #include "engine.h"
 #include <algorithm>
 #include <chrono>
+#include <cmath>
 #include <iomanip>
 #include <iostream>
 #include <random>
@@ -68,7 +69,7 @@ void printStats(const std::string &name, const LatencyStats &stats) {
 
 void benchmarkMemTableReads(size_t num_keys, size_t num_reads) {
     std::filesystem::remove_all("data");
-    StorageEngine engine("data", 0);
+    StorageEngine engine("data", EngineOptions{.row_cache_bytes = 0});
 
     // Insert data into memtable (without flushing)
     for (size_t i = 0; i < num_keys; ++i) {
@@ -102,7 +103,7 @@ void benchmarkMemTableReads(size_t num_keys, size_t num_reads) {
 
 void benchmarkSSTableReads(size_t num_keys, size_t num_reads) {
     std::filesystem::remove_all("data");
-    StorageEngine engine("data", 0);
+    StorageEngine engine("data", EngineOptions{.row_cache_bytes = 0});
 
     // Insert and flush to create SSTables
     for (size_t i = 0; i < num_keys; ++i) {
@@ -137,7 +138,7 @@ void benchmarkSSTableReads(size_t num_keys, size_t num_reads) {
 
 void benchmarkCachedReads(size_t num_keys, size_t num_reads) {
     std::filesystem::remove_all("data");
-    StorageEngine engine("data", 1000);
+    StorageEngine engine("data", EngineOptions{.row_cache_bytes = 1024 * 1024});
 
     // Insert and flush
     for (size_t i = 0; i < num_keys; ++i) {
@@ -177,23 +178,28 @@ void benchmarkCachedReads(size_t num_keys, size_t num_reads) {
     printStats("Cached Reads (Hot Working Set)", stats);
 }
 
-void benchmarkNonExistentKeys(size_t num_keys, size_t num_reads) {
+// Clients polling a small set of absent keys; with negative caching only the first poll of each reaches the tables
+void benchmarkNonExistentKeys(size_t num_keys, size_t num_reads, bool negative_cache) {
     std::filesystem::remove_all("data");
-    StorageEngine engine("data", 0);
+    EngineOptions options;
+    options.row_cache_negative_lookups = negative_cache;
+    StorageEngine engine("data", options);
 
-    // Insert some data
+    // Insert some data across several L0 files, each of which a miss has to probe
     for (size_t i = 0; i < num_keys; ++i) {
         std::string key = "key_" + std::to_string(i);
         std::string value = generateRandomString(100);
         engine.put(key, value);
+        if ((i + 1) % (num_keys / 4) == 0) {
+            engine.flush();
+        }
     }
-    engine.flush();
 
     std::vector<double> latencies;
     latencies.reserve(num_reads);
 
     for (size_t i = 0; i < num_reads; ++i) {
-        std::string key = "nonexistent_" + std::to_string(i);
+        std::string key = "nonexistent_" + std::to_string(i % 100);
         Entry result;
 
         auto start = std::chrono::high_resolution_clock::now();
@@ -205,7 +211,68 @@ void benchmarkNonExistentKeys(size_t num_keys, size_t num_reads) {
     }
 
     auto stats = calculateStats(latencies);
-    printStats("Non-Existent Key Reads (Bloom Filter Test)", stats);
+    printStats(negative_cache ? "Non-Existent Key Reads (Negative Cache)" : "Non-Existent Key Reads (Bloom Filter Only)", stats);
+}
+
+// Zipfian reads over a hot key space, interrupted by sequential sweeps over keys that are read only once
+void benchmarkScanResistance(RowCachePolicy policy, const std::string &name, size_t num_keys, size_t num_reads) {
+    std::filesystem::remove_all("data");
+    EngineOptions options;
+    options.row_cache_bytes = 512 * 1024;
+    options.row_cache_policy = policy;
+    StorageEngine engine("data", options);
+
+    const size_t num_scan_keys = num_keys;
+    for (size_t i = 0; i < num_keys; ++i) {
+        engine.put("key_" + std::to_string(i), generateRandomString(100));
+    }
+    for (size_t i = 0; i < num_scan_keys; ++i) {
+        engine.put("scan_" + std::to_string(i), generateRandomString(100));
+    }
+    engine.flush();
+
+    std::vector<double> weights(num_keys);
+    for (size_t i = 0; i < num_keys; ++i) {
+        weights[i] = 1.0 / std::pow(static_cast<double>(i + 1), 0.99);
+    }
+    std::mt19937 gen(42);
+    std::discrete_distribution<size_t> zipf(weights.begin(), weights.end());
+
+    std::vector<double> latencies;
+    latencies.reserve(num_reads);
+
+    // Hits on the Zipfian reads alone; the scanned keys are never read twice and always miss
+    uint64_t scan_hits = 0;
+    const size_t scan_every = 1000;
+    const size_t scan_length = 2000;
+    size_t scan_cursor = 0;
+    for (size_t i = 0; i < num_reads; ++i) {
+        if (i > 0 && i % scan_every == 0) {
+            uint64_t hits_before = engine.rowCacheStats().hits;
+            for (size_t j = 0; j < scan_length; ++j) {
+                Entry result;
+                engine.get("scan_" + std::to_string(scan_cursor++ % num_scan_keys), result);
+            }
+            scan_hits += engine.rowCacheStats().hits - hits_before;
+        }
+
+        std::string key = "key_" + std::to_string(zipf(gen));
+        Entry result;
+
+        auto start = std::chrono::high_resolution_clock::now();
+        engine.get(key, result);
+        auto end = std::chrono::high_resolution_clock::now();
+
+        latencies.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+    }
+
+    RowCacheStats cacheStats = engine.rowCacheStats();
+    double zipfHitRate = static_cast<double>(cacheStats.hits - scan_hits) / static_cast<double>(num_reads);
+    auto stats = calculateStats(latencies);
+    printStats(name, stats);
+    std::cout << std::setprecision(1);
+    std::cout << "  Zipfian hit rate:    " << zipfHitRate * 100.0 << "%\n";
+    std::cout << "  Admissions rejected: " << cacheStats.rejected << "\n\n";
 }
 
 int main() {
@@ -217,7 +284,10 @@ int main() {
     benchmarkMemTableReads(NUM_KEYS, NUM_READS);
     benchmarkSSTableReads(NUM_KEYS, NUM_READS);
     benchmarkCachedReads(NUM_KEYS, NUM_READS);
-    benchmarkNonExistentKeys(NUM_KEYS, NUM_READS);
+    benchmarkNonExistentKeys(NUM_KEYS, NUM_READS, false);
+    benchmarkNonExistentKeys(NUM_KEYS, NUM_READS, true);
+    benchmarkScanResistance(RowCachePolicy::LRU, "Zipfian + Scan Reads (LRU)", 20000, 50000);
+    benchmarkScanResistance(RowCachePolicy::TINY_LFU, "Zipfian + Scan Reads (W-TinyLFU)", 20000, 50000);
 
     std::filesystem::remove_all("data");
 
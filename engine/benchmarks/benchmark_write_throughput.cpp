@@ -20,9 +20,16 @@ std::string generateRandomString(size_t length) {
     return result;
 }
 
+// The engine takes the row cache capacity in bytes; this fits about ROW_CACHE_ENTRIES keys with values of value_size
+constexpr size_t ROW_CACHE_ENTRIES = 1000;
+
+size_t rowCacheBytes(size_t value_size) {
+    return ROW_CACHE_ENTRIES * RowCache::charge("key_000000", Entry{std::string(value_size, 'x'), 0, EntryType::PUT});
+}
+
 void benchmarkSequentialWrites(size_t num_ops, size_t value_size) {
     std::filesystem::remove_all("data");
-    StorageEngine engine("data", 0);
+    StorageEngine engine("data", EngineOptions{.row_cache_bytes = 0});
 
     // Pre-generate all keys and values
     std::vector<std::string> keys, values;
@@ -72,7 +79,7 @@ void benchmarkSequentialWrites(size_t num_ops, size_t value_size) {
 
 void benchmarkRandomWrites(size_t num_ops, size_t value_size) {
     std::filesystem::remove_all("data");
-    StorageEngine engine("data", 0);
+    StorageEngine engine("data", EngineOptions{.row_cache_bytes = 0});
 
     std::random_device rd;
     std::mt19937 gen(rd());
@@ -124,7 +131,7 @@ void benchmarkRandomWrites(size_t num_ops, size_t value_size) {
 
 void benchmarkMixedWorkload(size_t num_ops, size_t value_size) {
     std::filesystem::remove_all("data");
-    StorageEngine engine("data", 1000);
+    StorageEngine engine("data", EngineOptions{.row_cache_bytes = rowCacheBytes(value_size)});
 
     // Pre-populate with some data
     for (size_t i = 0; i < num_ops / 2; ++i) {
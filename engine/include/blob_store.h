@@ -0,0 +1,88 @@
+#ifndef BLOB_STORE_H
+#define BLOB_STORE_H
+
+#include "coding.h"
+#include <cstddef>
+#include <cstdint>
+#include <fcntl.h>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+// Location of a value stored outside the LSM tree. Encoded as the value of a BLOB_INDEX entry.
+struct BlobHandle {
+    uint64_t file_number;
+    uint64_t offset;
+    uint32_t size;
+
+    std::string encode() const;
+    static bool decode(const std::string &data, BlobHandle &out);
+};
+
+// Append-only blob files holding large values. Records are keyLen fixed32 | valueLen fixed32 | key | value;
+// handles point at the value bytes. Each file tracks how many of its value bytes are no longer referenced
+// by the LSM tree. Sealed files past the garbage threshold are relocated by compaction and deleted once
+// nothing references them.
+class BlobStore {
+  public:
+    struct FileStats {
+        uint64_t total_bytes = 0;
+        uint64_t discarded_bytes = 0;
+    };
+
+    BlobStore(const std::string &dir, size_t max_file_size = 64 * 1024 * 1024, double gc_discard_ratio = 0.5);
+    ~BlobStore();
+
+    BlobStore(const BlobStore &) = delete;
+    BlobStore &operator=(const BlobStore &) = delete;
+
+    // Buffers the record; it becomes readable after sync().
+    BlobHandle add(const std::string &key, const std::string &value);
+    void sync();
+
+    std::string read(const BlobHandle &handle) const;
+
+    // Records that the LSM tree dropped its reference to handle.
+    void discard(const BlobHandle &handle);
+    bool shouldRelocate(uint64_t file_number) const;
+
+    std::map<uint64_t, FileStats> stats() const;
+    void saveStats() const;
+
+  private:
+    struct ReadFile {
+        int fd;
+        explicit ReadFile(int fd_) : fd(fd_) {
+        }
+        ~ReadFile() {
+            close(fd);
+        }
+    };
+
+    std::string dir_;
+    size_t max_file_size_;
+    double gc_discard_ratio_;
+
+    mutable std::mutex mutex_;
+    std::map<uint64_t, FileStats> stats_;
+    mutable std::map<uint64_t, std::shared_ptr<ReadFile>> readers_;
+
+    uint64_t active_number_ = 0;
+    int active_fd_ = -1;
+    uint64_t active_offset_ = 0;
+    std::string pending_;
+
+    std::string filePath(uint64_t file_number) const;
+    std::string statsPath() const;
+    void loadStats();
+    static uint64_t scanValueBytes(const std::string &path);
+    void openNewFileLocked();
+    void syncLocked();
+    void maybeDeleteLocked(uint64_t file_number);
+};
+
+#endif
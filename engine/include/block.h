@@ -0,0 +1,74 @@
+#ifndef BLOCK_H
+#define BLOCK_H
+
+#include "coding.h"
+#include "types.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Data block layout:
+//   entry*  : shared varint | unshared varint | valueLen varint | seq fixed64 | type u8 | [expiry fixed64] | key delta | value
+//             expiry is present only when the type byte has EXPIRY_FLAG set
+//   restart*: fixed32 offsets of entries whose key is stored in full (shared == 0)
+//   count   : fixed32 number of restart points
+class BlockBuilder {
+  public:
+    explicit BlockBuilder(size_t restart_interval = 16);
+
+    void add(const std::string &key, const std::string &value, uint64_t seq, EntryType type, uint64_t expires_at_ms = 0);
+    std::string finish();
+    void reset();
+
+    size_t estimatedSize() const;
+    bool empty() const;
+
+  private:
+    size_t restart_interval_;
+    std::string buffer_;
+    std::vector<uint32_t> restarts_;
+    std::string last_key_;
+    size_t counter_ = 0;
+};
+
+class Block {
+  public:
+    static constexpr uint8_t EXPIRY_FLAG = 0x80;
+
+    class Iterator {
+      public:
+        explicit Iterator(const Block &block);
+        bool valid() const;
+        const SSTableEntry &entry() const;
+        void seekToFirst();
+        // Positions at the first entry whose key is >= target.
+        void seek(const std::string &target);
+        void next();
+
+      private:
+        const Block *block_;
+        uint32_t next_offset_ = 0;
+        bool valid_ = false;
+        SSTableEntry current_;
+
+        void seekToRestart(uint32_t index);
+        bool parseNext();
+    };
+
+    explicit Block(std::string contents);
+
+    size_t size() const;
+    uint32_t numRestarts() const;
+
+  private:
+    std::string data_;
+    uint32_t restarts_offset_ = 0;
+    uint32_t num_restarts_ = 0;
+
+    uint32_t restartPoint(uint32_t index) const;
+
+    friend class Iterator;
+};
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef BLOCK_CACHE_H
+#define BLOCK_CACHE_H
+
+#include "block.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+// LRU cache of decompressed data blocks shared by all SSTables, charged by block size.
+class BlockCache {
+  public:
+    explicit BlockCache(size_t capacity_bytes = 8 * 1024 * 1024);
+
+    std::shared_ptr<Block> get(uint64_t table_id, uint64_t offset);
+    void put(uint64_t table_id, uint64_t offset, std::shared_ptr<Block> block);
+    void clear();
+
+    size_t size() const;
+    size_t usage() const;
+
+  private:
+    struct CacheKey {
+        uint64_t table_id;
+        uint64_t offset;
+        bool operator==(const CacheKey &other) const {
+            return table_id == other.table_id && offset == other.offset;
+        }
+    };
+
+    struct CacheKeyHash {
+        size_t operator()(const CacheKey &key) const {
+            return std::hash<uint64_t>{}(key.table_id * 0x9e3779b97f4a7c15ULL ^ key.offset);
+        }
+    };
+
+    struct CacheNode {
+        std::shared_ptr<Block> block;
+        std::list<CacheKey>::iterator list_iter;
+    };
+
+    mutable std::mutex mutex_;
+    size_t capacity_;
+    size_t usage_ = 0;
+    std::list<CacheKey> lru_list_;
+    std::unordered_map<CacheKey, CacheNode, CacheKeyHash> cache_;
+};
+
+#endif
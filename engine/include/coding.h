@@ -0,0 +1,80 @@
+#ifndef CODING_H
+#define CODING_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+// Little-endian fixed-width and LEB128 varint helpers shared by the on-disk formats.
+
+inline void putFixed32(std::string &dst, uint32_t value) {
+    char buf[sizeof(value)];
+    std::memcpy(buf, &value, sizeof(value));
+    dst.append(buf, sizeof(buf));
+}
+
+inline void putFixed64(std::string &dst, uint64_t value) {
+    char buf[sizeof(value)];
+    std::memcpy(buf, &value, sizeof(value));
+    dst.append(buf, sizeof(buf));
+}
+
+inline uint32_t decodeFixed32(const char *ptr) {
+    uint32_t value;
+    std::memcpy(&value, ptr, sizeof(value));
+    return value;
+}
+
+inline uint64_t decodeFixed64(const char *ptr) {
+    uint64_t value;
+    std::memcpy(&value, ptr, sizeof(value));
+    return value;
+}
+
+inline void putVarint64(std::string &dst, uint64_t value) {
+    while (value >= 0x80) {
+        dst.push_back(static_cast<char>(value | 0x80));
+        value >>= 7;
+    }
+    dst.push_back(static_cast<char>(value));
+}
+
+inline void putVarint32(std::string &dst, uint32_t value) {
+    putVarint64(dst, value);
+}
+
+// Advances ptr past the decoded value. Returns false on truncated or overlong input.
+inline bool getVarint64(const char *&ptr, const char *limit, uint64_t &out) {
+    uint64_t result = 0;
+    for (uint32_t shift = 0; shift <= 63 && ptr < limit; shift += 7) {
+        uint64_t byte = static_cast<uint8_t>(*ptr++);
+        result |= (byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            out = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+inline bool getVarint32(const char *&ptr, const char *limit, uint32_t &out) {
+    uint64_t value;
+    if (!getVarint64(ptr, limit, value) || value > UINT32_MAX) {
+        return false;
+    }
+    out = static_cast<uint32_t>(value);
+    return true;
+}
+
+inline size_t sharedPrefixLength(const std::string &a, const std::string &b) {
+    size_t limit = std::min(a.size(), b.size());
+    size_t n = 0;
+    while (n < limit && a[n] == b[n]) {
+        n++;
+    }
+    return n;
+}
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef COMPRESSION_H
+#define COMPRESSION_H
+
+#include "types.h"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Compresses raw into out. Returns false when the codec is NONE or compression
+// would not save enough space to be worth decoding, in which case out is untouched.
+// A non-empty dictionary primes the compressor and must be passed again to decompress.
+bool compressBlock(CompressionType type, const std::string &raw, std::string &out, const std::string &dictionary = "");
+
+// Throws std::runtime_error on corrupted input, a missing dictionary or an unknown codec.
+std::string decompressBlock(CompressionType type, const char *data, size_t size, const std::string &dictionary = "");
+
+// Builds a preset dictionary of at most max_bytes from the byte sequences that recur across
+// the most samples. Returns an empty string when the samples share nothing worth keeping.
+std::string trainDictionary(const std::vector<std::string> &samples, size_t max_bytes);
+
+#endif
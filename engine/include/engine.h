@@ -1,23 +1,34 @@
 #ifndef STORAGE_ENGINE_H
 #define STORAGE_ENGINE_H
 
+#include "blob_store.h"
+#include "block_cache.h"
 #include "command_parser.h"
-#include "lru_cache.h"
 #include "memtable.h"
+#include "options.h"
+#include "rate_limiter.h"
+#include "row_cache.h"
 #include "sstable.h"
 #include "table_version.h"
 #include "types.h"
 #include "wal.h"
+#include "worker_pool.h"
+#include "write_controller.h"
 #include "write_queue.h"
 
 #include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <coroutine>
 #include <cstddef>
 #include <cstdint>
+#include <deque>
 #include <filesystem>
 #include <fstream>
+#include <functional>
 #include <iostream>
+#include <list>
 #include <map>
 #include <memory>
 #include <mutex>
@@ -28,25 +39,111 @@
 #include <string>
 #include <thread>
 #include <tuple>
+#include <unordered_set>
 #include <vector>
 
 class WriteAheadLog;
 class MemTable;
+class Transaction;
+
+// Bytes written to SSTables since the engine was opened. Write amplification is total bytes written per byte flushed.
+struct CompactionStats {
+    uint64_t flush_bytes_written = 0;
+    uint64_t compaction_bytes_read = 0;
+    uint64_t compaction_bytes_written = 0;
+    uint64_t compactions_completed = 0;
+    // Estimated bytes compaction must rewrite to bring every level back under its target
+    uint64_t pending_compaction_bytes = 0;
+    // Current compaction write budget; 0 when rate limiting is off
+    uint64_t rate_limit_bytes_per_sec = 0;
+
+    double writeAmplification() const {
+        if (flush_bytes_written == 0) {
+            return 0.0;
+        }
+        return static_cast<double>(flush_bytes_written + compaction_bytes_written) / static_cast<double>(flush_bytes_written);
+    }
+};
+
+// Read view as of one sequence number, handed out by StorageEngine::getSnapshot. It holds on to the table files
+// and memtables current when it was taken, and to every memtable flushed while it lives that holds writes as old as
+// it, so reads through it never see a later write and never miss a version that compaction has since dropped.
+class Snapshot {
+  public:
+    uint64_t sequence() const {
+        return seq_;
+    }
+
+  private:
+    friend class StorageEngine;
+
+    uint64_t seq_ = 0;
+    std::shared_ptr<TableVersion> version_;
+    // Added to under both the engine's snapshot_mutex_ and mutex_, so reads need either; readers take mutex_ only,
+    // which commits never hold
+    std::vector<std::shared_ptr<MemTable>> memtables_;
+    mutable std::mutex mutex_;
+};
+
+// One write of a batch given to StorageEngine::write. DELETE_RANGE takes the exclusive end of the range as its value.
+struct BatchWrite {
+    Operation op;
+    std::string key;
+    std::string value;
+};
 
 class StorageEngine {
   public:
-    explicit StorageEngine(const std::string &data_dir, size_t cache_size = 1000);
+    explicit StorageEngine(const std::string &data_dir);
+    // The row cache used to be sized in entries here; it is sized in bytes through EngineOptions::row_cache_bytes now
+    StorageEngine(const std::string &data_dir, size_t cache_size) = delete;
+    StorageEngine(const std::string &data_dir, const EngineOptions &options);
     ~StorageEngine();
     StorageEngine(const StorageEngine &) = delete;
     StorageEngine &operator=(const StorageEngine &) = delete;
 
     bool put(const std::string &key, const std::string &value);
+    // The key reads as missing once ttl has passed; compaction then drops it without writing a tombstone
+    bool put(const std::string &key, const std::string &value, std::chrono::milliseconds ttl);
+    // Returns whether the key existed, which costs a full lookup before the tombstone is written
     bool del(const std::string &key);
+    // Writes the tombstone without looking the key up first; the key may or may not have existed.
+    // Returns whether the tombstone was written.
+    bool blindDel(const std::string &key);
+    // Deletes every key in [start, end) with a single range tombstone. Returns false for an empty range.
+    bool deleteRange(const std::string &start, const std::string &end);
     bool get(const std::string &key, Entry &out) const;
+    bool get(const ReadOptions &options, const std::string &key, Entry &out) const;
+
+    // Snapshots let several reads see the database as of one point in time while writes go on. Until released, a
+    // snapshot keeps the table files it reads on disk and the memtables flushed since in memory.
+    const Snapshot *getSnapshot();
+    void releaseSnapshot(const Snapshot *snapshot);
+    // Submits the writes in order and waits once for all of them, which usually commit under one WAL sync.
+    // The batch is not atomic: each write succeeds or fails on its own. Returns whether all of them succeeded.
+    bool write(const std::vector<BatchWrite> &writes);
 
     std::future<bool> putAsync(const std::string &key, const std::string &value);
     std::future<bool> delAsync(const std::string &key);
 
+    // Callback forms, so async callers need no thread per write in flight. A write callback runs on the commit
+    // thread once the write is durable and visible; it may queue further async writes but must not block, and
+    // blocking writes made from it fail. getAsync answers row cache hits on the calling thread and runs every
+    // other lookup on the async read pool; the callback gets nullopt for a missing key.
+    using WriteCallback = std::function<void(bool)>;
+    using ReadCallback = std::function<void(std::optional<Entry>)>;
+    void putAsync(const std::string &key, const std::string &value, WriteCallback callback);
+    void delAsync(const std::string &key, WriteCallback callback);
+    void getAsync(const std::string &key, ReadCallback callback) const;
+
+    // co_await-able forms. awaitGet resumes the coroutine where the callback would have run; the write forms
+    // resume it on the async pool, where it may go on to make blocking calls.
+    class WriteAwaitable;
+    class GetAwaitable;
+    WriteAwaitable awaitPut(const std::string &key, const std::string &value);
+    WriteAwaitable awaitDel(const std::string &key);
+    GetAwaitable awaitGet(const std::string &key) const;
+
     void ls() const;
     void flush();
     void handleCommand(const std::string &input);
@@ -56,25 +153,71 @@ class StorageEngine {
     void waitForCompaction();
     void pauseCompaction();
     void resumeCompaction();
+    CompactionStats compactionStats() const;
+    WriteStallStats writeStallStats() const;
+    RowCacheStats rowCacheStats() const;
 
   private:
     // Core storage components
     std::string data_dir_;
+    EngineOptions options_;
     WriteAheadLog wal_;
     MemTable memtable_;
     std::shared_ptr<MemTable> immutable_memtable_; // Immutable memtable being flushed (atomic access)
     VersionManager version_manager_;
     uint64_t flush_counter_;
     uint64_t seq_number_;
-    mutable std::optional<LRUCache> cache_;
+    std::unique_ptr<RowCache> cache_;
+    std::shared_ptr<BlockCache> block_cache_;
+    std::unique_ptr<BlobStore> blob_store_;
 
     // Threading components - protects flush_counter_, seq_number_, metadata writes
     mutable std::mutex metadata_mutex_;
 
-    // Writer thread
+    // Runs getAsync lookups that missed the row cache, and resumes coroutines whose writes have committed so they
+    // do not run on the commit thread
+    std::unique_ptr<WorkerPool> async_pool_;
+
+    // Writer pipeline. The writer thread assigns sequence numbers, encodes WAL records and starts their fsync; the
+    // commit thread waits for each batch's fsync, applies it to the memtable and completes its requests, in order,
+    // while the writer thread is already encoding the next batch.
     WriteQueue write_queue_;
     std::thread writer_thread_;
     std::atomic<bool> writer_shutdown_{false};
+    // Held by the writer thread while it handles a batch, and by flush() so no WAL append races its memtable swap
+    std::mutex writer_mutex_;
+    WriteController write_controller_;
+
+    struct CommitBatch {
+        std::vector<WriteRequestPtr> requests;
+        std::vector<bool> results; // One per request
+        std::vector<MemTableWrite> writes;
+        uint64_t wal_generation = 0;
+        uint64_t last_seq = 0; // 0 if the batch wrote nothing
+    };
+
+    static constexpr size_t MAX_COMMITS_IN_FLIGHT = 2;
+    std::thread commit_thread_;
+    std::mutex commit_mutex_;
+    std::condition_variable commit_cv_;
+    std::deque<std::shared_ptr<CommitBatch>> commit_queue_; // Guarded by commit_mutex_
+    size_t commits_in_flight_ = 0;                          // Guarded by commit_mutex_; queued or being applied
+    bool commit_shutdown_ = false;                          // Guarded by commit_mutex_
+    // Batches handed to the commit thread whose seqs may not be published yet, oldest first. Writer thread only;
+    // transactions are checked against their writes, which are not in the memtable until published.
+    std::deque<std::shared_ptr<const CommitBatch>> unpublished_batches_;
+    // Newest sequence number visible to readers; every write before it is visible too
+    std::atomic<uint64_t> published_seq_{0};
+    // First seq written to the active and to the immutable memtable, so the writer knows which seqs it can check
+    // transactions against. Guarded by snapshot_mutex_.
+    uint64_t memtable_start_seq_ = 0;
+    uint64_t immutable_start_seq_ = 0;
+
+    // Live snapshots, oldest first. Applying a commit batch and publishing its seq happen under snapshot_mutex_, so
+    // a new snapshot sees either all of a batch or none of it, and the memtable keeps what older snapshots read.
+    mutable std::mutex snapshot_mutex_;
+    std::list<std::unique_ptr<Snapshot>> snapshots_; // Guarded by snapshot_mutex_
+    std::vector<BlobHandle> deferred_blob_discards_; // Guarded by snapshot_mutex_; released with the last snapshot
 
     // Flush thread
     std::thread flush_thread_;
@@ -88,29 +231,181 @@ class StorageEngine {
     std::condition_variable compaction_cv_;
     std::mutex compaction_mutex_;
     std::atomic<bool> compaction_needed_{false};
-    std::atomic<bool> compaction_in_progress_{false};
     std::atomic<bool> compaction_paused_{false};
+    std::unique_ptr<WorkerPool> compaction_pool_;
+    std::unique_ptr<WorkerPool> subcompaction_pool_;
+    std::unique_ptr<RateLimiter> rate_limiter_;
+
+    // Compaction accounting
+    std::atomic<uint64_t> flush_bytes_written_{0};
+    std::atomic<uint64_t> compaction_bytes_read_{0};
+    std::atomic<uint64_t> compaction_bytes_written_{0};
+    std::atomic<uint64_t> compactions_completed_{0};
+    std::atomic<uint64_t> pending_compaction_bytes_{0};
 
     // Core methods
     void checkFlush(bool debug = false);
     void loadLevelMetadata();
     void loadSSTables();
+    // Deletes table files the metadata does not list: those a snapshot or reader kept open past a crash, and
+    // outputs written but never installed
+    void removeUnlistedSSTables();
     void saveMetadata();
+    std::shared_ptr<SSTable> writeSSTable(const std::map<std::string, Entry> &data, uint64_t id, uint32_t level, IOPriority priority,
+                                          const std::vector<RangeTombstone> &range_tombstones = {});
+    // Removes every SSTable other than keep_id lying wholly inside one of the tombstones and older than it
+    void dropFilesCoveredBy(const std::vector<RangeTombstone> &range_tombstones, uint64_t keep_id);
+    // Adds to edit the files whose values have all expired and beneath which nothing older overlaps; returns the
+    // next time such a file expires, 0 if none will
+    uint64_t pickExpiredFilesLocked(const std::shared_ptr<TableVersion> &version, VersionEdit &edit) const;
+    // Installs an edit that only removes files and releases the blob values they held; reads every dropped file
+    // when blobs are separated, so no scheduler lock may be held
+    void dropFiles(const std::shared_ptr<TableVersion> &version, const VersionEdit &edit);
+    std::string buildDictionary(const std::map<std::string, Entry> &data) const;
+    bool isBottommostLevel(uint32_t level) const;
 
+    static constexpr size_t MEMTABLE_FLUSH_BYTES = 8 * 1024 * 1024;
+
+    // Queues one write and blocks until it is committed, with the request and its waiter on this thread's stack
+    bool writeAndWait(Operation op, const std::string &key, const std::string &value);
+    bool onCommitThread() const;
+    friend class Transaction;
+    bool commitTransaction(const std::string &writes, const TransactionReads &reads);
+    // Whether none of the keys has been written after reads.seq, by an earlier batch or by pending. Writer thread only.
+    bool transactionReadsCurrent(const TransactionReads &reads, const std::vector<MemTableWrite> &pending);
+    // Answers from the row cache if it holds the key, setting found to whether the key exists
+    bool lookupRowCache(const std::string &key, Entry &out, bool &found) const;
+    // Seq no present or future snapshot reads below, for pruning the versions the memtables keep
+    uint64_t oldestSnapshotSeqLocked() const;
+    // Reads the memtables and table files, or only what snapshot pinned when given
+    bool lookupTables(const std::string &key, Entry &out, const Snapshot *snapshot = nullptr) const;
+    void readAsync(const std::string &key, ReadCallback callback) const;
+    // Whether readAsync runs the read, and its callback, before returning
+    bool readsInline() const;
     void writerThreadLoop();
+    void commitThreadLoop();
+    void waitForCommits();
     void flushThreadLoop();
     void triggerFlush();
 
     // Compaction methods
-    void compactL0toL1();
-    void compactlevelN(uint32_t level);
+    struct CompactionJob {
+        std::vector<std::shared_ptr<SSTable>> inputs;
+        std::vector<uint64_t> input_ids;
+        uint32_t start_level = 0;
+        uint32_t output_level = 0;
+        uint64_t input_bytes = 0;
+        // Only safe when no older version of any input key can exist outside the job
+        bool drop_tombstones = false;
+        // Key range covered by the inputs, and so by the outputs
+        std::string smallest;
+        std::string largest;
+    };
+
+    struct SubcompactionResult {
+        std::vector<std::pair<std::shared_ptr<SSTable>, SSTableMeta>> outputs;
+        std::vector<BlobHandle> obsolete_blobs;
+        std::vector<BlobHandle> added_blobs; // Released again if the outputs are discarded
+        bool ok = true;
+    };
+
+    // Shards smaller than this many data blocks are not worth a separate thread
+    static constexpr size_t MIN_SUBCOMPACTION_BLOCKS = 16;
+
+    std::shared_ptr<CompactionJob> pickL0CompactionLocked(const std::shared_ptr<TableVersion> &version, uint32_t output_level) const;
+    std::shared_ptr<CompactionJob> pickLevelCompactionLocked(const std::shared_ptr<TableVersion> &version, uint32_t level);
+    std::shared_ptr<CompactionJob> pickUniversalCompactionLocked(const std::shared_ptr<TableVersion> &version) const;
+    std::shared_ptr<CompactionJob> pickTombstoneCompactionLocked(const std::shared_ptr<TableVersion> &version) const;
+    static std::shared_ptr<CompactionJob> levelJobForFile(const std::shared_ptr<TableVersion> &version, uint32_t level,
+                                                          const SSTableMeta &meta);
+    static void addOverlappingInputs(const std::shared_ptr<TableVersion> &version, CompactionJob &job);
+    static bool overlapsBelowOutput(const std::shared_ptr<TableVersion> &version, const CompactionJob &job);
+    void runCompaction(const CompactionJob &job);
+    void runSubcompaction(const CompactionJob &job, const std::string &lower, const std::optional<std::string> &upper,
+                          SubcompactionResult &result);
+    std::vector<std::string> subcompactionBoundaries(const std::vector<std::shared_ptr<SSTable>> &inputs) const;
+    // Merges the [lower, upper) key range of tables, keeping the newest version of each key. Versions shadowed by a
+    // range tombstone are dropped; the tombstones, clipped to the range, are returned unless tombstones are dropped.
+    std::map<std::string, Entry> mergeSSTables(const std::vector<std::shared_ptr<SSTable>> &tables, const std::string &lower,
+                                               const std::optional<std::string> &upper, bool drop_tombstones,
+                                               std::vector<BlobHandle> &obsolete_blobs,
+                                               std::vector<RangeTombstone> &range_tombstones) const;
+
+    // Blob separation
+    // Records each blob written in added_blobs, if given
+    void separateBlobs(std::map<std::string, Entry> &data, std::vector<BlobHandle> &obsolete_blobs,
+                       std::vector<BlobHandle> *added_blobs = nullptr);
+    void releaseBlobs(const std::vector<BlobHandle> &obsolete_blobs);
+    void resolveBlob(Entry &entry) const;
+
+    // Background compaction coordination. Jobs whose inputs or output ranges overlap never run at the same time.
+    std::vector<std::shared_ptr<CompactionJob>> running_compactions_; // Guarded by compaction_mutex_
+    std::vector<std::string> compact_cursors_;                        // Guarded by compaction_mutex_
+    uint64_t next_file_expiry_ms_ = 0;                                // Guarded by compaction_mutex_
 
-    // Background compaction coordination
     void compactionThreadLoop();
     void scheduleCompaction();
-    bool shouldCompactUnlocked(uint32_t level) const;
-    static bool shouldCompactUnlocked(uint32_t level, const std::shared_ptr<TableVersion> &version);
-    void maybeCompactBackground();
+    void scheduleCompactionsLocked();
+    void runCompactionJob(const std::shared_ptr<CompactionJob> &job);
+    bool conflictsWithRunningLocked(const CompactionJob &job) const;
+
+    // Target size per level. Levels between L0 and base_level are unused; L0 compacts into base_level.
+    struct LevelTargets {
+        uint32_t base_level = 1;
+        std::vector<uint64_t> target_bytes;
+    };
+
+    LevelTargets levelTargets(const std::shared_ptr<TableVersion> &version) const;
+    // Score per level (size / target, or file count / trigger for L0); levels scoring >= 1 need compaction
+    std::vector<double> compactionScores(const std::shared_ptr<TableVersion> &version, const LevelTargets &targets) const;
+    uint64_t pendingCompactionBytes(const std::shared_ptr<TableVersion> &version) const;
+    // Refreshes pending_compaction_bytes_, the write stall condition and, when auto-tuning, the compaction write budget
+    void updateCompactionPressure();
+};
+
+// A write queued when the coroutine suspends. The request lives in the awaitable, and so in the coroutine frame,
+// so a suspended write allocates nothing.
+class StorageEngine::WriteAwaitable {
+  public:
+    WriteAwaitable(StorageEngine &engine, Operation op, std::string key, std::string value)
+        : engine_(engine), request_(op, std::move(key), std::move(value)) {
+    }
+
+    WriteAwaitable(const WriteAwaitable &) = delete;
+    WriteAwaitable &operator=(const WriteAwaitable &) = delete;
+
+    bool await_ready() const noexcept {
+        return false;
+    }
+    void await_suspend(std::coroutine_handle<> handle);
+    bool await_resume() const noexcept {
+        return request_.coroutine_ok;
+    }
+
+  private:
+    StorageEngine &engine_;
+    WriteRequest request_;
+};
+
+// Completes without suspending on a row cache hit, or when reads run on the caller's thread
+class StorageEngine::GetAwaitable {
+  public:
+    GetAwaitable(const StorageEngine &engine, std::string key) : engine_(engine), key_(std::move(key)) {
+    }
+
+    GetAwaitable(const GetAwaitable &) = delete;
+    GetAwaitable &operator=(const GetAwaitable &) = delete;
+
+    bool await_ready();
+    bool await_suspend(std::coroutine_handle<> handle);
+    std::optional<Entry> await_resume() {
+        return std::move(result_);
+    }
+
+  private:
+    const StorageEngine &engine_;
+    std::string key_;
+    std::optional<Entry> result_;
 };
 
 #endif
@@ -0,0 +1,33 @@
+#ifndef FREQUENCY_SKETCH_H
+#define FREQUENCY_SKETCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Count-Min sketch of recent access frequency, as used by TinyLFU admission. Each key hash maps to one saturating
+// counter per row and its estimate is the smallest of them. Once the sketch has counted ten accesses per counter,
+// every counter is halved so that keys which stop being read lose their weight.
+class FrequencySketch {
+  public:
+    // Sized for about this many distinct keys; rounded up to a power of two
+    explicit FrequencySketch(size_t expected_keys);
+
+    void increment(uint64_t hash);
+    uint32_t estimate(uint64_t hash) const;
+
+    static constexpr uint32_t MAX_COUNT = 15;
+
+  private:
+    static constexpr size_t ROWS = 4;
+
+    size_t width_;
+    std::vector<uint8_t> counters_; // ROWS rows of width_ counters
+    size_t additions_ = 0;
+    size_t sample_size_;
+
+    size_t indexOf(uint64_t hash, size_t row) const;
+    void age();
+};
+
+#endif
@@ -2,6 +2,7 @@
 #define MEMTABLE_H
 
 #include "types.h"
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <functional>
@@ -10,18 +11,53 @@
 #include <mutex>
 #include <shared_mutex>
 #include <string>
+#include <vector>
+
+// One write of a batch given to MemTable::apply. PUT_TTL carries the bare value and its expiry; DELETE_RANGE
+// carries the end key as its value.
+struct MemTableWrite {
+    Operation op;
+    std::string key;
+    std::string value;
+    uint64_t seq;
+    uint64_t expires_at_ms = 0;
+};
 
 class MemTable {
   public:
-    bool put(const std::string &key, const std::string &value, uint64_t seqNumber);
+    bool put(const std::string &key, const std::string &value, uint64_t seqNumber, uint64_t expiresAtMs = 0);
     bool del(const std::string &key, uint64_t seqNumber);
-    bool get(const std::string &key, Entry &out) const;
+    // Drops the keys in [start, end) written before seqNumber and records a range tombstone shadowing older data
+    void deleteRange(const std::string &start, const std::string &end, uint64_t seqNumber);
+    // Applies the writes in order under a single acquisition of the lock. Versions with a seq of at most
+    // retainSeq that the writes overwrite or drop are kept for reads as of an older seq.
+    void apply(const std::vector<MemTableWrite> &writes, uint64_t retainSeq = 0);
+    // Drops the overwritten versions that no read as of oldestSeq or later can see
+    void pruneVersions(uint64_t oldestSeq);
+    // Newest version of key with a seq of at most maxSeq
+    bool get(const std::string &key, Entry &out, uint64_t maxSeq = UINT64_MAX) const;
+    // Seq of the newest range tombstone covering key, 0 if none does; tombstones newer than maxSeq are ignored
+    uint64_t coveringTombstoneSeq(const std::string &key, uint64_t maxSeq = UINT64_MAX) const;
+    // Newest version of every key
     const std::map<std::string, Entry> snapshot() const;
+    std::vector<RangeTombstone> rangeTombstones() const;
+    // Hands every version and range tombstone over to target, which must be empty, leaving this memtable empty
+    void moveTo(MemTable &target);
     void clear();
     size_t getSize() const;
 
   private:
+    void setLocked(const std::string &key, Entry entry, uint64_t retainSeq = 0);
+    void putLocked(const std::string &key, const std::string &value, uint64_t seqNumber, uint64_t expiresAtMs, uint64_t retainSeq = 0);
+    bool delLocked(const std::string &key, uint64_t seqNumber, uint64_t retainSeq = 0);
+    void deleteRangeLocked(const std::string &start, const std::string &end, uint64_t seqNumber, uint64_t retainSeq = 0);
+    void retainLocked(const std::string &key, Entry entry);
+
     std::map<std::string, Entry> memtable_;
+    // Overwritten versions still readable as of an older seq, oldest first
+    std::map<std::string, std::vector<Entry>> older_versions_;
+    std::vector<RangeTombstone> range_tombstones_;
+    size_t size_ = 0; // Bytes the entries and range tombstones take as WAL records
     mutable std::shared_mutex mutex_;
 };
 
@@ -0,0 +1,121 @@
+#ifndef OPTIONS_H
+#define OPTIONS_H
+
+#include "row_cache.h"
+#include "types.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class Snapshot;
+
+struct ReadOptions {
+    // Read as of this snapshot instead of the latest data
+    const Snapshot *snapshot = nullptr;
+};
+
+// How a level picks the file to push into the next level
+enum class CompactionPri : uint8_t {
+    ROUND_ROBIN,     // Cycle through the key space, continuing after the last file compacted
+    MIN_OVERLAP,     // Fewest next-level bytes rewritten per byte moved down
+    OLDEST_SEQ_FIRST // File whose newest entry is oldest
+};
+
+enum class CompactionStyle : uint8_t {
+    LEVELED,  // One sorted run per level, each level a fixed multiple of the one above
+    UNIVERSAL // Size-tiered: whole sorted runs of similar size are merged together
+};
+
+struct EngineOptions {
+    // Row cache capacity in bytes, split over 2^row_cache_shard_bits independently locked shards; 0 disables it
+    size_t row_cache_bytes = 8 * 1024 * 1024;
+    int row_cache_shard_bits = 4;
+    RowCachePolicy row_cache_policy = RowCachePolicy::TINY_LFU;
+    // Cache misses as well, so polling an absent key costs one cache lookup until the key is written
+    bool row_cache_negative_lookups = true;
+
+    // Threads running getAsync lookups that miss the row cache; 0 runs them on the calling thread. At least one
+    // thread is kept either way to resume coroutines once their writes commit.
+    size_t async_read_threads = 2;
+
+    // Decompressed data block cache shared by all SSTables; 0 disables it
+    size_t block_cache_bytes = 8 * 1024 * 1024;
+
+    // Block codec by level. Levels past the end use the last entry.
+    std::vector<CompressionType> compression_per_level = {CompressionType::NONE, CompressionType::NONE, CompressionType::ZLIB};
+
+    // Size of the preset dictionary trained from sampled values for bottom-level SSTables; 0 disables it
+    size_t bottommost_dictionary_bytes = 16 * 1024;
+
+    // Values at least this large are moved to blob files at flush/compaction time and
+    // SSTables keep only a (file, offset, size) handle; 0 keeps every value inline
+    size_t blob_value_threshold = 0;
+    size_t blob_file_size = 64 * 1024 * 1024;
+
+    // Sealed blob files whose discarded fraction reaches this ratio are rewritten by compaction
+    double blob_gc_discard_ratio = 0.5;
+
+    // Leveled compaction shape. L0 is compacted once it holds level0_compaction_trigger files; every other level
+    // once it exceeds its target, which is level_size_multiplier times the target of the level above it.
+    uint32_t num_levels = 7;
+    size_t level0_compaction_trigger = 4;
+    uint64_t max_bytes_for_level_base = 10 * 1024 * 1024;
+    double level_size_multiplier = 10.0;
+
+    // Derive level targets backwards from the bottom level's actual size instead of forwards from the base size,
+    // so most data sits in the bottom level however large the dataset grows
+    bool dynamic_level_bytes = true;
+
+    CompactionStyle compaction_style = CompactionStyle::LEVELED;
+    CompactionPri compaction_pri = CompactionPri::MIN_OVERLAP;
+
+    // Universal compaction. Runs once there are level0_compaction_trigger sorted runs. Merges every run when the
+    // newer runs together exceed this percentage of the oldest run's size...
+    uint64_t universal_max_size_amplification_percent = 200;
+    // ...otherwise merges the newest runs while each next older run is at most this percent larger than all runs
+    // picked so far, if that takes at least universal_min_merge_width runs
+    uint64_t universal_size_ratio = 1;
+    size_t universal_min_merge_width = 2;
+
+    // Files whose tombstones make up at least this fraction of their entries are compacted down even while their
+    // level is within target, so deletes reach the bottom level and free space; 0 disables it. Files with fewer
+    // than tombstone_compaction_min_entries entries are left alone.
+    double tombstone_compaction_ratio = 0.5;
+    uint64_t tombstone_compaction_min_entries = 1000;
+
+    // Compaction output is cut into files of about this size; 0 writes one file per subcompaction
+    size_t target_file_size = 2 * 1024 * 1024;
+
+    // Compaction jobs with disjoint inputs that may run at the same time
+    size_t max_background_compactions = 2;
+
+    // Large compactions are split into up to this many key-range shards merged in parallel; 1 disables it
+    size_t max_subcompactions = 4;
+
+    // SSTable write budget shared by flushes and compactions; 0 disables it. Flushes are charged but never wait,
+    // so compactions back off while a flush is writing. The WAL is never rate limited.
+    uint64_t rate_limit_bytes_per_sec = 0;
+    // Scale the budget with pending compaction bytes instead: a tenth of rate_limit_bytes_per_sec while compaction
+    // keeps up, rising linearly to the full rate once rate_limit_auto_tune_pending_bytes are waiting to be compacted
+    bool rate_limit_auto_tune = false;
+    uint64_t rate_limit_auto_tune_pending_bytes = 64 * 1024 * 1024;
+
+    // Write stalls. Writes are slowed to delayed_write_rate once L0 holds level0_slowdown_writes_trigger files or
+    // pending compaction bytes reach the soft limit, and further as either approaches its stop limit, where writes
+    // block until compaction catches up. 0 disables a limit.
+    size_t level0_slowdown_writes_trigger = 20;
+    size_t level0_stop_writes_trigger = 36;
+    uint64_t soft_pending_compaction_bytes_limit = 64ULL * 1024 * 1024 * 1024;
+    uint64_t hard_pending_compaction_bytes_limit = 256ULL * 1024 * 1024 * 1024;
+    uint64_t delayed_write_rate = 16 * 1024 * 1024;
+
+    CompressionType compressionForLevel(uint32_t level) const {
+        if (compression_per_level.empty()) {
+            return CompressionType::NONE;
+        }
+        return compression_per_level[std::min<size_t>(level, compression_per_level.size() - 1)];
+    }
+};
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef RATE_LIMITER_H
+#define RATE_LIMITER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+enum class IOPriority : uint8_t {
+    LOW, // Compaction: waits for budget
+    HIGH // Memtable flush: charged but never waits
+};
+
+// Token bucket shared by background writers. The budget refills continuously at bytes_per_sec and saves up at most
+// burst_micros worth of unused bytes. HIGH requests may drive the budget into debt, which LOW requests repay before
+// they are let through, so compaction backs off whenever flushes need the disk.
+class RateLimiter {
+  public:
+    // bytes_per_sec of 0 means unlimited
+    explicit RateLimiter(uint64_t bytes_per_sec, uint64_t burst_micros = 100'000);
+
+    RateLimiter(const RateLimiter &) = delete;
+    RateLimiter &operator=(const RateLimiter &) = delete;
+
+    void request(size_t bytes, IOPriority priority);
+
+    // Takes effect immediately, including for requests already waiting
+    void setBytesPerSecond(uint64_t bytes_per_sec);
+    uint64_t bytesPerSecond() const;
+
+    uint64_t totalBytes(IOPriority priority) const;
+    // Time LOW requests have spent waiting for budget
+    uint64_t totalWaitMicros() const;
+
+  private:
+    using Clock = std::chrono::steady_clock;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    uint64_t bytes_per_sec_;
+    uint64_t burst_micros_;
+    double available_ = 0.0;
+    Clock::time_point last_refill_;
+    uint64_t total_bytes_[2] = {0, 0};
+    uint64_t total_wait_micros_ = 0;
+
+    void refillLocked();
+    double burstBytesLocked() const;
+};
+
+#endif
@@ -0,0 +1,109 @@
+#ifndef ROW_CACHE_H
+#define ROW_CACHE_H
+
+#include "frequency_sketch.h"
+#include "types.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// How the row cache decides which keys to keep
+enum class RowCachePolicy : uint8_t {
+    LRU,     // Admit every key and evict the least recently used
+    TINY_LFU // W-TinyLFU: new keys enter a small LRU window and only move into the main LRU if read more often
+             // than the key they would evict, so one pass over cold keys cannot flush the hot set
+};
+
+// Lookups answered by the row cache since it was created
+struct RowCacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    // Keys leaving the window that lost to the main LRU's victim and were dropped
+    uint64_t rejected = 0;
+
+    double hitRate() const {
+        uint64_t lookups = hits + misses;
+        return lookups == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(lookups);
+    }
+};
+
+// Cache of point lookup results, split into 2^shard_bits shards by key hash so readers of different keys rarely
+// contend on a lock. Each shard is charged by entry size in bytes; the key is stored once, in the list node, and
+// the shard's index refers to it. Entries larger than a shard's share of the capacity are not cached.
+class RowCache {
+  public:
+    explicit RowCache(size_t capacity_bytes, int shard_bits = 4, RowCachePolicy policy = RowCachePolicy::LRU);
+
+    RowCache(const RowCache &) = delete;
+    RowCache &operator=(const RowCache &) = delete;
+
+    std::optional<Entry> get(const std::string &key);
+    // Ignored if the cache already holds a newer version of the key
+    void put(const std::string &key, const Entry &entry);
+    // For a version found by a lookup that started when read_seq was the newest visible seq. Besides being ignored
+    // like put, it is dropped if the shard has let go of any version newer than read_seq since: that version may
+    // be a write the lookup missed, and nothing would be left in the cache to shadow the stale one.
+    void putIfCurrent(const std::string &key, const Entry &entry, uint64_t read_seq);
+    void invalidate(const std::string &key);
+    // Drops every cached key in [start, end) for a range delete at seq
+    void invalidateRange(const std::string &start, const std::string &end, uint64_t seq);
+    void clear();
+
+    size_t size() const;
+    size_t usage() const;
+    RowCacheStats stats() const;
+
+    // Bytes an entry is charged against the capacity
+    static size_t charge(const std::string &key, const Entry &entry);
+    // Below this even an empty entry exceeds a shard's share, so nothing can ever be cached
+    static size_t minCapacity(int shard_bits);
+
+    // Share of each shard's capacity given to the TinyLFU window
+    static constexpr double WINDOW_FRACTION = 0.01;
+
+  private:
+    struct Node {
+        std::string key;
+        Entry entry;
+        size_t charge;
+        size_t hash;
+        bool in_window;
+    };
+
+    // Shards sit on their own cache lines so their locks do not share one
+    struct alignas(64) Shard {
+        mutable std::mutex mutex;
+        std::list<Node> window; // TinyLFU only; most recently used first
+        std::list<Node> lru;    // Main segment; most recently used first
+        std::unordered_map<std::string_view, std::list<Node>::iterator> index;
+        std::unique_ptr<FrequencySketch> sketch; // TinyLFU only
+        size_t window_usage = 0;
+        size_t usage = 0; // Both segments
+        size_t window_capacity = 0;
+        size_t capacity = 0;
+        // Newest seq of any version evicted, invalidated or turned away; lookups older than it cannot fill the shard
+        uint64_t dropped_seq = 0;
+        RowCacheStats stats;
+
+        void erase(std::list<Node>::iterator it);
+        void evictWindowLocked();
+        void admitLocked(std::list<Node>::iterator candidate);
+    };
+
+    size_t num_shards_;
+    std::unique_ptr<Shard[]> shards_;
+    RowCachePolicy policy_;
+
+    Shard &shardFor(size_t hash) const;
+    void putLocked(Shard &shard, const std::string &key, const Entry &entry, size_t hash);
+};
+
+#endif
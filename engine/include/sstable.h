@@ -1,9 +1,15 @@
 #ifndef SSTABLE_H
 #define SSTABLE_H
 
+#include "block.h"
+#include "block_cache.h"
 #include "bloom_filter.h"
+#include "coding.h"
+#include "compression.h"
+#include "rate_limiter.h"
 #include "types.h"
 #include <algorithm>
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <filesystem>
@@ -25,13 +31,17 @@ class SSTable {
         explicit Iterator(const SSTable &table);
         bool valid() const;
         const SSTableEntry &entry() const;
+        // Positions at the first entry whose key is >= target.
+        void seek(const std::string &target);
         void next();
 
       private:
+        const SSTable *table_;
         std::ifstream file_;
-        uint64_t data_end_;
+        size_t block_index_ = 0;
+        std::shared_ptr<Block> block_;
+        std::optional<Block::Iterator> block_iter_;
         bool valid_ = false;
-        SSTableEntry current_;
         void readNext();
     };
 
@@ -44,10 +54,31 @@ class SSTable {
     SSTable(SSTable &&other) noexcept;
     SSTable &operator=(SSTable &&other) noexcept;
 
-    static SSTable flush(const std::map<std::string, Entry> &snapshot, const std::string &dir_path, uint64_t flush_counter);
+    // A non-empty dictionary is stored in the table's meta section and primes compression of every block.
+    // Every write is charged to rate_limiter, when given, at the given priority. Range tombstones go in a meta block
+    // and widen the table's key range; a table may hold only tombstones.
+    static SSTable flush(const std::map<std::string, Entry> &snapshot, const std::string &dir_path, uint64_t flush_counter,
+                         CompressionType compression = CompressionType::NONE, const std::string &dictionary = "",
+                         RateLimiter *rate_limiter = nullptr, IOPriority priority = IOPriority::HIGH,
+                         const std::vector<RangeTombstone> &range_tombstones = {});
     std::optional<Entry> get(const std::string &key) const;
     const std::string &filename() const;
+    // Smallest and largest key covered by an entry or range tombstone
+    const std::string &minKey() const;
+    const std::string &maxKey() const;
     std::map<std::string, Entry> getData() const;
+    // First key of every data block, in order; used to split compactions into key ranges.
+    std::vector<std::string> indexKeys() const;
+
+    // Point lookups consult and populate this cache; iterators bypass it so scans do not evict hot blocks.
+    void setBlockCache(std::shared_ptr<BlockCache> cache);
+    const std::string &dictionary() const;
+    const std::vector<RangeTombstone> &rangeTombstones() const;
+    // Seq of the newest range tombstone in this table covering key, 0 if none does
+    uint64_t coveringTombstoneSeq(const std::string &key) const;
+    // Deletes the file once the last reference to the table is dropped, so readers of an older version, such as
+    // snapshots, can still read a table that compaction has replaced
+    void markObsolete();
 
   private:
     std::string path_;
@@ -56,15 +87,26 @@ class SSTable {
     uint64_t metadata_offset_;
     std::vector<IndexEntry> index_;
     std::unique_ptr<BloomFilter> bloom_filter_;
+    std::string dictionary_;
+    std::vector<RangeTombstone> range_tombstones_;
+    uint64_t cache_id_;
+    std::shared_ptr<BlockCache> block_cache_;
+    std::atomic<bool> obsolete_{false};
 
     // File handle caching
     mutable std::unique_ptr<std::ifstream> cached_file_;
     mutable std::mutex file_mutex_;
 
-    static constexpr size_t INDEX_INTERVAL = 16;
+    static constexpr size_t BLOCK_SIZE = 4096;
+    static constexpr size_t RESTART_INTERVAL = 16;
     static constexpr double BLOOM_FP_RATE = 0.01;
+    static constexpr uint64_t TABLE_MAGIC = 0x6b7673737462326bULL;
+    static constexpr uint8_t META_DICTIONARY = 1;
+    static constexpr uint8_t META_RANGE_TOMBSTONES = 2;
+    static std::atomic<uint64_t> next_cache_id_;
 
     void loadMetadata();
+    std::shared_ptr<Block> readBlock(std::ifstream &file, const IndexEntry &handle) const;
     std::ifstream &getFile() const;
     void closeFile() const;
 
@@ -4,6 +4,7 @@
 #include "sstable.h"
 #include "types.h"
 #include <memory>
+#include <mutex>
 #include <shared_mutex>
 #include <vector>
 
@@ -21,6 +22,12 @@ struct TableVersion {
     void removeSSTablesByIds(const std::vector<uint64_t> &ids);
 };
 
+// Files removed and added by one flush or compaction, applied as a single step.
+struct VersionEdit {
+    std::vector<uint64_t> removed_ids;
+    std::vector<std::pair<std::shared_ptr<SSTable>, SSTableMeta>> added;
+};
+
 class VersionManager {
   public:
     VersionManager();
@@ -29,8 +36,13 @@ class VersionManager {
     void installVersion(std::shared_ptr<TableVersion> newVersion);
     std::shared_ptr<TableVersion> getVersionForModification() const;
 
+    // Applies edit on top of the current version. Fails without installing anything if one of the removed
+    // files is no longer live, meaning a concurrent edit already replaced it.
+    bool applyEdit(const VersionEdit &edit);
+
   private:
     std::shared_ptr<TableVersion> current_version_;
+    std::mutex edit_mutex_;
 };
 
 #endif
@@ -0,0 +1,51 @@
+#ifndef TRANSACTION_H
+#define TRANSACTION_H
+
+#include "memtable.h"
+#include "types.h"
+#include "write_queue.h"
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+class Snapshot;
+class StorageEngine;
+
+// Optimistic read-modify-write. Reads go through a snapshot taken when the transaction starts and writes are
+// buffered until commit, which hands all of them to the writer thread as one request. The writer commits them
+// atomically, under one WAL record, unless a key the transaction read has been written since its snapshot; the
+// transaction then fails and the caller retries. Nothing is locked while the transaction runs.
+// A transaction is used by one thread and must not outlive its engine.
+class Transaction {
+  public:
+    explicit Transaction(StorageEngine &engine);
+    ~Transaction();
+
+    Transaction(const Transaction &) = delete;
+    Transaction &operator=(const Transaction &) = delete;
+
+    // Sees the transaction's own writes, otherwise the database as of its snapshot
+    bool get(const std::string &key, Entry &out);
+    void put(const std::string &key, const std::string &value);
+    void del(const std::string &key);
+
+    // Returns false if a key read was written after the snapshot, or the write failed; nothing is written then.
+    // The transaction cannot be used after committing.
+    bool commit();
+
+  private:
+    StorageEngine &engine_;
+    const Snapshot *snapshot_;
+    TransactionReads reads_;
+    std::map<std::string, std::optional<std::string>> writes_; // nullopt deletes the key
+    bool committed_ = false;
+};
+
+// A TRANSACTION record's value: per write an op byte, then the varint32 length and bytes of its key and of its value
+std::string encodeTransactionWrites(const std::map<std::string, std::optional<std::string>> &writes);
+// Appends the writes to out with consecutive seqs from first_seq; returns false, appending nothing, if malformed
+bool decodeTransactionWrites(const std::string &encoded, uint64_t first_seq, std::vector<MemTableWrite> &out);
+
+#endif
@@ -1,17 +1,47 @@
 #ifndef TYPES_H
 #define TYPES_H
 
+#include <chrono>
 #include <cstdint>
 #include <string>
 
-enum class Operation : uint8_t { GET = 0, PUT = 1, DELETE = 2, LS = 3, FLUSH = 4, CLEAR = 5, ERROR = 6 };
+// DELETE_RANGE carries the range start as its key and the exclusive end as its value.
+// PUT_TTL carries a fixed64 expiry time ahead of the value.
+// TRANSACTION carries a transaction's encoded writes as its value; see encodeTransactionWrites.
+enum class Operation : uint8_t {
+    GET = 0,
+    PUT = 1,
+    DELETE = 2,
+    LS = 3,
+    FLUSH = 4,
+    CLEAR = 5,
+    ERROR = 6,
+    DELETE_RANGE = 7,
+    PUT_TTL = 8,
+    TRANSACTION = 9
+};
+
+// BLOB_INDEX entries only appear in SSTables; their value is an encoded BlobHandle
+enum class EntryType : uint8_t { PUT = 0, DELETE = 1, BLOB_INDEX = 2 };
 
-enum class EntryType : uint8_t { PUT = 0, DELETE = 1 };
+enum class CompressionType : uint8_t { NONE = 0, ZLIB = 1 };
+
+// Expiry times are wall-clock milliseconds since the epoch so they survive restarts
+inline uint64_t currentTimeMillis() {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+}
 
 struct Entry {
     std::string value;
     uint64_t seq;
     EntryType type;
+    // 0 never expires
+    uint64_t expires_at_ms = 0;
+
+    bool expired(uint64_t now_ms) const {
+        return expires_at_ms != 0 && expires_at_ms <= now_ms;
+    }
 };
 
 struct SSTableEntry {
@@ -19,11 +49,24 @@ struct SSTableEntry {
     std::string value;
     uint64_t seq;
     EntryType type;
+    uint64_t expires_at_ms = 0;
+};
+
+// Deletes every version older than seq of the keys in [start, end)
+struct RangeTombstone {
+    std::string start;
+    std::string end;
+    uint64_t seq;
+
+    bool covers(const std::string &key) const {
+        return key >= start && key < end;
+    }
 };
 
 struct IndexEntry {
     std::string key;
     uint64_t offset;
+    uint32_t size;
 };
 
 struct SSTableMeta {
@@ -33,6 +76,11 @@ struct SSTableMeta {
     uint64_t maxSeq;
     uint64_t sizeBytes;
     uint32_t level;
+    // Counted when the file is written; 0 for files listed before these were recorded
+    uint64_t numEntries = 0;
+    uint64_t numDeletions = 0;
+    // Latest expiry among the file's values; 0 when some value never expires or there are none
+    uint64_t expiresAt = 0;
 };
 
 #endif
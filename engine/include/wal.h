@@ -11,6 +11,7 @@
 #include <fstream>
 #include <functional>
 #include <iostream>
+#include <iterator>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -25,13 +26,22 @@ class WriteAheadLog {
     ~WriteAheadLog();
 
     void append(Operation op, const std::string &key, const std::string &value, uint64_t seqNumber);
+    // Replays the rotated log, if one is left, ahead of the current one
     void replay(std::function<void(uint64_t, Operation, std::string &, std::string &)> apply);
     bool empty() const;
+    // Moves everything appended so far into the rotated log, which is replayed until removeRotated(). A rotated log
+    // left from before a restart is appended to instead. No append may run concurrently.
+    void rotate();
+    void removeRotated();
     void flush();
     void syncFlush();
+    // Starts an fsync of everything appended so far without waiting for it; returns a ticket for waitForSync
+    uint64_t requestSync();
+    void waitForSync(uint64_t generation);
 
   private:
     std::string path_;
+    std::string rotated_path_;
     int fd_{-1};
 
     std::vector<char> write_buffer_;
@@ -55,6 +65,7 @@ class WriteAheadLog {
     static constexpr size_t MAX_BUFFER_SIZE = 256 * 1024; // 256KB buffer
 
     static uint32_t calculateChecksum(Operation op, const std::string &key, const std::string &value, uint64_t seqNumber);
+    void replayFile(const std::string &path, const std::function<void(uint64_t, Operation, std::string &, std::string &)> &apply);
     void syncThreadLoop();
     void doSync();
 };
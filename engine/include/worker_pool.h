@@ -0,0 +1,35 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// Fixed set of threads running background jobs. Exceptions thrown by a job surface through its future.
+class WorkerPool {
+  public:
+    explicit WorkerPool(size_t num_threads);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool &) = delete;
+    WorkerPool &operator=(const WorkerPool &) = delete;
+
+    std::future<void> submit(std::function<void()> job);
+    size_t size() const;
+
+  private:
+    std::vector<std::thread> workers_;
+    std::queue<std::packaged_task<void()>> jobs_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool shutdown_{false};
+
+    void workerLoop();
+};
+
+#endif
@@ -0,0 +1,74 @@
+#ifndef WRITE_CONTROLLER_H
+#define WRITE_CONTROLLER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+enum class WriteStallCondition : uint8_t { NORMAL, DELAYED, STOPPED };
+
+// Counters are write batches held back by each cause since the engine was opened.
+struct WriteStallStats {
+    WriteStallCondition condition = WriteStallCondition::NORMAL;
+    uint64_t l0_slowdowns = 0;
+    uint64_t l0_stops = 0;
+    uint64_t pending_compaction_slowdowns = 0;
+    uint64_t pending_compaction_stops = 0;
+    // Memtable fills up while the previous one is still being flushed
+    uint64_t memtable_stops = 0;
+    uint64_t delayed_micros = 0;
+    uint64_t stopped_micros = 0;
+};
+
+// Pushes back on writers when compaction falls behind. Past a soft limit writes are paced at delayed_write_rate,
+// falling towards a tenth of it as the hard limit nears; at a hard limit they stop until compaction catches up.
+// A limit of 0 is disabled.
+class WriteController {
+  public:
+    WriteController(size_t l0_slowdown_trigger, size_t l0_stop_trigger, uint64_t soft_pending_bytes, uint64_t hard_pending_bytes,
+                    uint64_t delayed_write_rate);
+
+    WriteController(const WriteController &) = delete;
+    WriteController &operator=(const WriteController &) = delete;
+
+    // Recomputes the stall condition from the current shape of the tree
+    void update(size_t l0_files, uint64_t pending_compaction_bytes);
+
+    // Called by the writer before applying bytes of writes; sleeps or blocks as the current condition requires
+    void throttle(size_t bytes);
+
+    void recordMemtableStop(uint64_t micros);
+
+    // Releases a blocked writer and disables further throttling
+    void shutdown();
+
+    WriteStallCondition condition() const;
+    WriteStallStats stats() const;
+
+  private:
+    using Clock = std::chrono::steady_clock;
+
+    const size_t l0_slowdown_trigger_;
+    const size_t l0_stop_trigger_;
+    const uint64_t soft_pending_bytes_;
+    const uint64_t hard_pending_bytes_;
+    const uint64_t delayed_write_rate_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    bool shutdown_ = false;
+
+    WriteStallCondition condition_ = WriteStallCondition::NORMAL;
+    bool l0_cause_ = false;
+    bool pending_cause_ = false;
+    // How far between the soft and hard limits the worst signal is, in [0, 1]
+    double severity_ = 0.0;
+    // Pacing owed by small batches, paid off in one sleep once it is long enough to be worth it
+    double delay_debt_micros_ = 0.0;
+
+    WriteStallStats stats_;
+};
+
+#endif
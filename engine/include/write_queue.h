@@ -2,22 +2,71 @@
 #define WRITE_QUEUE_H
 
 #include "types.h"
-#include <condition_variable>
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <future>
 #include <memory>
-#include <mutex>
 #include <optional>
-#include <queue>
 #include <string>
 #include <vector>
 
+// Lets threads block on their own writes without a promise/future pair. The commit thread counts each write
+// down and wakes the waiter, through a futex, only for the last one and only if the waiter went to sleep. A waiter
+// woken that way does not return until the waker is done with it, so the waiter can live on the caller's stack.
+class WriteWaiter {
+  public:
+    explicit WriteWaiter(uint32_t writes = 1) : state_(writes << PENDING_SHIFT) {
+    }
+
+    WriteWaiter(const WriteWaiter &) = delete;
+    WriteWaiter &operator=(const WriteWaiter &) = delete;
+
+    void notify(bool ok);
+    // Blocks until every write has been notified; returns whether all of them succeeded
+    bool wait();
+
+  private:
+    // Writes still pending above a flag set by a waiter about to sleep, and one set by the thread waking it once it
+    // no longer touches the waiter
+    static constexpr uint32_t PARKED = 1;
+    static constexpr uint32_t RELEASED = 2;
+    static constexpr uint32_t PENDING_SHIFT = 2;
+
+    std::atomic<uint32_t> state_;
+    std::atomic<bool> failed_{false};
+};
+
+// Keys an optimistic transaction read as of seq. The writer fails the transaction if any of them was written since.
+struct TransactionReads {
+    uint64_t seq = 0;
+    std::vector<std::string> keys; // Sorted and unique
+};
+
 struct WriteRequest {
     Operation op;
     std::string key;
     std::string value;
-    std::promise<bool> completion;
+    // Exactly one of these reports the result. A thread blocking on its own write keeps the request on its stack
+    // next to a WriteWaiter and allocates nothing; requests made by push(op, key, value) carry a promise or a
+    // callback. Callbacks run on the thread completing the request and must not block on the queue.
+    WriteWaiter *waiter = nullptr;
+    std::optional<std::promise<bool>> completion;
+    std::function<void(bool)> callback;
+    // A coroutine suspended on its own write, with the request in its frame. The result is left in coroutine_ok
+    // and the coroutine handed to the resume function given to complete, so nothing the frame owns is still running
+    // when it is resumed and may finish.
+    std::coroutine_handle<> coroutine;
+    bool coroutine_ok = false;
+    // Allocated by push(op, key, value) and freed once completed; otherwise owned by whoever pushed it
+    bool queue_owned = false;
+    // TRANSACTION only; owned by the caller
+    const TransactionReads *reads = nullptr;
 
-    WriteRequest(Operation op_, std::string key_, std::string value_) : op(op_), key(std::move(key_)), value(std::move(value_)) {
+    WriteRequest(Operation op_, std::string key_, std::string value_, WriteWaiter *waiter_ = nullptr)
+        : op(op_), key(std::move(key_)), value(std::move(value_)), waiter(waiter_) {
     }
 
     WriteRequest(WriteRequest &&) = default;
@@ -26,28 +75,75 @@ struct WriteRequest {
     WriteRequest &operator=(const WriteRequest &) = delete;
 };
 
+struct WriteRequestDeleter {
+    void operator()(WriteRequest *request) const {
+        if (request->queue_owned) {
+            delete request;
+        }
+    }
+};
+
+using WriteRequestPtr = std::unique_ptr<WriteRequest, WriteRequestDeleter>;
+
+// Bounded lock-free ring of write requests. Producers claim a slot with one compare-and-swap and never share a lock
+// with the consumer; each slot's sequence number says whether it is free or holds a published request. Threads
+// only park (on a futex, through std::atomic::wait) when the ring is empty or full, and are only woken if parked.
+// Built for many producers and the single writer thread; concurrent consumers are safe but contend on the head.
 class WriteQueue {
   public:
     explicit WriteQueue(size_t max_size = 10000);
     ~WriteQueue();
 
+    WriteQueue(const WriteQueue &) = delete;
+    WriteQueue &operator=(const WriteQueue &) = delete;
+
     std::future<bool> push(Operation op, const std::string &key, const std::string &value);
+    void push(Operation op, const std::string &key, const std::string &value, std::function<void(bool)> callback);
+    // Queues a request owned by the caller, which must keep it alive until it is completed. Once shut down every
+    // push completes its request with false instead.
+    void push(WriteRequest &request);
+
+    std::optional<WriteRequestPtr> pop();
 
-    std::optional<std::unique_ptr<WriteRequest>> pop();
+    // Waits for at least one request, then drains up to max_batch_size without waiting again
+    std::vector<WriteRequestPtr> popBatch(size_t max_batch_size = 1000);
 
-    std::vector<std::unique_ptr<WriteRequest>> popBatch(size_t max_batch_size = 1000);
+    // Reports the result of a popped request. A caller-owned request may be destroyed by its owner as soon as the
+    // result is reported, so the request must not be touched afterwards. Coroutines go to resume, or are resumed
+    // on this thread without one.
+    using Resumer = std::function<void(std::coroutine_handle<>)>;
+    static void complete(WriteRequestPtr request, bool ok, const Resumer &resume = {});
 
     void shutdown();
     bool isShutdown() const;
     size_t size() const;
 
   private:
-    mutable std::mutex mutex_;
-    std::condition_variable not_empty_cv_;
-    std::condition_variable not_full_cv_;
-    std::queue<std::unique_ptr<WriteRequest>> queue_;
-    size_t max_size_;
-    bool shutdown_{false};
+    struct Slot {
+        std::atomic<size_t> sequence;
+        WriteRequest *request = nullptr;
+    };
+
+    const size_t capacity_;
+    std::unique_ptr<Slot[]> slots_;
+
+    alignas(64) std::atomic<size_t> tail_{0}; // Next position to push
+    alignas(64) std::atomic<size_t> head_{0}; // Next position to pop
+
+    // Bumped on every push/pop so a parked thread can wait for a change. A thread sets the flag before its last
+    // check and parking; the first push/pop to clear it pays for the wake-up, the rest skip the syscall.
+    alignas(64) std::atomic<uint32_t> pushes_{0};
+    std::atomic<bool> consumer_parked_{false};
+    alignas(64) std::atomic<uint32_t> pops_{0};
+    std::atomic<bool> producers_parked_{false};
+
+    std::atomic<bool> shutdown_{false};
+
+    void enqueue(WriteRequest *request);
+    bool tryPush(WriteRequest *request);
+    WriteRequestPtr tryPop();
+    // Blocks until a request is available; returns null once shut down and empty
+    WriteRequestPtr waitPop();
 };
 
 #endif
@@ -0,0 +1,242 @@
+#include "blob_store.h"
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+std::string BlobHandle::encode() const {
+    std::string out;
+    putVarint64(out, file_number);
+    putVarint64(out, offset);
+    putVarint32(out, size);
+    return out;
+}
+
+bool BlobHandle::decode(const std::string &data, BlobHandle &out) {
+    const char *p = data.data();
+    const char *limit = p + data.size();
+    return getVarint64(p, limit, out.file_number) && getVarint64(p, limit, out.offset) && getVarint32(p, limit, out.size) &&
+           p == limit;
+}
+
+BlobStore::BlobStore(const std::string &dir, size_t max_file_size, double gc_discard_ratio)
+    : dir_(dir), max_file_size_(max_file_size), gc_discard_ratio_(gc_discard_ratio) {
+    std::filesystem::create_directories(dir_);
+    loadStats();
+}
+
+BlobStore::~BlobStore() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    try {
+        syncLocked();
+    } catch (const std::exception &e) {
+        std::cerr << "Blob store sync failed: " << e.what() << std::endl;
+    }
+
+    if (active_fd_ != -1) {
+        close(active_fd_);
+        active_fd_ = -1;
+    }
+}
+
+std::string BlobStore::filePath(uint64_t file_number) const {
+    return dir_ + "/blob_" + std::to_string(file_number) + ".blob";
+}
+
+std::string BlobStore::statsPath() const {
+    return dir_ + "/blob_stats.txt";
+}
+
+uint64_t BlobStore::scanValueBytes(const std::string &path) {
+    std::ifstream file(path, std::ios::binary);
+    uint64_t total = 0;
+    char header[2 * sizeof(uint32_t)];
+    while (file.read(header, sizeof(header))) {
+        uint32_t keyLen = decodeFixed32(header);
+        uint32_t valueLen = decodeFixed32(header + sizeof(uint32_t));
+        if (!file.seekg(static_cast<std::streamoff>(keyLen) + valueLen, std::ios::cur)) {
+            break;
+        }
+        total += valueLen;
+    }
+    return total;
+}
+
+void BlobStore::loadStats() {
+    std::ifstream statsFile(statsPath());
+    uint64_t number;
+    FileStats fs;
+    while (statsFile >> number >> fs.total_bytes >> fs.discarded_bytes) {
+        stats_[number] = fs;
+    }
+
+    // Files written after the last stats save are fully live
+    uint64_t max_number = 0;
+    for (const auto &dirEntry : std::filesystem::directory_iterator(dir_)) {
+        const std::string name = dirEntry.path().filename().string();
+        if (name.rfind("blob_", 0) != 0 || dirEntry.path().extension() != ".blob") {
+            continue;
+        }
+        uint64_t n = std::stoull(name.substr(5, name.size() - 10));
+        max_number = std::max(max_number, n);
+        if (!stats_.contains(n)) {
+            stats_[n] = FileStats{scanValueBytes(dirEntry.path().string()), 0};
+        }
+    }
+
+    for (auto it = stats_.begin(); it != stats_.end();) {
+        if (!std::filesystem::exists(filePath(it->first))) {
+            it = stats_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    // Never append to a file from a previous run; its tail may be torn
+    active_number_ = max_number + 1;
+}
+
+void BlobStore::openNewFileLocked() {
+    active_fd_ = open(filePath(active_number_).c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (active_fd_ == -1) {
+        throw std::runtime_error("Failed to open blob file: " + filePath(active_number_) + " - " + strerror(errno));
+    }
+    active_offset_ = 0;
+    stats_[active_number_] = FileStats{};
+}
+
+BlobHandle BlobStore::add(const std::string &key, const std::string &value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (active_fd_ == -1) {
+        openNewFileLocked();
+    }
+
+    putFixed32(pending_, static_cast<uint32_t>(key.size()));
+    putFixed32(pending_, static_cast<uint32_t>(value.size()));
+    pending_.append(key);
+
+    BlobHandle handle{active_number_, active_offset_ + 2 * sizeof(uint32_t) + key.size(), static_cast<uint32_t>(value.size())};
+    pending_.append(value);
+
+    active_offset_ += 2 * sizeof(uint32_t) + key.size() + value.size();
+    stats_[active_number_].total_bytes += value.size();
+
+    if (active_offset_ >= max_file_size_) {
+        syncLocked();
+        close(active_fd_);
+        active_fd_ = -1;
+        active_number_++;
+        maybeDeleteLocked(active_number_ - 1);
+    }
+
+    return handle;
+}
+
+void BlobStore::sync() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    syncLocked();
+}
+
+void BlobStore::syncLocked() {
+    if (pending_.empty() || active_fd_ == -1) {
+        return;
+    }
+
+    const char *p = pending_.data();
+    size_t remaining = pending_.size();
+    while (remaining > 0) {
+        ssize_t written = write(active_fd_, p, remaining);
+        if (written == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error("Blob write failed: " + std::string(strerror(errno)));
+        }
+        p += written;
+        remaining -= static_cast<size_t>(written);
+    }
+    fsync(active_fd_);
+    pending_.clear();
+}
+
+std::string BlobStore::read(const BlobHandle &handle) const {
+    std::shared_ptr<ReadFile> file;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = readers_.find(handle.file_number);
+        if (it != readers_.end()) {
+            file = it->second;
+        } else {
+            int fd = open(filePath(handle.file_number).c_str(), O_RDONLY);
+            if (fd == -1) {
+                throw std::runtime_error("Failed to open blob file: " + filePath(handle.file_number));
+            }
+            file = std::make_shared<ReadFile>(fd);
+            readers_[handle.file_number] = file;
+        }
+    }
+
+    std::string value(handle.size, '\0');
+    size_t done = 0;
+    while (done < handle.size) {
+        ssize_t n = pread(file->fd, value.data() + done, handle.size - done, static_cast<off_t>(handle.offset + done));
+        if (n <= 0) {
+            if (n == -1 && errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error("Failed to read blob from file " + std::to_string(handle.file_number));
+        }
+        done += static_cast<size_t>(n);
+    }
+    return value;
+}
+
+void BlobStore::discard(const BlobHandle &handle) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = stats_.find(handle.file_number);
+    if (it == stats_.end()) {
+        return;
+    }
+    it->second.discarded_bytes += handle.size;
+    maybeDeleteLocked(handle.file_number);
+}
+
+void BlobStore::maybeDeleteLocked(uint64_t file_number) {
+    auto it = stats_.find(file_number);
+    if (it == stats_.end() || file_number == active_number_ || it->second.discarded_bytes < it->second.total_bytes) {
+        return;
+    }
+
+    // In-flight reads keep their descriptor alive through the shared_ptr
+    readers_.erase(file_number);
+    stats_.erase(it);
+    std::filesystem::remove(filePath(file_number));
+}
+
+bool BlobStore::shouldRelocate(uint64_t file_number) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = stats_.find(file_number);
+    if (it == stats_.end() || file_number == active_number_ || it->second.total_bytes == 0) {
+        return false;
+    }
+    return static_cast<double>(it->second.discarded_bytes) >= gc_discard_ratio_ * static_cast<double>(it->second.total_bytes);
+}
+
+std::map<uint64_t, BlobStore::FileStats> BlobStore::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void BlobStore::saveStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::ofstream statsFile(statsPath());
+    if (!statsFile) {
+        std::cerr << "Error: Could not open " << statsPath() << '\n';
+        return;
+    }
+    for (const auto &[number, fs] : stats_) {
+        statsFile << number << ' ' << fs.total_bytes << ' ' << fs.discarded_bytes << '\n';
+    }
+}
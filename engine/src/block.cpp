@@ -0,0 +1,184 @@
+#include "block.h"
+
+BlockBuilder::BlockBuilder(size_t restart_interval) : restart_interval_(restart_interval) {
+    restarts_.push_back(0);
+}
+
+void BlockBuilder::add(const std::string &key, const std::string &value, uint64_t seq, EntryType type, uint64_t expires_at_ms) {
+    size_t shared = 0;
+    if (counter_ < restart_interval_) {
+        shared = sharedPrefixLength(last_key_, key);
+    } else {
+        restarts_.push_back(static_cast<uint32_t>(buffer_.size()));
+        counter_ = 0;
+    }
+
+    const size_t unshared = key.size() - shared;
+    putVarint32(buffer_, static_cast<uint32_t>(shared));
+    putVarint32(buffer_, static_cast<uint32_t>(unshared));
+    putVarint32(buffer_, static_cast<uint32_t>(value.size()));
+    putFixed64(buffer_, seq);
+    if (expires_at_ms != 0) {
+        buffer_.push_back(static_cast<char>(static_cast<uint8_t>(type) | Block::EXPIRY_FLAG));
+        putFixed64(buffer_, expires_at_ms);
+    } else {
+        buffer_.push_back(static_cast<char>(type));
+    }
+    buffer_.append(key.data() + shared, unshared);
+    buffer_.append(value);
+
+    last_key_ = key;
+    counter_++;
+}
+
+std::string BlockBuilder::finish() {
+    for (uint32_t restart : restarts_) {
+        putFixed32(buffer_, restart);
+    }
+    putFixed32(buffer_, static_cast<uint32_t>(restarts_.size()));
+
+    std::string result = std::move(buffer_);
+    reset();
+    return result;
+}
+
+void BlockBuilder::reset() {
+    buffer_.clear();
+    restarts_.clear();
+    restarts_.push_back(0);
+    last_key_.clear();
+    counter_ = 0;
+}
+
+size_t BlockBuilder::estimatedSize() const {
+    return buffer_.size() + restarts_.size() * sizeof(uint32_t) + sizeof(uint32_t);
+}
+
+bool BlockBuilder::empty() const {
+    return buffer_.empty();
+}
+
+Block::Block(std::string contents) : data_(std::move(contents)) {
+    if (data_.size() < sizeof(uint32_t)) {
+        return;
+    }
+
+    uint32_t count = decodeFixed32(data_.data() + data_.size() - sizeof(uint32_t));
+    size_t max_restarts = (data_.size() - sizeof(uint32_t)) / sizeof(uint32_t);
+    if (count == 0 || count > max_restarts) {
+        return;
+    }
+
+    num_restarts_ = count;
+    restarts_offset_ = static_cast<uint32_t>(data_.size() - (1 + num_restarts_) * sizeof(uint32_t));
+}
+
+size_t Block::size() const {
+    return data_.size();
+}
+
+uint32_t Block::numRestarts() const {
+    return num_restarts_;
+}
+
+uint32_t Block::restartPoint(uint32_t index) const {
+    return decodeFixed32(data_.data() + restarts_offset_ + index * sizeof(uint32_t));
+}
+
+Block::Iterator::Iterator(const Block &block) : block_(&block) {
+}
+
+bool Block::Iterator::valid() const {
+    return valid_;
+}
+
+const SSTableEntry &Block::Iterator::entry() const {
+    return current_;
+}
+
+void Block::Iterator::seekToFirst() {
+    seekToRestart(0);
+    parseNext();
+}
+
+void Block::Iterator::seek(const std::string &target) {
+    if (block_->num_restarts_ == 0) {
+        valid_ = false;
+        return;
+    }
+
+    // Binary search for the last restart point whose key is < target
+    uint32_t left = 0;
+    uint32_t right = block_->num_restarts_ - 1;
+    while (left < right) {
+        uint32_t mid = left + (right - left + 1) / 2;
+        seekToRestart(mid);
+        if (!parseNext()) {
+            valid_ = false;
+            return;
+        }
+        if (current_.key < target) {
+            left = mid;
+        } else {
+            right = mid - 1;
+        }
+    }
+
+    seekToRestart(left);
+    while (parseNext()) {
+        if (current_.key >= target) {
+            return;
+        }
+    }
+}
+
+void Block::Iterator::next() {
+    parseNext();
+}
+
+void Block::Iterator::seekToRestart(uint32_t index) {
+    current_.key.clear();
+    next_offset_ = index < block_->num_restarts_ ? block_->restartPoint(index) : block_->restarts_offset_;
+}
+
+bool Block::Iterator::parseNext() {
+    const char *base = block_->data_.data();
+    const char *p = base + next_offset_;
+    const char *limit = base + block_->restarts_offset_;
+
+    if (p >= limit) {
+        valid_ = false;
+        return false;
+    }
+
+    uint32_t shared, unshared, valueLen;
+    if (!getVarint32(p, limit, shared) || !getVarint32(p, limit, unshared) || !getVarint32(p, limit, valueLen) ||
+        shared > current_.key.size() || static_cast<size_t>(limit - p) < sizeof(uint64_t) + 1 + unshared + valueLen) {
+        valid_ = false;
+        return false;
+    }
+
+    current_.seq = decodeFixed64(p);
+    p += sizeof(uint64_t);
+    uint8_t type = static_cast<uint8_t>(*p++);
+    current_.type = static_cast<EntryType>(type & ~EXPIRY_FLAG);
+    current_.expires_at_ms = 0;
+    if (type & EXPIRY_FLAG) {
+        if (static_cast<size_t>(limit - p) < sizeof(uint64_t) + unshared + valueLen) {
+            valid_ = false;
+            return false;
+        }
+        current_.expires_at_ms = decodeFixed64(p);
+        p += sizeof(uint64_t);
+    }
+
+    current_.key.resize(shared);
+    current_.key.append(p, unshared);
+    p += unshared;
+    current_.value.assign(p, valueLen);
+    p += valueLen;
+
+    next_offset_ = static_cast<uint32_t>(p - base);
+    valid_ = true;
+    return true;
+}
@@ -0,0 +1,61 @@
+#include "block_cache.h"
+
+BlockCache::BlockCache(size_t capacity_bytes) : capacity_(capacity_bytes) {
+}
+
+std::shared_ptr<Block> BlockCache::get(uint64_t table_id, uint64_t offset) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = cache_.find(CacheKey{table_id, offset});
+    if (it == cache_.end()) {
+        return nullptr;
+    }
+
+    lru_list_.splice(lru_list_.begin(), lru_list_, it->second.list_iter);
+
+    return it->second.block;
+}
+
+void BlockCache::put(uint64_t table_id, uint64_t offset, std::shared_ptr<Block> block) {
+    if (!block || block->size() > capacity_) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    CacheKey key{table_id, offset};
+    auto it = cache_.find(key);
+
+    if (it != cache_.end()) {
+        usage_ -= it->second.block->size();
+        usage_ += block->size();
+        it->second.block = std::move(block);
+        lru_list_.splice(lru_list_.begin(), lru_list_, it->second.list_iter);
+    } else {
+        usage_ += block->size();
+        lru_list_.push_front(key);
+        cache_[key] = CacheNode{std::move(block), lru_list_.begin()};
+    }
+
+    while (usage_ > capacity_ && !lru_list_.empty()) {
+        auto victim = cache_.find(lru_list_.back());
+        usage_ -= victim->second.block->size();
+        cache_.erase(victim);
+        lru_list_.pop_back();
+    }
+}
+
+void BlockCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    cache_.clear();
+    lru_list_.clear();
+    usage_ = 0;
+}
+
+size_t BlockCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return cache_.size();
+}
+
+size_t BlockCache::usage() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return usage_;
+}
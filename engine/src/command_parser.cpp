@@ -1,6 +1,6 @@
 #include "command_parser.h"
 
-// Parse input commands like: put("key", "value"), get("key"), delete("key")
+// Parse input commands like: put("key", "value"), get("key"), delete("key"), deleteRange("start", "end")
 Operation parseCommand(const std::string &input, std::string &key, std::string &value) {
     key.clear();
     value.clear();
@@ -38,6 +38,21 @@ Operation parseCommand(const std::string &input, std::string &key, std::string &
 
         key = input.substr(startKey + 1, endKey - startKey - 1);
         return Operation::DELETE;
+    } else if (input.substr(0, 12) == "deleteRange(") {
+        size_t startKey = input.find('"');
+        size_t endKey = input.find('"', startKey + 1);
+        if (startKey == std::string::npos || endKey == std::string::npos)
+            return Operation::ERROR;
+
+        key = input.substr(startKey + 1, endKey - startKey - 1);
+
+        size_t startValue = input.find('"', endKey + 1);
+        size_t endValue = input.find('"', startValue + 1);
+        if (startValue == std::string::npos || endValue == std::string::npos)
+            return Operation::ERROR;
+
+        value = input.substr(startValue + 1, endValue - startValue - 1);
+        return Operation::DELETE_RANGE;
     } else if (input.substr(0, 2) == "ls") {
         if (input.size() != 2) {
             return Operation::ERROR;
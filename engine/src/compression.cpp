@@ -0,0 +1,203 @@
+#include "compression.h"
+#include "coding.h"
+#include <algorithm>
+#include <queue>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <zlib.h>
+
+static constexpr int kZlibLevel = Z_BEST_SPEED;
+
+// Dictionary training works on d-byte grams grouped into k-byte candidate segments
+static constexpr size_t kDictGramSize = 8;
+static constexpr size_t kDictSegmentSize = 64;
+
+// Only keep compressed output that is at least 12.5% smaller than the input
+static bool worthKeeping(size_t raw_size, size_t compressed_size) {
+    return compressed_size < raw_size - raw_size / 8;
+}
+
+static bool zlibCompress(const std::string &raw, std::string &out, const std::string &dictionary) {
+    z_stream strm{};
+    if (deflateInit(&strm, kZlibLevel) != Z_OK) {
+        return false;
+    }
+
+    if (!dictionary.empty() &&
+        deflateSetDictionary(&strm, reinterpret_cast<const Bytef *>(dictionary.data()), static_cast<uInt>(dictionary.size())) != Z_OK) {
+        deflateEnd(&strm);
+        return false;
+    }
+
+    size_t header = out.size();
+    out.resize(header + deflateBound(&strm, raw.size()));
+
+    strm.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(raw.data()));
+    strm.avail_in = static_cast<uInt>(raw.size());
+    strm.next_out = reinterpret_cast<Bytef *>(out.data() + header);
+    strm.avail_out = static_cast<uInt>(out.size() - header);
+
+    int rc = deflate(&strm, Z_FINISH);
+    out.resize(header + strm.total_out);
+    deflateEnd(&strm);
+    return rc == Z_STREAM_END;
+}
+
+static std::string zlibDecompress(const char *data, size_t size, uint32_t raw_size, const std::string &dictionary) {
+    z_stream strm{};
+    if (inflateInit(&strm) != Z_OK) {
+        throw std::runtime_error("Failed to initialize zlib");
+    }
+
+    std::string raw(raw_size, '\0');
+    strm.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data));
+    strm.avail_in = static_cast<uInt>(size);
+    strm.next_out = reinterpret_cast<Bytef *>(raw.data());
+    strm.avail_out = raw_size;
+
+    int rc = inflate(&strm, Z_FINISH);
+    if (rc == Z_NEED_DICT && !dictionary.empty()) {
+        rc = inflateSetDictionary(&strm, reinterpret_cast<const Bytef *>(dictionary.data()), static_cast<uInt>(dictionary.size()));
+        if (rc == Z_OK) {
+            rc = inflate(&strm, Z_FINISH);
+        }
+    }
+
+    uLong total = strm.total_out;
+    inflateEnd(&strm);
+
+    if (rc != Z_STREAM_END || total != raw_size) {
+        throw std::runtime_error("Failed to decompress block");
+    }
+    return raw;
+}
+
+bool compressBlock(CompressionType type, const std::string &raw, std::string &out, const std::string &dictionary) {
+    switch (type) {
+    case CompressionType::NONE:
+        return false;
+
+    case CompressionType::ZLIB: {
+        std::string result;
+        putVarint32(result, static_cast<uint32_t>(raw.size()));
+
+        if (!zlibCompress(raw, result, dictionary) || !worthKeeping(raw.size(), result.size())) {
+            return false;
+        }
+        out = std::move(result);
+        return true;
+    }
+    }
+    return false;
+}
+
+std::string decompressBlock(CompressionType type, const char *data, size_t size, const std::string &dictionary) {
+    switch (type) {
+    case CompressionType::NONE:
+        return std::string(data, size);
+
+    case CompressionType::ZLIB: {
+        const char *p = data;
+        const char *limit = data + size;
+        uint32_t raw_size;
+        if (!getVarint32(p, limit, raw_size)) {
+            throw std::runtime_error("Corrupted compressed block header");
+        }
+        return zlibDecompress(p, limit - p, raw_size, dictionary);
+    }
+    }
+    throw std::runtime_error("Unknown block compression type");
+}
+
+std::string trainDictionary(const std::vector<std::string> &samples, size_t max_bytes) {
+    if (max_bytes == 0) {
+        return "";
+    }
+
+    auto gramHash = [](const std::string &s, size_t pos) {
+        return std::hash<std::string_view>{}(std::string_view(s).substr(pos, kDictGramSize));
+    };
+
+    // Number of samples each gram appears in; content shared by many values is what a dictionary is for
+    std::unordered_map<size_t, uint32_t> frequency;
+    for (const auto &sample : samples) {
+        std::unordered_set<size_t> seen;
+        for (size_t i = 0; i + kDictGramSize <= sample.size(); i++) {
+            size_t h = gramHash(sample, i);
+            if (seen.insert(h).second) {
+                frequency[h]++;
+            }
+        }
+    }
+
+    struct Candidate {
+        uint64_t score;
+        size_t sample;
+        size_t offset;
+        size_t length;
+        bool operator<(const Candidate &other) const {
+            return score < other.score;
+        }
+    };
+
+    auto scoreSegment = [&](const Candidate &c) {
+        uint64_t score = 0;
+        std::unordered_set<size_t> counted;
+        for (size_t i = c.offset; i + kDictGramSize <= c.offset + c.length; i++) {
+            size_t h = gramHash(samples[c.sample], i);
+            auto it = frequency.find(h);
+            if (it != frequency.end() && it->second > 1 && counted.insert(h).second) {
+                score += it->second;
+            }
+        }
+        return score;
+    };
+
+    std::priority_queue<Candidate> candidates;
+    for (size_t s = 0; s < samples.size(); s++) {
+        for (size_t offset = 0; offset < samples[s].size(); offset += kDictSegmentSize) {
+            Candidate c{0, s, offset, std::min(kDictSegmentSize, samples[s].size() - offset)};
+            c.score = scoreSegment(c);
+            if (c.score > 0) {
+                candidates.push(c);
+            }
+        }
+    }
+
+    // Greedy selection with lazy re-scoring: once a segment is chosen its grams stop counting,
+    // so near-duplicate segments fall down the queue instead of filling the dictionary.
+    std::vector<Candidate> chosen;
+    size_t total = 0;
+    while (!candidates.empty() && total < max_bytes) {
+        Candidate top = candidates.top();
+        candidates.pop();
+
+        uint64_t current = scoreSegment(top);
+        if (current == 0) {
+            continue;
+        }
+        if (current < top.score && !candidates.empty() && current < candidates.top().score) {
+            top.score = current;
+            candidates.push(top);
+            continue;
+        }
+
+        top.length = std::min(top.length, max_bytes - total);
+        chosen.push_back(top);
+        total += top.length;
+
+        for (size_t i = top.offset; i + kDictGramSize <= top.offset + top.length; i++) {
+            frequency.erase(gramHash(samples[top.sample], i));
+        }
+    }
+
+    // zlib matches against recent bytes more cheaply, so the best segments go last
+    std::string dictionary;
+    dictionary.reserve(total);
+    for (auto it = chosen.rbegin(); it != chosen.rend(); ++it) {
+        dictionary.append(samples[it->sample], it->offset, it->length);
+    }
+    return dictionary;
+}
@@ -1,9 +1,41 @@
 #include "engine.h"
+#include "transaction.h"
+#include <iterator>
 
-StorageEngine::StorageEngine(const std::string &data_dir, size_t cache_size)
-    : data_dir_(data_dir), wal_(data_dir + "/log.bin"), memtable_(), seq_number_(1) {
-    if (cache_size > 0) {
-        cache_.emplace(cache_size);
+StorageEngine::StorageEngine(const std::string &data_dir) : StorageEngine(data_dir, EngineOptions{}) {
+}
+
+StorageEngine::StorageEngine(const std::string &data_dir, const EngineOptions &options)
+    : data_dir_(data_dir), options_(options), wal_(data_dir + "/log.bin"), memtable_(), seq_number_(1),
+      write_controller_(options.level0_slowdown_writes_trigger, options.level0_stop_writes_trigger,
+                        options.soft_pending_compaction_bytes_limit, options.hard_pending_compaction_bytes_limit,
+                        options.delayed_write_rate) {
+    if (options_.row_cache_bytes >= RowCache::minCapacity(options_.row_cache_shard_bits)) {
+        cache_ = std::make_unique<RowCache>(options_.row_cache_bytes, options_.row_cache_shard_bits, options_.row_cache_policy);
+    } else if (options_.row_cache_bytes > 0) {
+        std::cerr << "Warning: row cache of " << options_.row_cache_bytes << " bytes cannot hold one entry per shard; "
+                  << "need at least " << RowCache::minCapacity(options_.row_cache_shard_bits) << ", row cache disabled" << std::endl;
+    }
+
+    if (options_.block_cache_bytes > 0) {
+        block_cache_ = std::make_shared<BlockCache>(options_.block_cache_bytes);
+    }
+
+    // Open the blob store whenever blob files may exist so earlier separated values stay readable
+    if (options_.blob_value_threshold > 0 || std::filesystem::exists(data_dir_ + "/blobs")) {
+        blob_store_ = std::make_unique<BlobStore>(data_dir_ + "/blobs", options_.blob_file_size, options_.blob_gc_discard_ratio);
+    }
+
+    compaction_pool_ = std::make_unique<WorkerPool>(std::max<size_t>(1, options_.max_background_compactions));
+
+    // Each compaction job runs its first shard itself
+    if (options_.max_subcompactions > 1) {
+        subcompaction_pool_ = std::make_unique<WorkerPool>(options_.max_subcompactions - 1);
+    }
+
+    if (options_.rate_limit_bytes_per_sec > 0) {
+        uint64_t rate = options_.rate_limit_bytes_per_sec;
+        rate_limiter_ = std::make_unique<RateLimiter>(options_.rate_limit_auto_tune ? std::max<uint64_t>(1, rate / 10) : rate);
     }
 
     try {
@@ -17,7 +49,7 @@ StorageEngine::StorageEngine(const std::string &data_dir, size_t cache_size)
     if (!metadataFile) {
         flush_counter_ = 0;
         auto initialVersion = std::make_shared<TableVersion>();
-        initialVersion->levels.resize(4);
+        initialVersion->levels.resize(options_.num_levels);
         version_manager_.installVersion(initialVersion);
     } else {
         std::string line;
@@ -26,25 +58,39 @@ StorageEngine::StorageEngine(const std::string &data_dir, size_t cache_size)
 
         std::getline(metadataFile, line);
         seq_number_ = stoull(line);
+        published_seq_.store(seq_number_ - 1, std::memory_order_release);
 
         loadLevelMetadata();
         loadSSTables();
     }
+    removeUnlistedSSTables();
 
     recover();
+    updateCompactionPressure();
+
+    async_pool_ = std::make_unique<WorkerPool>(std::max<size_t>(1, options_.async_read_threads));
 
     flush_thread_ = std::thread(&StorageEngine::flushThreadLoop, this);
+    commit_thread_ = std::thread(&StorageEngine::commitThreadLoop, this);
     writer_thread_ = std::thread(&StorageEngine::writerThreadLoop, this);
     compaction_thread_ = std::thread(&StorageEngine::compactionThreadLoop, this);
 }
 
 StorageEngine::~StorageEngine() {
     writer_shutdown_.store(true, std::memory_order_release);
+    write_controller_.shutdown();
     write_queue_.shutdown();
 
     if (writer_thread_.joinable()) {
         writer_thread_.join();
     }
+    if (commit_thread_.joinable()) {
+        commit_thread_.join();
+    }
+
+    // Finish queued async reads and resume coroutines whose writes just committed while everything they touch is
+    // still there; writes they make from here on fail
+    async_pool_.reset();
 
     {
         std::lock_guard<std::mutex> lock(flush_mutex_);
@@ -56,6 +102,11 @@ StorageEngine::~StorageEngine() {
         flush_thread_.join();
     }
 
+    // Let in-flight compactions finish at full speed
+    if (rate_limiter_) {
+        rate_limiter_->setBytesPerSecond(0);
+    }
+
     {
         std::lock_guard<std::mutex> lock(compaction_mutex_);
     }
@@ -64,6 +115,15 @@ StorageEngine::~StorageEngine() {
     if (compaction_thread_.joinable()) {
         compaction_thread_.join();
     }
+
+    // Snapshots never released stop pinning anything here
+    std::vector<BlobHandle> discards;
+    {
+        std::lock_guard<std::mutex> lock(snapshot_mutex_);
+        snapshots_.clear();
+        discards.swap(deferred_blob_discards_);
+    }
+    releaseBlobs(discards);
 }
 
 void StorageEngine::loadLevelMetadata() {
@@ -71,7 +131,7 @@ void StorageEngine::loadLevelMetadata() {
 
     std::ifstream levelFile(data_dir_ + "/levels.txt");
     if (!levelFile) {
-        newVersion->levels.resize(4);
+        newVersion->levels.resize(options_.num_levels);
         version_manager_.installVersion(newVersion);
         return;
     }
@@ -85,6 +145,13 @@ void StorageEngine::loadLevelMetadata() {
         std::istringstream iss(line);
         SSTableMeta meta;
         iss >> meta.id >> meta.level >> meta.minKey >> meta.maxKey >> meta.maxSeq >> meta.sizeBytes;
+        if (!(iss >> meta.numEntries >> meta.numDeletions)) {
+            meta.numEntries = 0;
+            meta.numDeletions = 0;
+        }
+        if (!(iss >> meta.expiresAt)) {
+            meta.expiresAt = 0;
+        }
 
         if (meta.level >= newVersion->levels.size()) {
             newVersion->levels.resize(meta.level + 1);
@@ -93,8 +160,9 @@ void StorageEngine::loadLevelMetadata() {
         newVersion->levels[meta.level].push_back(meta);
     }
 
-    if (newVersion->levels.empty()) {
-        newVersion->levels.resize(4);
+    // Files from a deeper configuration stay readable; their extra levels are kept
+    if (newVersion->levels.size() < options_.num_levels) {
+        newVersion->levels.resize(options_.num_levels);
     }
 
     newVersion->flush_counter = flush_counter_;
@@ -108,7 +176,9 @@ void StorageEngine::loadSSTables() {
         for (const auto &meta : levelMetas) {
             std::string path = data_dir_ + "/sstables/sstable_" + std::to_string(meta.id) + ".bin";
             if (std::filesystem::exists(path)) {
-                newVersion->sstables.push_back(std::make_shared<SSTable>(path));
+                auto sst = std::make_shared<SSTable>(path);
+                sst->setBlockCache(block_cache_);
+                newVersion->sstables.push_back(std::move(sst));
             } else {
                 std::cerr << "Warning: SSTable file was not found: " << path << '\n';
             }
@@ -118,9 +188,113 @@ void StorageEngine::loadSSTables() {
     version_manager_.installVersion(newVersion);
 }
 
+void StorageEngine::removeUnlistedSSTables() {
+    auto version = version_manager_.getCurrentVersion();
+    std::unordered_set<std::string> listed;
+    for (const auto &levelMetas : version->levels) {
+        for (const auto &meta : levelMetas) {
+            listed.insert("sstable_" + std::to_string(meta.id) + ".bin");
+        }
+    }
+
+    std::error_code ec;
+    for (const auto &entry : std::filesystem::directory_iterator(data_dir_ + "/sstables", ec)) {
+        const std::string name = entry.path().filename().string();
+        if (name.starts_with("sstable_") && entry.path().extension() == ".bin" && !listed.contains(name)) {
+            std::filesystem::remove(entry.path(), ec);
+        }
+    }
+}
+
+bool StorageEngine::writeAndWait(Operation op, const std::string &key, const std::string &value) {
+    if (onCommitThread()) {
+        return false;
+    }
+
+    WriteWaiter waiter;
+    WriteRequest request(op, key, value, &waiter);
+    write_queue_.push(request);
+    return waiter.wait();
+}
+
+bool StorageEngine::commitTransaction(const std::string &writes, const TransactionReads &reads) {
+    if (onCommitThread()) {
+        return false;
+    }
+
+    WriteWaiter waiter;
+    WriteRequest request(Operation::TRANSACTION, "", writes, &waiter);
+    request.reads = &reads;
+    write_queue_.push(request);
+    return waiter.wait();
+}
+
+// Runs on the writer thread
+// Whether any of the writes hits one of the sorted keys
+static bool writesTouch(const std::vector<MemTableWrite> &writes, const std::vector<std::string> &keys) {
+    return std::any_of(writes.begin(), writes.end(), [&keys](const MemTableWrite &write) {
+        if (write.op != Operation::DELETE_RANGE) {
+            return std::binary_search(keys.begin(), keys.end(), write.key);
+        }
+        auto it = std::lower_bound(keys.begin(), keys.end(), write.key);
+        return it != keys.end() && *it < write.value;
+    });
+}
+
+bool StorageEngine::transactionReadsCurrent(const TransactionReads &reads, const std::vector<MemTableWrite> &pending) {
+    if (writesTouch(pending, reads.keys)) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(snapshot_mutex_);
+    // Batches published by now are in the memtable; the rest are searched where the writer left them. Either way
+    // their writes are newer than any snapshot, so touching a read key at all is a conflict.
+    const uint64_t published = published_seq_.load(std::memory_order_acquire);
+    for (const auto &batch : unpublished_batches_) {
+        if (batch->last_seq > published && writesTouch(batch->writes, reads.keys)) {
+            return false;
+        }
+    }
+
+    std::shared_ptr<MemTable> immutable;
+    if (reads.seq + 1 < memtable_start_seq_) {
+        immutable = std::atomic_load(&immutable_memtable_);
+        // Later writes may already be in SSTables, where the newest seq of a key is not at hand; fail rather than look
+        if (!immutable || reads.seq + 1 < immutable_start_seq_) {
+            return false;
+        }
+    }
+
+    auto writtenAfter = [&reads](const MemTable &table, const std::string &key) {
+        Entry entry;
+        return (table.get(key, entry) && entry.seq > reads.seq) || table.coveringTombstoneSeq(key) > reads.seq;
+    };
+    for (const auto &key : reads.keys) {
+        if (writtenAfter(memtable_, key) || (immutable && writtenAfter(*immutable, key))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// The commit thread completes every write, so a blocking write made from a completion callback would never return
+bool StorageEngine::onCommitThread() const {
+    if (std::this_thread::get_id() != commit_thread_.get_id()) {
+        return false;
+    }
+    std::cerr << "Blocking write from a write completion callback; use the async API there" << std::endl;
+    return true;
+}
+
 bool StorageEngine::put(const std::string &key, const std::string &value) {
-    std::future<bool> result = write_queue_.push(Operation::PUT, key, value);
-    return result.get();
+    return writeAndWait(Operation::PUT, key, value);
+}
+
+bool StorageEngine::put(const std::string &key, const std::string &value, std::chrono::milliseconds ttl) {
+    std::string encoded;
+    putFixed64(encoded, currentTimeMillis() + static_cast<uint64_t>(std::max<int64_t>(1, ttl.count())));
+    encoded.append(value);
+    return writeAndWait(Operation::PUT_TTL, key, encoded);
 }
 
 std::future<bool> StorageEngine::putAsync(const std::string &key, const std::string &value) {
@@ -131,44 +305,249 @@ bool StorageEngine::del(const std::string &key) {
     Entry existing;
     bool existed = get(key, existing);
 
-    std::future<bool> result = write_queue_.push(Operation::DELETE, key, "");
-    result.get();
+    writeAndWait(Operation::DELETE, key, "");
 
     return existed;
 }
 
+bool StorageEngine::blindDel(const std::string &key) {
+    return writeAndWait(Operation::DELETE, key, "");
+}
+
+bool StorageEngine::deleteRange(const std::string &start, const std::string &end) {
+    if (start >= end) {
+        return false;
+    }
+    return writeAndWait(Operation::DELETE_RANGE, start, end);
+}
+
+bool StorageEngine::write(const std::vector<BatchWrite> &writes) {
+    if (writes.empty()) {
+        return true;
+    }
+    if (onCommitThread()) {
+        return false;
+    }
+
+    // One allocation for the whole batch; the requests must not move once queued
+    WriteWaiter waiter(static_cast<uint32_t>(writes.size()));
+    std::vector<WriteRequest> requests;
+    requests.reserve(writes.size());
+    for (const auto &write : writes) {
+        requests.emplace_back(write.op, write.key, write.value, &waiter);
+    }
+    for (auto &request : requests) {
+        write_queue_.push(request);
+    }
+    return waiter.wait();
+}
+
 // cppcheck-suppress unusedFunction
 std::future<bool> StorageEngine::delAsync(const std::string &key) {
     return write_queue_.push(Operation::DELETE, key, "");
 }
 
+void StorageEngine::putAsync(const std::string &key, const std::string &value, WriteCallback callback) {
+    write_queue_.push(Operation::PUT, key, value, std::move(callback));
+}
+
+void StorageEngine::delAsync(const std::string &key, WriteCallback callback) {
+    write_queue_.push(Operation::DELETE, key, "", std::move(callback));
+}
+
+void StorageEngine::getAsync(const std::string &key, ReadCallback callback) const {
+    Entry cached;
+    bool found = false;
+    if (lookupRowCache(key, cached, found)) {
+        callback(found ? std::optional<Entry>(std::move(cached)) : std::nullopt);
+        return;
+    }
+    readAsync(key, std::move(callback));
+}
+
+void StorageEngine::readAsync(const std::string &key, ReadCallback callback) const {
+    auto read = [this, key, callback = std::move(callback)]() {
+        Entry entry;
+        bool found = false;
+        try {
+            found = lookupTables(key, entry);
+        } catch (const std::exception &e) {
+            std::cerr << "Async read error: " << e.what() << std::endl;
+        }
+        callback(found ? std::optional<Entry>(std::move(entry)) : std::nullopt);
+    };
+
+    if (readsInline()) {
+        read();
+        return;
+    }
+    async_pool_->submit(std::move(read));
+}
+
+bool StorageEngine::readsInline() const {
+    return options_.async_read_threads == 0 || !async_pool_;
+}
+
+StorageEngine::WriteAwaitable StorageEngine::awaitPut(const std::string &key, const std::string &value) {
+    return WriteAwaitable(*this, Operation::PUT, key, value);
+}
+
+StorageEngine::WriteAwaitable StorageEngine::awaitDel(const std::string &key) {
+    return WriteAwaitable(*this, Operation::DELETE, key, "");
+}
+
+StorageEngine::GetAwaitable StorageEngine::awaitGet(const std::string &key) const {
+    return GetAwaitable(*this, key);
+}
+
+void StorageEngine::WriteAwaitable::await_suspend(std::coroutine_handle<> handle) {
+    request_.coroutine = handle;
+    // The coroutine may already be running again, on another thread, once this returns
+    engine_.write_queue_.push(request_);
+}
+
+bool StorageEngine::GetAwaitable::await_ready() {
+    Entry cached;
+    bool found = false;
+    if (!engine_.lookupRowCache(key_, cached, found)) {
+        return false;
+    }
+    if (found) {
+        result_ = std::move(cached);
+    }
+    return true;
+}
+
+bool StorageEngine::GetAwaitable::await_suspend(std::coroutine_handle<> handle) {
+    // Resuming from inside await_suspend would nest the coroutine on this stack; carry on without suspending instead
+    if (engine_.readsInline()) {
+        engine_.readAsync(key_, [this](std::optional<Entry> result) { result_ = std::move(result); });
+        return false;
+    }
+    engine_.readAsync(key_, [this, handle](std::optional<Entry> result) {
+        result_ = std::move(result);
+        handle.resume();
+    });
+    return true;
+}
+
 bool StorageEngine::get(const std::string &key, Entry &out) const {
-    if (cache_) {
-        auto cached = cache_->get(key);
-        if (cached) {
-            out = *cached;
-            return true;
+    bool found = false;
+    if (lookupRowCache(key, out, found)) {
+        return found;
+    }
+    return lookupTables(key, out);
+}
+
+bool StorageEngine::get(const ReadOptions &options, const std::string &key, Entry &out) const {
+    if (!options.snapshot) {
+        return get(key, out);
+    }
+    // The row cache only holds the newest version of each key
+    return lookupTables(key, out, options.snapshot);
+}
+
+const Snapshot *StorageEngine::getSnapshot() {
+    auto snapshot = std::make_unique<Snapshot>();
+    std::lock_guard<std::mutex> lock(snapshot_mutex_);
+    snapshot->seq_ = published_seq_.load(std::memory_order_acquire);
+    // The immutable memtable before the version: a flush installs its SSTable before letting go of the memtable
+    if (auto immutable = std::atomic_load(&immutable_memtable_)) {
+        snapshot->memtables_.push_back(std::move(immutable));
+    }
+    snapshot->version_ = version_manager_.getCurrentVersion();
+    snapshots_.push_back(std::move(snapshot));
+    return snapshots_.back().get();
+}
+
+void StorageEngine::releaseSnapshot(const Snapshot *snapshot) {
+    std::unique_ptr<Snapshot> released;
+    std::vector<BlobHandle> discards;
+    uint64_t oldestSeq;
+    std::vector<std::shared_ptr<MemTable>> pinned;
+    {
+        std::lock_guard<std::mutex> lock(snapshot_mutex_);
+        auto it = std::find_if(snapshots_.begin(), snapshots_.end(), [snapshot](const auto &s) { return s.get() == snapshot; });
+        if (it == snapshots_.end()) {
+            return;
+        }
+        released = std::move(*it);
+        snapshots_.erase(it);
+        if (snapshots_.empty()) {
+            discards.swap(deferred_blob_discards_);
+        }
+
+        oldestSeq = oldestSnapshotSeqLocked();
+        if (auto immutable = std::atomic_load(&immutable_memtable_)) {
+            pinned.push_back(std::move(immutable));
+        }
+        for (const auto &live : snapshots_) {
+            pinned.insert(pinned.end(), live->memtables_.begin(), live->memtables_.end());
         }
     }
+    releaseBlobs(discards);
 
-    std::optional<Entry> candidate{};
+    // Snapshots taken from here on are no older than oldestSeq, so pruning outside the lock is safe
+    memtable_.pruneVersions(oldestSeq);
+    for (const auto &table : pinned) {
+        table->pruneVersions(oldestSeq);
+    }
+}
+
+uint64_t StorageEngine::oldestSnapshotSeqLocked() const {
+    return snapshots_.empty() ? published_seq_.load(std::memory_order_acquire) : snapshots_.front()->seq_;
+}
 
-    Entry mem;
-    if (memtable_.get(key, mem)) {
-        candidate = mem;
+bool StorageEngine::lookupRowCache(const std::string &key, Entry &out, bool &found) const {
+    if (!cache_) {
+        return false;
     }
+    auto cached = cache_->get(key);
+    if (!cached || cached->expired(currentTimeMillis())) {
+        return false;
+    }
+    // Deletes are cached too, so a hit may be a known miss
+    found = cached->type != EntryType::DELETE;
+    if (found) {
+        out = std::move(*cached);
+    }
+    return true;
+}
 
-    auto immutable = std::atomic_load(&immutable_memtable_);
-    if (immutable) {
-        Entry immut_mem;
-        if (immutable->get(key, immut_mem)) {
-            if (!candidate || immut_mem.seq > candidate->seq) {
-                candidate = immut_mem;
-            }
+bool StorageEngine::lookupTables(const std::string &key, Entry &out, const Snapshot *snapshot) const {
+    // Table files pinned by a snapshot hold nothing newer than it; the memtables may
+    const uint64_t maxSeq = snapshot ? snapshot->seq_ : UINT64_MAX;
+    // Every write up to here is in the tables read below; a later one dropped from the row cache bars filling it
+    const uint64_t readSeq = published_seq_.load(std::memory_order_acquire);
+
+    std::optional<Entry> candidate{};
+    // Newest range tombstone covering the key; hides every version older than it
+    uint64_t tombstoneSeq = 0;
+
+    auto readMemTable = [&](const MemTable &table) {
+        tombstoneSeq = std::max(tombstoneSeq, table.coveringTombstoneSeq(key, maxSeq));
+        Entry mem;
+        if (table.get(key, mem, maxSeq) && (!candidate || mem.seq > candidate->seq)) {
+            candidate = std::move(mem);
+        }
+    };
+
+    // The active memtable first: a flush moves its contents into a memtable the snapshot pins at the same time
+    readMemTable(memtable_);
+    if (snapshot) {
+        std::vector<std::shared_ptr<MemTable>> pinned;
+        {
+            std::lock_guard<std::mutex> lock(snapshot->mutex_);
+            pinned = snapshot->memtables_;
         }
+        for (const auto &table : pinned) {
+            readMemTable(*table);
+        }
+    } else if (auto immutable = std::atomic_load(&immutable_memtable_)) {
+        readMemTable(*immutable);
     }
 
-    auto version = version_manager_.getCurrentVersion();
+    auto version = snapshot ? snapshot->version_ : version_manager_.getCurrentVersion();
     const auto &levels = version->levels;
 
     for (uint32_t level = 0; level < levels.size(); level++) {
@@ -184,38 +563,49 @@ bool StorageEngine::get(const std::string &key, Entry &out) const {
                     if (record && (!candidate || record->seq > candidate->seq)) {
                         candidate = *record;
                     }
+                    tombstoneSeq = std::max(tombstoneSeq, sst->coveringTombstoneSeq(key));
                 }
             }
         } else {
-            // L1+: binary search to find correct file
+            // L1+: binary search to find correct file. A file ending in a range tombstone may end on the key the
+            // next file starts with, so keep going while files still start at or before the key.
             auto it = std::lower_bound(levels[level].begin(), levels[level].end(), key,
                                        [](const SSTableMeta &meta, const std::string &k) { return meta.maxKey < k; });
 
-            if (it != levels[level].end() && key >= it->minKey) {
+            for (; it != levels[level].end() && key >= it->minKey; ++it) {
                 auto sst = version->findSSTableById(it->id);
                 if (sst) {
                     std::optional<Entry> record = sst->get(key);
                     if (record && (!candidate || record->seq > candidate->seq)) {
                         candidate = *record;
                     }
-                    if (record) {
-                        break;
-                    }
+                    tombstoneSeq = std::max(tombstoneSeq, sst->coveringTombstoneSeq(key));
                 }
             }
         }
-        if (candidate)
+        // Anything further down is older than what was found here
+        if (candidate || tombstoneSeq > 0)
             break;
     }
 
-    if (!candidate || candidate->type == EntryType::DELETE) {
+    // An expired value still shadows every older version of the key
+    if (!candidate || candidate->type == EntryType::DELETE || tombstoneSeq > candidate->seq ||
+        candidate->expired(currentTimeMillis())) {
+        // Remember the miss as a tombstone no newer than what was found, so any later write replaces it
+        if (cache_ && options_.row_cache_negative_lookups && !snapshot) {
+            cache_->putIfCurrent(key, Entry{"", candidate ? std::max(candidate->seq, tombstoneSeq) : tombstoneSeq, EntryType::DELETE},
+                                 readSeq);
+        }
         return false;
     }
 
     out = *candidate;
+    if (out.type == EntryType::BLOB_INDEX) {
+        resolveBlob(out);
+    }
 
-    if (cache_) {
-        cache_->put(key, out);
+    if (cache_ && !snapshot) {
+        cache_->putIfCurrent(key, out, readSeq);
     }
 
     return true;
@@ -266,13 +656,19 @@ void StorageEngine::ls() const {
 
         std::map<std::string, Entry> currSStableData = sst->getData();
         for (const auto &[k, v] : currSStableData) {
-            std::cout << k << " " << v.value << " " << v.seq << "\n";
+            std::cout << k << " " << (v.type == EntryType::BLOB_INDEX ? "<BLOB>" : v.value) << " " << v.seq << "\n";
         }
         std::cout << '\n';
     }
 }
 
 void StorageEngine::flush() {
+    if (onCommitThread()) {
+        return;
+    }
+    // Batches already in the WAL have to reach the memtable before it is swapped along with the log
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+    waitForCommits();
     checkFlush(true);
 }
 
@@ -289,12 +685,29 @@ void StorageEngine::recover() {
             case Operation::DELETE:
                 memtable_.del(key, seqNumber);
                 break;
+            case Operation::DELETE_RANGE:
+                memtable_.deleteRange(key, value, seqNumber);
+                break;
+            case Operation::PUT_TTL:
+                if (value.size() >= sizeof(uint64_t)) {
+                    memtable_.put(key, value.substr(sizeof(uint64_t)), seqNumber, decodeFixed64(value.data()));
+                }
+                break;
+            case Operation::TRANSACTION: {
+                std::vector<MemTableWrite> writes;
+                if (decodeTransactionWrites(value, seqNumber, writes) && !writes.empty()) {
+                    maxSeqNumber = std::max(maxSeqNumber, writes.back().seq);
+                    memtable_.apply(writes);
+                }
+                break;
+            }
             default:
                 std::cerr << "Error reading operation\n";
             }
         });
         seq_number_ = maxSeqNumber + 1;
     }
+    published_seq_.store(seq_number_ - 1, std::memory_order_release);
 }
 
 void StorageEngine::handleCommand(const std::string &input) {
@@ -326,51 +739,104 @@ void StorageEngine::handleCommand(const std::string &input) {
     case Operation::DELETE:
         del(key);
         break;
+    case Operation::DELETE_RANGE:
+        deleteRange(key, value);
+        break;
     default:
         std::cerr << "Invalid command\n";
     }
 }
 
 void StorageEngine::checkFlush(bool debug) {
-    static constexpr size_t kMemTableThreshold = 8 * 1024 * 1024;
-    if (memtable_.getSize() >= kMemTableThreshold || debug) {
-        wal_.flush();
-
+    if (debug || memtable_.getSize() >= MEMTABLE_FLUSH_BYTES) {
         {
             std::unique_lock<std::mutex> lock(flush_mutex_);
-            while (std::atomic_load(&immutable_memtable_) && !shutdown_.load(std::memory_order_acquire)) {
-                flush_cv_.wait(lock);
+            if (std::atomic_load(&immutable_memtable_)) {
+                auto start = std::chrono::steady_clock::now();
+                while (std::atomic_load(&immutable_memtable_) && !shutdown_.load(std::memory_order_acquire)) {
+                    flush_cv_.wait(lock);
+                }
+                auto waited = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+                write_controller_.recordMemtableStop(static_cast<uint64_t>(waited.count()));
             }
 
             if (shutdown_.load(std::memory_order_acquire)) {
                 return;
             }
 
+            // The rotated log holds exactly what the memtable does, and is kept until its SSTable is written
+            wal_.rotate();
             auto new_immutable = std::make_shared<MemTable>();
-            auto snapshot = memtable_.snapshot();
-            for (const auto &[key, entry] : snapshot) {
-                if (entry.type == EntryType::PUT) {
-                    new_immutable->put(key, entry.value, entry.seq);
-                } else {
-                    new_immutable->del(key, entry.seq);
+            uint64_t oldestSeq;
+            {
+                // Live snapshots keep reading the memtable after it is flushed, unless it only holds later writes.
+                // They pin it before the move: a snapshot read that misses the contents in the active memtable
+                // then finds them here.
+                std::lock_guard<std::mutex> snapshotLock(snapshot_mutex_);
+                for (const auto &snapshot : snapshots_) {
+                    if (snapshot->seq_ >= memtable_start_seq_) {
+                        std::lock_guard<std::mutex> pinLock(snapshot->mutex_);
+                        snapshot->memtables_.push_back(new_immutable);
+                    }
                 }
+                memtable_.moveTo(*new_immutable);
+                immutable_start_seq_ = memtable_start_seq_;
+                memtable_start_seq_ = published_seq_.load(std::memory_order_acquire) + 1;
+                std::atomic_store(&immutable_memtable_, new_immutable);
+                oldestSeq = oldestSnapshotSeqLocked();
             }
-            memtable_.clear();
-
-            std::atomic_store(&immutable_memtable_, new_immutable);
+            new_immutable->pruneVersions(oldestSeq);
 
             flush_pending_.store(true, std::memory_order_release);
         }
 
         flush_cv_.notify_one();
-
-        std::remove((data_dir_ + "/log.bin").c_str());
     }
 }
 
 // cppcheck-suppress unusedFunction
 void StorageEngine::triggerFlush() {
-    checkFlush(true);
+    flush();
+}
+
+static uint64_t countDeletions(const std::map<std::string, Entry> &data) {
+    return static_cast<uint64_t>(
+        std::count_if(data.begin(), data.end(), [](const auto &kv) { return kv.second.type == EntryType::DELETE; }));
+}
+
+// Pieces of tombstones falling in [lower, upper)
+static std::vector<RangeTombstone> clipRangeTombstones(const std::vector<RangeTombstone> &tombstones, const std::string &lower,
+                                                       const std::optional<std::string> &upper) {
+    std::vector<RangeTombstone> clipped;
+    for (const auto &t : tombstones) {
+        RangeTombstone piece{std::max(t.start, lower), upper ? std::min(t.end, *upper) : t.end, t.seq};
+        if (piece.start < piece.end) {
+            clipped.push_back(std::move(piece));
+        }
+    }
+    return clipped;
+}
+
+static uint64_t latestExpiry(const std::map<std::string, Entry> &data) {
+    uint64_t latest = 0;
+    for (const auto &[key, entry] : data) {
+        if (entry.type == EntryType::DELETE) {
+            continue;
+        }
+        if (entry.expires_at_ms == 0) {
+            return 0;
+        }
+        latest = std::max(latest, entry.expires_at_ms);
+    }
+    return latest;
+}
+
+static uint64_t maxTombstoneSeq(const std::vector<RangeTombstone> &tombstones) {
+    uint64_t seq = 0;
+    for (const auto &t : tombstones) {
+        seq = std::max(seq, t.seq);
+    }
+    return seq;
 }
 
 void StorageEngine::flushThreadLoop() {
@@ -395,8 +861,9 @@ void StorageEngine::flushThreadLoop() {
 
         if (memtable_to_flush) {
             std::map<std::string, Entry> snapshot = memtable_to_flush->snapshot();
+            std::vector<RangeTombstone> rangeTombstones = memtable_to_flush->rangeTombstones();
 
-            if (!snapshot.empty()) {
+            if (!snapshot.empty() || !rangeTombstones.empty()) {
                 const std::string dir_path = data_dir_ + "/sstables/";
                 uint64_t new_flush_counter;
                 {
@@ -405,33 +872,44 @@ void StorageEngine::flushThreadLoop() {
                     new_flush_counter = flush_counter_;
                 }
 
-                auto newSSTable = std::make_shared<SSTable>(SSTable::flush(snapshot, dir_path, new_flush_counter));
+                std::vector<BlobHandle> obsoleteBlobs;
+                separateBlobs(snapshot, obsoleteBlobs);
+
+                auto newSSTable = writeSSTable(snapshot, new_flush_counter, 0, IOPriority::HIGH, rangeTombstones);
 
                 SSTableMeta meta;
                 meta.id = new_flush_counter;
                 meta.level = 0;
-                meta.minKey = snapshot.begin()->first;
-                meta.maxKey = snapshot.rbegin()->first;
-                meta.maxSeq = seq_number_ - 1;
+                meta.minKey = newSSTable->minKey();
+                meta.maxKey = newSSTable->maxKey();
+                // Writers keep advancing seq_number_ during the flush, so take the newest entry actually flushed
+                meta.maxSeq = maxTombstoneSeq(rangeTombstones);
+                for (const auto &[key, entry] : snapshot) {
+                    meta.maxSeq = std::max(meta.maxSeq, entry.seq);
+                }
                 meta.sizeBytes = std::filesystem::file_size(dir_path + "sstable_" + std::to_string(new_flush_counter) + ".bin");
+                meta.numEntries = snapshot.size();
+                meta.numDeletions = countDeletions(snapshot);
+                meta.expiresAt = latestExpiry(snapshot);
 
-                auto newVersion = version_manager_.getVersionForModification();
-                newVersion->addSSTable(std::move(newSSTable), meta);
-                newVersion->flush_counter = new_flush_counter;
-                version_manager_.installVersion(newVersion);
+                VersionEdit edit;
+                edit.added.emplace_back(std::move(newSSTable), meta);
+                version_manager_.applyEdit(edit);
+                flush_bytes_written_.fetch_add(meta.sizeBytes, std::memory_order_relaxed);
 
                 {
                     std::lock_guard<std::mutex> lock(metadata_mutex_);
                     saveMetadata();
                 }
 
-                if (cache_) {
-                    cache_->clear();
+                if (!rangeTombstones.empty()) {
+                    dropFilesCoveredBy(rangeTombstones, new_flush_counter);
                 }
 
                 scheduleCompaction();
             }
 
+            wal_.removeRotated();
             std::atomic_store(&immutable_memtable_, std::shared_ptr<MemTable>(nullptr));
 
             flush_cv_.notify_all();
@@ -461,15 +939,24 @@ void StorageEngine::clearData() {
         flush_counter_ = 0;
         seq_number_ = 1;
     }
+    published_seq_.store(0, std::memory_order_release);
 
     auto freshVersion = std::make_shared<TableVersion>();
-    freshVersion->levels.resize(4);
+    freshVersion->levels.resize(options_.num_levels);
     version_manager_.installVersion(freshVersion);
 
     if (cache_) {
         cache_->clear();
     }
 
+    if (block_cache_) {
+        block_cache_->clear();
+    }
+
+    if (blob_store_) {
+        blob_store_ = std::make_unique<BlobStore>(data_dir_ + "/blobs", options_.blob_file_size, options_.blob_gc_discard_ratio);
+    }
+
     try {
         std::filesystem::create_directories(data_dir_ + "/sstables");
     } catch (const std::filesystem::filesystem_error &e) {
@@ -477,8 +964,12 @@ void StorageEngine::clearData() {
 }
 
 void StorageEngine::scheduleCompaction() {
-    compaction_needed_.store(true, std::memory_order_release);
-    compaction_cv_.notify_one();
+    updateCompactionPressure();
+    {
+        std::lock_guard<std::mutex> lock(compaction_mutex_);
+        compaction_needed_.store(true, std::memory_order_release);
+    }
+    compaction_cv_.notify_all();
 }
 
 void StorageEngine::writerThreadLoop() {
@@ -491,125 +982,419 @@ void StorageEngine::writerThreadLoop() {
             break;
         }
 
-        std::vector<std::pair<WriteRequest *, bool>> results;
-        results.reserve(batch.size());
+        size_t batchBytes = 0;
+        for (const auto &request : batch) {
+            batchBytes += request->key.size() + request->value.size();
+        }
+        write_controller_.throttle(batchBytes);
+
+        std::lock_guard<std::mutex> writerLock(writer_mutex_);
+        auto commit = std::make_shared<CommitBatch>();
+        commit->results.assign(batch.size(), false);
+        commit->writes.reserve(batch.size());
 
         try {
-            for (auto &request : batch) {
-                bool success = false;
+            for (size_t i = 0; i < batch.size(); i++) {
+                const auto &request = batch[i];
 
                 switch (request->op) {
-                case Operation::PUT:
-                    if (memtable_.put(request->key, request->value, seq_number_)) {
-                        wal_.append(Operation::PUT, request->key, request->value, seq_number_);
-                        seq_number_++;
-                        success = true;
-
-                        if (cache_) {
-                            cache_->invalidate(request->key);
-                        }
+                case Operation::DELETE_RANGE:
+                    if (request->key >= request->value) {
+                        continue;
                     }
+                    [[fallthrough]];
+                case Operation::PUT:
+                case Operation::DELETE:
+                    wal_.append(request->op, request->key, request->value, seq_number_);
+                    // Only the request's result is needed from here on
+                    commit->writes.push_back(MemTableWrite{request->op, std::move(request->key), std::move(request->value), seq_number_});
                     break;
 
-                case Operation::DELETE:
-                    memtable_.del(request->key, seq_number_);
-                    wal_.append(Operation::DELETE, request->key, "", seq_number_);
-                    seq_number_++;
+                case Operation::PUT_TTL:
+                    if (request->value.size() < sizeof(uint64_t)) {
+                        continue;
+                    }
+                    wal_.append(Operation::PUT_TTL, request->key, request->value, seq_number_);
+                    commit->writes.push_back(MemTableWrite{Operation::PUT_TTL, request->key, request->value.substr(sizeof(uint64_t)),
+                                                           seq_number_, decodeFixed64(request->value.data())});
+                    break;
 
-                    if (cache_) {
-                        cache_->invalidate(request->key);
+                case Operation::TRANSACTION: {
+                    std::vector<MemTableWrite> writes;
+                    if (!request->reads || !decodeTransactionWrites(request->value, seq_number_, writes) || writes.empty() ||
+                        !transactionReadsCurrent(*request->reads, commit->writes)) {
+                        continue;
                     }
-                    success = true;
+                    // One record, so recovery replays the whole transaction or none of it
+                    wal_.append(Operation::TRANSACTION, request->key, request->value, seq_number_);
+                    seq_number_ = writes.back().seq;
+                    commit->writes.insert(commit->writes.end(), std::make_move_iterator(writes.begin()),
+                                          std::make_move_iterator(writes.end()));
                     break;
+                }
 
                 default:
-                    break;
+                    continue;
                 }
 
-                results.emplace_back(request.get(), success);
+                commit->results[i] = true;
+                commit->last_seq = seq_number_++;
             }
 
-            wal_.flush();
-
-            checkFlush();
-
+            // The fsync runs on the WAL's sync thread while this thread encodes the next batch
+            commit->wal_generation = wal_.requestSync();
         } catch (const std::exception &e) {
             std::cerr << "Writer thread error: " << e.what() << std::endl;
-            for (auto &[req, success] : results) {
-                success = false;
-            }
+            commit->results.assign(batch.size(), false);
         }
+        commit->requests = std::move(batch);
 
-        for (auto &[req, success] : results) {
-            req->completion.set_value(success);
+        const uint64_t published = published_seq_.load(std::memory_order_acquire);
+        while (!unpublished_batches_.empty() && unpublished_batches_.front()->last_seq <= published) {
+            unpublished_batches_.pop_front();
         }
+        if (commit->last_seq != 0) {
+            unpublished_batches_.push_back(commit);
+        }
+
+        {
+            std::unique_lock<std::mutex> lock(commit_mutex_);
+            commit_cv_.wait(lock, [this] { return commits_in_flight_ < MAX_COMMITS_IN_FLIGHT; });
+            commits_in_flight_++;
+            commit_queue_.push_back(std::move(commit));
+        }
+        commit_cv_.notify_all();
+
+        // The memtable can only be swapped out once every write already in the WAL has been applied to it
+        if (memtable_.getSize() >= MEMTABLE_FLUSH_BYTES) {
+            waitForCommits();
+            checkFlush(true);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(commit_mutex_);
+        commit_shutdown_ = true;
     }
+    commit_cv_.notify_all();
 }
 
-void StorageEngine::compactionThreadLoop() {
+void StorageEngine::commitThreadLoop() {
+    // Resumed here, a coroutine could not make a blocking write, and would hold up every later batch
+    const WriteQueue::Resumer resume = [this](std::coroutine_handle<> coroutine) {
+        async_pool_->submit([coroutine] { coroutine.resume(); });
+    };
+
     while (true) {
+        std::shared_ptr<CommitBatch> commit;
         {
-            std::unique_lock<std::mutex> lock(compaction_mutex_);
-            compaction_cv_.wait(lock, [this] {
-                return shutdown_.load(std::memory_order_acquire) ||
-                       (compaction_needed_.load(std::memory_order_acquire) && !compaction_paused_.load(std::memory_order_acquire));
-            });
-        }
-        if (shutdown_.load(std::memory_order_acquire)) {
-            break;
+            std::unique_lock<std::mutex> lock(commit_mutex_);
+            commit_cv_.wait(lock, [this] { return !commit_queue_.empty() || commit_shutdown_; });
+            if (commit_queue_.empty()) {
+                break;
+            }
+            commit = std::move(commit_queue_.front());
+            commit_queue_.pop_front();
         }
-        if (compaction_needed_.load(std::memory_order_acquire) && !compaction_paused_.load(std::memory_order_acquire)) {
-            compaction_needed_.store(false, std::memory_order_release);
-            compaction_in_progress_.store(true, std::memory_order_release);
-            maybeCompactBackground();
-            compaction_in_progress_.store(false, std::memory_order_release);
-            {
-                std::lock_guard<std::mutex> lock(compaction_mutex_);
+
+        wal_.waitForSync(commit->wal_generation);
+
+        std::unique_lock<std::mutex> snapshotLock(snapshot_mutex_);
+        try {
+            // Snapshots are only taken at published seqs, so the newest one decides which overwritten versions
+            // are still read
+            memtable_.apply(commit->writes, snapshots_.empty() ? 0 : snapshots_.back()->seq_);
+
+            if (cache_) {
+                for (const auto &write : commit->writes) {
+                    switch (write.op) {
+                    case Operation::PUT:
+                    case Operation::PUT_TTL:
+                        cache_->put(write.key, Entry{write.value, write.seq, EntryType::PUT, write.expires_at_ms});
+                        break;
+                    case Operation::DELETE:
+                        cache_->put(write.key, Entry{"", write.seq, EntryType::DELETE});
+                        break;
+                    case Operation::DELETE_RANGE:
+                        cache_->invalidateRange(write.key, write.value, write.seq);
+                        break;
+                    default:
+                        break;
+                    }
+                }
             }
-            compaction_cv_.notify_all();
+        } catch (const std::exception &e) {
+            std::cerr << "Commit thread error: " << e.what() << std::endl;
+            commit->results.assign(commit->requests.size(), false);
         }
-    }
-}
 
-void StorageEngine::maybeCompactBackground() {
-    for (uint32_t level = 0; level < 3; level++) {
-        auto version = version_manager_.getCurrentVersion();
-        bool needs_compaction = shouldCompactUnlocked(level, version);
+        // Batches are applied one at a time in sequence order, so everything up to last_seq is now visible
+        if (commit->last_seq != 0) {
+            published_seq_.store(commit->last_seq, std::memory_order_release);
+        }
+        snapshotLock.unlock();
 
-        if (needs_compaction) {
-            if (level == 0) {
-                compactL0toL1();
-            } else {
-                compactlevelN(level);
+        // Free the slot before completing: callbacks may queue more writes, and the writer has to keep draining
+        // the queue for those to go through
+        {
+            std::lock_guard<std::mutex> lock(commit_mutex_);
+            commits_in_flight_--;
+        }
+        commit_cv_.notify_all();
+
+        for (size_t i = 0; i < commit->requests.size(); i++) {
+            try {
+                WriteQueue::complete(std::move(commit->requests[i]), commit->results[i], resume);
+            } catch (const std::exception &e) {
+                std::cerr << "Write callback error: " << e.what() << std::endl;
             }
         }
     }
 }
 
-bool StorageEngine::shouldCompactUnlocked(uint32_t level) const {
-    auto version = version_manager_.getCurrentVersion();
-    return shouldCompactUnlocked(level, version);
+void StorageEngine::waitForCommits() {
+    std::unique_lock<std::mutex> lock(commit_mutex_);
+    commit_cv_.wait(lock, [this] { return commits_in_flight_ == 0; });
 }
 
-bool StorageEngine::shouldCompactUnlocked(uint32_t level, const std::shared_ptr<TableVersion> &version) {
-    if (!version || level >= version->levels.size() || version->levels[level].empty()) {
-        return false;
-    }
+void StorageEngine::compactionThreadLoop() {
+    std::unique_lock<std::mutex> lock(compaction_mutex_);
+    auto ready = [this] {
+        return shutdown_.load(std::memory_order_acquire) ||
+               (compaction_needed_.load(std::memory_order_acquire) && !compaction_paused_.load(std::memory_order_acquire));
+    };
+    while (true) {
+        // Expired files are dropped once their last value expires, even if nothing is written meanwhile
+        if (next_file_expiry_ms_ != 0) {
+            auto deadline = std::chrono::system_clock::time_point(std::chrono::milliseconds(next_file_expiry_ms_));
+            if (!compaction_cv_.wait_until(lock, deadline, ready)) {
+                compaction_needed_.store(true, std::memory_order_release);
+            }
+        }
+        compaction_cv_.wait(lock, ready);
+        if (shutdown_.load(std::memory_order_acquire)) {
+            break;
+        }
 
-    if (level == 0) {
-        return version->levels[0].size() >= 4;
+        // Only this thread picks compactions, so none can take up the expired files while the lock is let go
+        auto version = version_manager_.getCurrentVersion();
+        VersionEdit expired;
+        next_file_expiry_ms_ = pickExpiredFilesLocked(version, expired);
+        if (!expired.removed_ids.empty()) {
+            lock.unlock();
+            dropFiles(version, expired);
+            lock.lock();
+        }
+
+        compaction_needed_.store(false, std::memory_order_release);
+        scheduleCompactionsLocked();
+        compaction_cv_.notify_all();
     }
 
-    static const std::vector<uint64_t> klevelSizes = {0, 10 * 1024 * 1024, 100 * 1024 * 1024, 1024 * 1024 * 1024};
+    compaction_cv_.wait(lock, [this] { return running_compactions_.empty(); });
+}
 
-    if (level >= klevelSizes.size()) {
-        return false;
+void StorageEngine::scheduleCompactionsLocked() {
+    auto version = version_manager_.getCurrentVersion();
+    const size_t max_jobs = std::max<size_t>(1, options_.max_background_compactions);
+
+    if (options_.compaction_style == CompactionStyle::UNIVERSAL) {
+        if (running_compactions_.size() < max_jobs) {
+            auto job = pickUniversalCompactionLocked(version);
+            if (job) {
+                running_compactions_.push_back(job);
+                compaction_pool_->submit([this, job] { runCompactionJob(job); });
+            }
+        }
+        return;
+    }
+
+    LevelTargets targets = levelTargets(version);
+    std::vector<double> scores = compactionScores(version, targets);
+
+    // Most urgent level first
+    std::vector<uint32_t> order(scores.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&scores](uint32_t a, uint32_t b) { return scores[a] > scores[b]; });
+
+    // Data left above the base level by a shrinking tree is older than L0, so L0 must not skip past it
+    uint32_t l0Output = targets.base_level;
+    for (uint32_t level = 1; level < targets.base_level; level++) {
+        if (!version->levels[level].empty()) {
+            l0Output = level;
+            break;
+        }
+    }
+
+    for (uint32_t level : order) {
+        if (scores[level] < 1.0 || running_compactions_.size() >= max_jobs) {
+            break;
+        }
+
+        auto job = level == 0 ? pickL0CompactionLocked(version, l0Output) : pickLevelCompactionLocked(version, level);
+        if (!job) {
+            continue;
+        }
+
+        running_compactions_.push_back(job);
+        compaction_pool_->submit([this, job] { runCompactionJob(job); });
+    }
+
+    // Spare slots push delete-heavy files down even when their level is within target
+    if (running_compactions_.size() < max_jobs) {
+        auto job = pickTombstoneCompactionLocked(version);
+        if (job) {
+            running_compactions_.push_back(job);
+            compaction_pool_->submit([this, job] { runCompactionJob(job); });
+        }
+    }
+}
+
+void StorageEngine::runCompactionJob(const std::shared_ptr<CompactionJob> &job) {
+    try {
+        runCompaction(*job);
+    } catch (const std::exception &e) {
+        std::cerr << "Compaction failed: " << e.what() << std::endl;
+    }
+
+    updateCompactionPressure();
+
+    // Finishing a job releases its files and may unblock work that conflicted with it
+    {
+        std::lock_guard<std::mutex> lock(compaction_mutex_);
+        running_compactions_.erase(std::find(running_compactions_.begin(), running_compactions_.end(), job));
+        compaction_needed_.store(true, std::memory_order_release);
+    }
+    compaction_cv_.notify_all();
+}
+
+bool StorageEngine::conflictsWithRunningLocked(const CompactionJob &job) const {
+    return std::any_of(running_compactions_.begin(), running_compactions_.end(), [&job](const std::shared_ptr<CompactionJob> &other) {
+        bool sharesInput = std::any_of(job.input_ids.begin(), job.input_ids.end(), [&other](uint64_t id) {
+            return std::find(other->input_ids.begin(), other->input_ids.end(), id) != other->input_ids.end();
+        });
+        bool overlapsOutput = job.output_level == other->output_level && !(job.largest < other->smallest || job.smallest > other->largest);
+        return sharesInput || overlapsOutput;
+    });
+}
+
+static uint64_t levelBytes(const std::vector<SSTableMeta> &files) {
+    return std::accumulate(files.begin(), files.end(), uint64_t{0},
+                           [](uint64_t sum, const SSTableMeta &meta) { return sum + meta.sizeBytes; });
+}
+
+StorageEngine::LevelTargets StorageEngine::levelTargets(const std::shared_ptr<TableVersion> &version) const {
+    const uint32_t numLevels = static_cast<uint32_t>(std::max<size_t>(2, version->levels.size()));
+    const uint64_t base = std::max<uint64_t>(1, options_.max_bytes_for_level_base);
+    const double multiplier = std::max(1.0, options_.level_size_multiplier);
+
+    LevelTargets targets;
+    targets.target_bytes.assign(numLevels, 0);
+
+    if (!options_.dynamic_level_bytes) {
+        targets.base_level = 1;
+        targets.target_bytes[1] = base;
+        for (uint32_t level = 2; level < numLevels; level++) {
+            targets.target_bytes[level] = static_cast<uint64_t>(static_cast<double>(targets.target_bytes[level - 1]) * multiplier);
+        }
+        return targets;
+    }
+
+    // Work upwards from the bottom level's actual size; levels whose target would fall below the base size stay
+    // empty and L0 compacts straight into the first used level
+    uint32_t bottom = numLevels - 1;
+    targets.target_bytes[bottom] = std::max(base, levelBytes(version->levels[bottom]));
+    targets.base_level = bottom;
+    for (uint32_t level = bottom - 1; level >= 1; level--) {
+        auto target = static_cast<uint64_t>(static_cast<double>(targets.target_bytes[level + 1]) / multiplier);
+        if (target < base) {
+            break;
+        }
+        targets.target_bytes[level] = target;
+        targets.base_level = level;
+    }
+    return targets;
+}
+
+std::vector<double> StorageEngine::compactionScores(const std::shared_ptr<TableVersion> &version, const LevelTargets &targets) const {
+    // The bottom level has nowhere to go, so it never gets a score
+    std::vector<double> scores(targets.target_bytes.size() - 1, 0.0);
+
+    const auto l0Trigger = static_cast<double>(std::max<size_t>(1, options_.level0_compaction_trigger));
+    const auto baseBytes = static_cast<double>(std::max<uint64_t>(1, options_.max_bytes_for_level_base));
+    scores[0] = static_cast<double>(version->levels[0].size()) / l0Trigger;
+
+    for (uint32_t level = 1; level < scores.size(); level++) {
+        uint64_t bytes = levelBytes(version->levels[level]);
+        if (bytes == 0) {
+            continue;
+        }
+        if (level < targets.base_level) {
+            // Unused level left over from a smaller tree; drain it
+            scores[level] = 1.0 + static_cast<double>(bytes) / baseBytes;
+        } else {
+            scores[level] = static_cast<double>(bytes) / static_cast<double>(targets.target_bytes[level]);
+        }
+    }
+    return scores;
+}
+
+uint64_t StorageEngine::pendingCompactionBytes(const std::shared_ptr<TableVersion> &version) const {
+    const size_t l0Trigger = std::max<size_t>(1, options_.level0_compaction_trigger);
+
+    if (options_.compaction_style == CompactionStyle::UNIVERSAL) {
+        // Everything but the oldest run gets rewritten once the run count reaches the trigger
+        size_t runs = version->levels[0].size();
+        uint64_t bytes = levelBytes(version->levels[0]);
+        uint64_t oldest = 0;
+        for (size_t level = 1; level < version->levels.size(); level++) {
+            uint64_t levelSize = levelBytes(version->levels[level]);
+            if (levelSize > 0) {
+                runs++;
+                bytes += levelSize;
+                oldest = levelSize;
+            }
+        }
+        return runs >= std::max<size_t>(2, l0Trigger) ? bytes - oldest : 0;
+    }
+
+    // Push each level's excess down the tree; moving a byte into the next level also rewrites that level's overlap
+    LevelTargets targets = levelTargets(version);
+    uint64_t pending = 0;
+    uint64_t incoming = 0;
+    if (version->levels[0].size() >= l0Trigger) {
+        incoming = levelBytes(version->levels[0]);
+        pending += incoming;
+    }
+
+    for (uint32_t level = 1; level + 1 < version->levels.size(); level++) {
+        uint64_t bytes = levelBytes(version->levels[level]) + incoming;
+        uint64_t target = level < targets.base_level ? 0 : targets.target_bytes[level];
+        incoming = bytes > target ? bytes - target : 0;
+        if (incoming == 0) {
+            continue;
+        }
+
+        double fanout = static_cast<double>(levelBytes(version->levels[level + 1])) / static_cast<double>(bytes);
+        pending += static_cast<uint64_t>(static_cast<double>(incoming) * (fanout + 1.0));
     }
+    return pending;
+}
+
+void StorageEngine::updateCompactionPressure() {
+    auto version = version_manager_.getCurrentVersion();
+    uint64_t pending = pendingCompactionBytes(version);
+    pending_compaction_bytes_.store(pending, std::memory_order_relaxed);
+    write_controller_.update(version->levels[0].size(), pending);
 
-    uint64_t totalSize = std::accumulate(version->levels[level].begin(), version->levels[level].end(), uint64_t{0},
-                                         [](uint64_t sum, const SSTableMeta &meta) { return sum + meta.sizeBytes; });
+    if (!rate_limiter_ || !options_.rate_limit_auto_tune || shutdown_.load(std::memory_order_acquire)) {
+        return;
+    }
 
-    return totalSize > klevelSizes[level];
+    const double maxRate = static_cast<double>(options_.rate_limit_bytes_per_sec);
+    const double fullSpeedPending = static_cast<double>(std::max<uint64_t>(1, options_.rate_limit_auto_tune_pending_bytes));
+    double fraction = std::clamp(static_cast<double>(pending) / fullSpeedPending, 0.1, 1.0);
+    rate_limiter_->setBytesPerSecond(std::max<uint64_t>(1, static_cast<uint64_t>(maxRate * fraction)));
 }
 
 void StorageEngine::saveMetadata() {
@@ -622,9 +1407,14 @@ void StorageEngine::saveMetadata() {
     }
 
     metadataFile << flush_counter_ << '\n';
-    metadataFile << seq_number_ << '\n';
+    // seq_number_ belongs to the writer thread; sequence numbers past the published one are recovered from the WAL
+    metadataFile << published_seq_.load(std::memory_order_acquire) + 1 << '\n';
     metadataFile.close();
 
+    if (blob_store_) {
+        blob_store_->saveStats();
+    }
+
     std::ofstream levelFile(data_dir_ + "/levels.txt");
     if (!levelFile) {
         std::cerr << "Error could not open levels.txt" << '\n';
@@ -634,62 +1424,169 @@ void StorageEngine::saveMetadata() {
     for (uint32_t level = 0; level < version->levels.size(); level++) {
         for (const auto &meta : version->levels[level]) {
             levelFile << meta.id << ' ' << meta.level << ' ' << meta.minKey << ' ' << meta.maxKey << ' ' << meta.maxSeq << ' '
-                      << meta.sizeBytes << '\n';
+                      << meta.sizeBytes << ' ' << meta.numEntries << ' ' << meta.numDeletions << ' ' << meta.expiresAt << '\n';
         }
     }
     levelFile.close();
 }
 
-void StorageEngine::compactL0toL1() {
-    auto oldVersion = version_manager_.getCurrentVersion();
+std::shared_ptr<SSTable> StorageEngine::writeSSTable(const std::map<std::string, Entry> &data, uint64_t id, uint32_t level,
+                                                     IOPriority priority, const std::vector<RangeTombstone> &range_tombstones) {
+    CompressionType compression = options_.compressionForLevel(level);
 
-    if (oldVersion->levels.empty() || oldVersion->levels[0].empty())
-        return;
+    std::string dictionary;
+    if (compression != CompressionType::NONE && isBottommostLevel(level)) {
+        dictionary = buildDictionary(data);
+    }
 
-    const std::string dir_path = data_dir_ + "/sstables/";
+    SSTable written =
+        SSTable::flush(data, data_dir_ + "/sstables/", id, compression, dictionary, rate_limiter_.get(), priority, range_tombstones);
+    auto table = std::make_shared<SSTable>(std::move(written));
+    table->setBlockCache(block_cache_);
+    return table;
+}
 
-    std::string minKey = oldVersion->levels[0][0].minKey;
-    std::string maxKey = oldVersion->levels[0][0].maxKey;
-    for (const auto &meta : oldVersion->levels[0]) {
-        if (meta.minKey < minKey)
-            minKey = meta.minKey;
-        if (meta.maxKey > maxKey)
-            maxKey = meta.maxKey;
+// Every blob value a file points at; dropping the file without compacting it leaves them all garbage
+static void collectBlobHandles(const SSTable &sst, std::vector<BlobHandle> &out) {
+    for (SSTable::Iterator it(sst); it.valid(); it.next()) {
+        BlobHandle handle;
+        if (it.entry().type == EntryType::BLOB_INDEX && BlobHandle::decode(it.entry().value, handle)) {
+            out.push_back(handle);
+        }
     }
+}
 
-    std::vector<std::shared_ptr<SSTable>> l0SSTables;
-    std::vector<uint64_t> l0Ids;
-    for (const auto &meta : oldVersion->levels[0]) {
-        auto sst = oldVersion->findSSTableById(meta.id);
-        if (sst) {
-            l0SSTables.push_back(sst);
-            l0Ids.push_back(meta.id);
+void StorageEngine::dropFilesCoveredBy(const std::vector<RangeTombstone> &range_tombstones, uint64_t keep_id) {
+    auto version = version_manager_.getCurrentVersion();
+    VersionEdit edit;
+    for (const auto &level : version->levels) {
+        for (const auto &meta : level) {
+            bool covered = std::any_of(range_tombstones.begin(), range_tombstones.end(), [&meta](const RangeTombstone &t) {
+                return t.seq > meta.maxSeq && meta.minKey >= t.start && meta.maxKey < t.end;
+            });
+            if (covered && meta.id != keep_id) {
+                edit.removed_ids.push_back(meta.id);
+            }
         }
     }
 
-    std::vector<std::shared_ptr<SSTable>> l1SSTables;
-    std::vector<uint64_t> l1Ids;
-    if (oldVersion->levels.size() > 1) {
-        for (const auto &meta : oldVersion->levels[1]) {
-            if (!(meta.maxKey < minKey || meta.minKey > maxKey)) {
-                auto sst = oldVersion->findSSTableById(meta.id);
-                if (sst) {
-                    l1SSTables.push_back(sst);
-                    l1Ids.push_back(meta.id);
-                }
+    dropFiles(version, edit);
+}
+
+void StorageEngine::dropFiles(const std::shared_ptr<TableVersion> &version, const VersionEdit &edit) {
+    // A compaction reading these files fails to install its own edit and discards its outputs
+    if (edit.removed_ids.empty() || !version_manager_.applyEdit(edit)) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(metadata_mutex_);
+        saveMetadata();
+    }
+
+    std::vector<BlobHandle> droppedBlobs;
+    for (uint64_t id : edit.removed_ids) {
+        if (auto sst = version->findSSTableById(id)) {
+            if (blob_store_) {
+                collectBlobHandles(*sst, droppedBlobs);
             }
+            sst->markObsolete();
         }
     }
+    releaseBlobs(droppedBlobs);
+}
+
+uint64_t StorageEngine::pickExpiredFilesLocked(const std::shared_ptr<TableVersion> &version, VersionEdit &edit) const {
+    const uint64_t now = currentTimeMillis();
+    uint64_t next_expiry = 0;
+    for (uint32_t level = 0; level < version->levels.size(); level++) {
+        for (const auto &meta : version->levels[level]) {
+            if (meta.expiresAt == 0) {
+                continue;
+            }
+            if (meta.expiresAt > now) {
+                next_expiry = next_expiry == 0 ? meta.expiresAt : std::min(next_expiry, meta.expiresAt);
+                continue;
+            }
 
-    std::vector<std::shared_ptr<SSTable>> allSSTables;
-    allSSTables.insert(allSSTables.end(), l0SSTables.begin(), l0SSTables.end());
-    allSSTables.insert(allSSTables.end(), l1SSTables.begin(), l1SSTables.end());
+            // Dropping the file must not uncover an older version of any of its keys
+            bool shadowsOlder = false;
+            for (uint32_t below = level; below < version->levels.size() && !shadowsOlder; below++) {
+                shadowsOlder = std::any_of(version->levels[below].begin(), version->levels[below].end(), [&meta](const SSTableMeta &other) {
+                    return other.id != meta.id && !(other.maxKey < meta.minKey || other.minKey > meta.maxKey);
+                });
+            }
+            bool inUse = std::any_of(running_compactions_.begin(), running_compactions_.end(), [&meta](const auto &job) {
+                return std::find(job->input_ids.begin(), job->input_ids.end(), meta.id) != job->input_ids.end();
+            });
+            if (!shadowsOlder && !inUse) {
+                edit.removed_ids.push_back(meta.id);
+            }
+        }
+    }
+    return next_expiry;
+}
+
+std::string StorageEngine::buildDictionary(const std::map<std::string, Entry> &data) const {
+    if (options_.bottommost_dictionary_bytes == 0) {
+        return "";
+    }
+
+    // Sample roughly 64x the dictionary size, spread evenly across the key range
+    const size_t sample_budget = options_.bottommost_dictionary_bytes * 64;
+    size_t total_bytes = std::accumulate(data.begin(), data.end(), size_t{0},
+                                         [](size_t sum, const auto &kv) { return sum + kv.second.value.size(); });
+    size_t stride = std::max<size_t>(1, total_bytes / sample_budget);
+
+    std::vector<std::string> samples;
+    size_t i = 0;
+    for (const auto &[key, entry] : data) {
+        if (entry.type != EntryType::PUT || entry.value.empty()) {
+            continue;
+        }
+        if (i++ % stride == 0) {
+            samples.push_back(entry.value);
+        }
+    }
+
+    return trainDictionary(samples, options_.bottommost_dictionary_bytes);
+}
+
+bool StorageEngine::isBottommostLevel(uint32_t level) const {
+    auto version = version_manager_.getCurrentVersion();
+    return level > 0 && level + 1 >= version->levels.size();
+}
+
+std::map<std::string, Entry> StorageEngine::mergeSSTables(const std::vector<std::shared_ptr<SSTable>> &tables, const std::string &lower,
+                                                          const std::optional<std::string> &upper, bool drop_tombstones,
+                                                          std::vector<BlobHandle> &obsolete_blobs,
+                                                          std::vector<RangeTombstone> &range_tombstones) const {
+    std::vector<RangeTombstone> tombstones;
+    for (const auto &sst : tables) {
+        std::vector<RangeTombstone> clipped = clipRangeTombstones(sst->rangeTombstones(), lower, upper);
+        tombstones.insert(tombstones.end(), clipped.begin(), clipped.end());
+    }
+    auto coveringSeq = [&tombstones](const std::string &key) {
+        uint64_t seq = 0;
+        for (const auto &t : tombstones) {
+            if (t.covers(key)) {
+                seq = std::max(seq, t.seq);
+            }
+        }
+        return seq;
+    };
 
     std::vector<SSTable::Iterator> iters;
-    iters.reserve(allSSTables.size());
-    std::transform(allSSTables.begin(), allSSTables.end(), std::back_inserter(iters),
+    iters.reserve(tables.size());
+    std::transform(tables.begin(), tables.end(), std::back_inserter(iters),
                    [](const std::shared_ptr<SSTable> &sst) { return SSTable::Iterator{*sst}; });
 
+    if (!lower.empty()) {
+        for (auto &it : iters) {
+            it.seek(lower);
+        }
+    }
+
     using HeapElement = std::tuple<std::string, uint64_t, EntryType, size_t>;
     auto cmp = [](const HeapElement &a, const HeapElement &b) {
         if (std::get<0>(a) != std::get<0>(b)) {
@@ -707,15 +1604,29 @@ void StorageEngine::compactL0toL1() {
         }
     }
 
+    // Blob values referenced only by shadowed versions become garbage in their blob file
+    auto dropVersion = [&obsolete_blobs](EntryType type, const std::string &value) {
+        BlobHandle handle;
+        if (type == EntryType::BLOB_INDEX && BlobHandle::decode(value, handle)) {
+            obsolete_blobs.push_back(handle);
+        }
+    };
+
     std::map<std::string, Entry> merged_data;
+    const uint64_t now = currentTimeMillis();
 
     while (!pq.empty()) {
+        if (upper && std::get<0>(pq.top()) >= *upper) {
+            break;
+        }
+
         auto [key, seq, type, idx] = pq.top();
         pq.pop();
 
         uint64_t highestSeq = seq;
         EntryType highestType = type;
         std::string highestValue = iters[idx].entry().value;
+        uint64_t highestExpiry = iters[idx].entry().expires_at_ms;
 
         std::vector<size_t> sameKeyIndices = {idx};
 
@@ -725,14 +1636,26 @@ void StorageEngine::compactL0toL1() {
             sameKeyIndices.push_back(i);
 
             if (s > highestSeq) {
+                dropVersion(highestType, highestValue);
                 highestSeq = s;
                 highestType = t;
                 highestValue = iters[i].entry().value;
+                highestExpiry = iters[i].entry().expires_at_ms;
+            } else {
+                dropVersion(t, iters[i].entry().value);
             }
         }
 
-        if (highestType == EntryType::PUT) {
-            merged_data[key] = Entry{highestValue, highestSeq, highestType};
+        if (highestSeq < coveringSeq(key)) {
+            dropVersion(highestType, highestValue);
+        } else if (highestType != EntryType::DELETE && highestExpiry != 0 && highestExpiry <= now) {
+            // An expired value is dropped outright, or reduced to a tombstone while it still hides older versions
+            dropVersion(highestType, highestValue);
+            if (!drop_tombstones) {
+                merged_data[key] = Entry{"", highestSeq, EntryType::DELETE};
+            }
+        } else if (highestType != EntryType::DELETE || !drop_tombstones) {
+            merged_data[key] = Entry{highestValue, highestSeq, highestType, highestExpiry};
         }
 
         for (size_t i : sameKeyIndices) {
@@ -744,204 +1667,531 @@ void StorageEngine::compactL0toL1() {
         }
     }
 
-    if (merged_data.empty())
-        return;
-
-    uint64_t new_flush_counter;
-    {
-        std::lock_guard<std::mutex> lock(metadata_mutex_);
-        flush_counter_++;
-        new_flush_counter = flush_counter_;
+    if (!drop_tombstones) {
+        range_tombstones = std::move(tombstones);
     }
+    return merged_data;
+}
 
-    auto newSSTable = std::make_shared<SSTable>(SSTable::flush(merged_data, dir_path, new_flush_counter));
-
-    SSTableMeta newMeta;
-    newMeta.id = new_flush_counter;
-    newMeta.level = 1;
-    newMeta.minKey = merged_data.begin()->first;
-    newMeta.maxKey = merged_data.rbegin()->first;
-    newMeta.maxSeq = seq_number_ - 1;
-    newMeta.sizeBytes = std::filesystem::file_size(dir_path + "sstable_" + std::to_string(new_flush_counter) + ".bin");
+void StorageEngine::separateBlobs(std::map<std::string, Entry> &data, std::vector<BlobHandle> &obsolete_blobs,
+                                  std::vector<BlobHandle> *added_blobs) {
+    if (!blob_store_) {
+        return;
+    }
 
-    auto newVersion = version_manager_.getVersionForModification();
+    bool wrote = false;
+    auto add = [&](const std::string &key, const std::string &value) {
+        BlobHandle handle = blob_store_->add(key, value);
+        if (added_blobs) {
+            added_blobs->push_back(handle);
+        }
+        wrote = true;
+        return handle.encode();
+    };
+    for (auto &[key, entry] : data) {
+        if (entry.type == EntryType::PUT && options_.blob_value_threshold > 0 && entry.value.size() >= options_.blob_value_threshold) {
+            entry.value = add(key, entry.value);
+            entry.type = EntryType::BLOB_INDEX;
+        } else if (entry.type == EntryType::BLOB_INDEX) {
+            // Relocate live values out of mostly-garbage files so those files can be deleted
+            BlobHandle handle;
+            if (BlobHandle::decode(entry.value, handle) && blob_store_->shouldRelocate(handle.file_number)) {
+                entry.value = add(key, blob_store_->read(handle));
+                obsolete_blobs.push_back(handle);
+            }
+        }
+    }
 
-    std::vector<uint64_t> idsToRemove;
-    idsToRemove.insert(idsToRemove.end(), l0Ids.begin(), l0Ids.end());
-    idsToRemove.insert(idsToRemove.end(), l1Ids.begin(), l1Ids.end());
-    newVersion->removeSSTablesByIds(idsToRemove);
+    // Blob records must be durable before any SSTable references them
+    if (wrote) {
+        blob_store_->sync();
+    }
+}
 
-    newVersion->addSSTable(std::move(newSSTable), newMeta);
-    newVersion->flush_counter = new_flush_counter;
+void StorageEngine::releaseBlobs(const std::vector<BlobHandle> &obsolete_blobs) {
+    if (!blob_store_ || obsolete_blobs.empty()) {
+        return;
+    }
+    {
+        // Files pinned by a snapshot may still point at these values
+        std::lock_guard<std::mutex> lock(snapshot_mutex_);
+        if (!snapshots_.empty()) {
+            deferred_blob_discards_.insert(deferred_blob_discards_.end(), obsolete_blobs.begin(), obsolete_blobs.end());
+            return;
+        }
+    }
+    for (const auto &handle : obsolete_blobs) {
+        blob_store_->discard(handle);
+    }
+}
 
-    if (newVersion->levels.size() > 1) {
-        std::sort(newVersion->levels[1].begin(), newVersion->levels[1].end(),
-                  [](const SSTableMeta &a, const SSTableMeta &b) { return a.minKey < b.minKey; });
+void StorageEngine::resolveBlob(Entry &entry) const {
+    BlobHandle handle;
+    if (!blob_store_ || !BlobHandle::decode(entry.value, handle)) {
+        throw std::runtime_error("Unreadable blob reference");
     }
+    entry.value = blob_store_->read(handle);
+    entry.type = EntryType::PUT;
+}
 
-    version_manager_.installVersion(newVersion);
+std::shared_ptr<StorageEngine::CompactionJob> StorageEngine::pickL0CompactionLocked(const std::shared_ptr<TableVersion> &version,
+                                                                                    uint32_t output_level) const {
+    if (version->levels.empty() || version->levels[0].empty())
+        return nullptr;
 
-    {
-        std::lock_guard<std::mutex> lock(metadata_mutex_);
-        saveMetadata();
+    // L0 files overlap, so only one job may move them down at a time
+    if (std::any_of(running_compactions_.begin(), running_compactions_.end(),
+                    [](const std::shared_ptr<CompactionJob> &job) { return job->start_level == 0; })) {
+        return nullptr;
     }
 
-    for (uint64_t id : idsToRemove) {
-        std::filesystem::remove(data_dir_ + "/sstables/sstable_" + std::to_string(id) + ".bin");
+    auto job = std::make_shared<CompactionJob>();
+    job->start_level = 0;
+    job->output_level = output_level;
+    job->smallest = version->levels[0][0].minKey;
+    job->largest = version->levels[0][0].maxKey;
+    for (const auto &meta : version->levels[0]) {
+        auto sst = version->findSSTableById(meta.id);
+        if (sst) {
+            job->inputs.push_back(sst);
+            job->input_ids.push_back(meta.id);
+            job->input_bytes += meta.sizeBytes;
+            job->smallest = std::min(job->smallest, meta.minKey);
+            job->largest = std::max(job->largest, meta.maxKey);
+        }
     }
 
-    if (cache_) {
-        cache_->clear();
+    addOverlappingInputs(version, *job);
+    job->drop_tombstones = !overlapsBelowOutput(version, *job);
+
+    if (job->inputs.empty() || conflictsWithRunningLocked(*job)) {
+        return nullptr;
     }
+    return job;
 }
 
-void StorageEngine::compactlevelN(uint32_t level) {
-    auto oldVersion = version_manager_.getCurrentVersion();
+std::shared_ptr<StorageEngine::CompactionJob> StorageEngine::pickLevelCompactionLocked(const std::shared_ptr<TableVersion> &version,
+                                                                                       uint32_t level) {
+    if (level == 0 || level >= version->levels.size() || version->levels[level].empty())
+        return nullptr;
 
-    if (level == 0 || level >= oldVersion->levels.size())
-        return;
-
-    if (oldVersion->levels[level].empty())
-        return;
+    const auto &files = version->levels[level];
+    std::vector<size_t> order(files.size());
+    std::iota(order.begin(), order.end(), 0);
 
-    const std::string dir_path = data_dir_ + "/sstables/";
+    switch (options_.compaction_pri) {
+    case CompactionPri::ROUND_ROBIN: {
+        // Resume after the last key range compacted from this level, wrapping around at the end
+        if (compact_cursors_.size() < version->levels.size()) {
+            compact_cursors_.resize(version->levels.size());
+        }
+        const std::string &cursor = compact_cursors_[level];
+        auto start = std::find_if(files.begin(), files.end(), [&cursor](const SSTableMeta &meta) { return meta.minKey > cursor; });
+        std::rotate(order.begin(), order.begin() + (start - files.begin()), order.end());
+        break;
+    }
+    case CompactionPri::MIN_OVERLAP: {
+        // Bytes rewritten in the next level per byte moved down
+        std::vector<double> ratio(files.size(), 0.0);
+        if (level + 1 < version->levels.size()) {
+            for (size_t i = 0; i < files.size(); i++) {
+                uint64_t overlap = 0;
+                for (const auto &next : version->levels[level + 1]) {
+                    if (!(next.maxKey < files[i].minKey || next.minKey > files[i].maxKey)) {
+                        overlap += next.sizeBytes;
+                    }
+                }
+                ratio[i] = static_cast<double>(overlap) / static_cast<double>(std::max<uint64_t>(1, files[i].sizeBytes));
+            }
+        }
+        std::stable_sort(order.begin(), order.end(), [&ratio](size_t a, size_t b) { return ratio[a] < ratio[b]; });
+        break;
+    }
+    case CompactionPri::OLDEST_SEQ_FIRST:
+        std::stable_sort(order.begin(), order.end(), [&files](size_t a, size_t b) { return files[a].maxSeq < files[b].maxSeq; });
+        break;
+    }
 
-    const SSTableMeta &srcMeta = oldVersion->levels[level][0];
-    auto srcSSTable = oldVersion->findSSTableById(srcMeta.id);
+    // Take the preferred file whose job does not touch files another job is compacting
+    for (size_t i : order) {
+        const SSTableMeta &srcMeta = files[i];
+        auto job = levelJobForFile(version, level, srcMeta);
+        if (!job) {
+            std::cerr << "Error: Could not find SSTable for level " << level << "\n";
+            continue;
+        }
 
-    if (!srcSSTable) {
-        std::cerr << "Error: Could not find SSTable for level " << level << "\n";
-        return;
+        if (!conflictsWithRunningLocked(*job)) {
+            if (options_.compaction_pri == CompactionPri::ROUND_ROBIN) {
+                compact_cursors_[level] = srcMeta.maxKey;
+            }
+            return job;
+        }
     }
 
-    std::vector<std::shared_ptr<SSTable>> nextLevelSSTables;
-    std::vector<uint64_t> nextLevelIds;
+    return nullptr;
+}
 
-    if (level + 1 < oldVersion->levels.size()) {
-        for (const auto &meta : oldVersion->levels[level + 1]) {
-            if (!(meta.maxKey < srcMeta.minKey || meta.minKey > srcMeta.maxKey)) {
-                auto sst = oldVersion->findSSTableById(meta.id);
-                if (sst) {
-                    nextLevelSSTables.push_back(sst);
-                    nextLevelIds.push_back(meta.id);
-                }
+std::shared_ptr<StorageEngine::CompactionJob>
+StorageEngine::pickTombstoneCompactionLocked(const std::shared_ptr<TableVersion> &version) const {
+    if (options_.tombstone_compaction_ratio <= 0.0) {
+        return nullptr;
+    }
+
+    // Densest first. The bottom level never holds tombstones, and L0 is compacted by file count.
+    std::vector<std::pair<double, const SSTableMeta *>> candidates;
+    for (uint32_t level = 1; level + 1 < version->levels.size(); level++) {
+        for (const auto &meta : version->levels[level]) {
+            if (meta.numEntries == 0 || meta.numEntries < options_.tombstone_compaction_min_entries) {
+                continue;
+            }
+            double density = static_cast<double>(meta.numDeletions) / static_cast<double>(meta.numEntries);
+            if (density >= options_.tombstone_compaction_ratio) {
+                candidates.emplace_back(density, &meta);
             }
         }
     }
+    std::stable_sort(candidates.begin(), candidates.end(), [](const auto &a, const auto &b) { return a.first > b.first; });
 
-    std::vector<std::shared_ptr<SSTable>> allSSTables;
-    allSSTables.push_back(srcSSTable);
-    allSSTables.insert(allSSTables.end(), nextLevelSSTables.begin(), nextLevelSSTables.end());
+    for (const auto &[density, meta] : candidates) {
+        auto job = levelJobForFile(version, meta->level, *meta);
+        if (job && !conflictsWithRunningLocked(*job)) {
+            return job;
+        }
+    }
+    return nullptr;
+}
 
-    std::vector<SSTable::Iterator> iters;
-    iters.reserve(allSSTables.size());
-    std::transform(allSSTables.begin(), allSSTables.end(), std::back_inserter(iters),
-                   [](const std::shared_ptr<SSTable> &sst) { return SSTable::Iterator{*sst}; });
+std::shared_ptr<StorageEngine::CompactionJob> StorageEngine::levelJobForFile(const std::shared_ptr<TableVersion> &version,
+                                                                            uint32_t level, const SSTableMeta &meta) {
+    auto sst = version->findSSTableById(meta.id);
+    if (!sst) {
+        return nullptr;
+    }
 
-    using HeapElement = std::tuple<std::string, uint64_t, EntryType, size_t>;
-    auto cmp = [](const HeapElement &a, const HeapElement &b) {
-        if (std::get<0>(a) != std::get<0>(b)) {
-            return std::get<0>(a) > std::get<0>(b);
-        }
-        return std::get<1>(a) < std::get<1>(b);
-    };
+    auto job = std::make_shared<CompactionJob>();
+    job->start_level = level;
+    job->output_level = level + 1;
+    job->smallest = meta.minKey;
+    job->largest = meta.maxKey;
+    job->inputs.push_back(sst);
+    job->input_ids.push_back(meta.id);
+    job->input_bytes = meta.sizeBytes;
+
+    addOverlappingInputs(version, *job);
+    job->drop_tombstones = !overlapsBelowOutput(version, *job);
+    return job;
+}
 
-    std::priority_queue<HeapElement, std::vector<HeapElement>, decltype(cmp)> pq(cmp);
+std::shared_ptr<StorageEngine::CompactionJob>
+StorageEngine::pickUniversalCompactionLocked(const std::shared_ptr<TableVersion> &version) const {
+    // Sorted runs from newest to oldest: every L0 file on its own, then each non-empty level as a whole
+    struct SortedRun {
+        uint32_t level;
+        std::vector<const SSTableMeta *> files;
+        uint64_t bytes = 0;
+    };
+    std::vector<SortedRun> runs;
 
-    for (size_t i = 0; i < iters.size(); i++) {
-        if (iters[i].valid()) {
-            const auto &e = iters[i].entry();
-            pq.emplace(e.key, e.seq, e.type, i);
+    std::vector<const SSTableMeta *> l0;
+    for (const auto &meta : version->levels[0]) {
+        l0.push_back(&meta);
+    }
+    std::sort(l0.begin(), l0.end(), [](const SSTableMeta *a, const SSTableMeta *b) { return a->maxSeq > b->maxSeq; });
+    for (const SSTableMeta *meta : l0) {
+        runs.push_back(SortedRun{0, {meta}, meta->sizeBytes});
+    }
+    for (uint32_t level = 1; level < version->levels.size(); level++) {
+        if (version->levels[level].empty()) {
+            continue;
+        }
+        SortedRun run{level, {}, 0};
+        for (const auto &meta : version->levels[level]) {
+            run.files.push_back(&meta);
+            run.bytes += meta.sizeBytes;
         }
+        runs.push_back(std::move(run));
     }
 
-    std::map<std::string, Entry> merged_data;
+    const size_t trigger = std::max<size_t>(2, options_.level0_compaction_trigger);
+    if (runs.size() < trigger) {
+        return nullptr;
+    }
 
-    while (!pq.empty()) {
-        auto [key, seq, type, idx] = pq.top();
-        pq.pop();
+    // Merging always takes the newest `count` runs, so the output never jumps ahead of an older run
+    size_t count = 0;
 
-        uint64_t highestSeq = seq;
-        EntryType highestType = type;
-        std::string highestValue = iters[idx].entry().value;
+    // Space amplification: everything newer than the oldest run is potential garbage
+    uint64_t newer_bytes = 0;
+    for (size_t i = 0; i + 1 < runs.size(); i++) {
+        newer_bytes += runs[i].bytes;
+    }
+    if (newer_bytes * 100 >= options_.universal_max_size_amplification_percent * runs.back().bytes) {
+        count = runs.size();
+    }
 
-        std::vector<size_t> sameKeyIndices = {idx};
+    // Size ratio: grow the set while the next older run is not much bigger than everything picked so far
+    if (count == 0) {
+        uint64_t picked_bytes = runs[0].bytes;
+        size_t n = 1;
+        while (n < runs.size() && runs[n].bytes * 100 <= picked_bytes * (100 + options_.universal_size_ratio)) {
+            picked_bytes += runs[n].bytes;
+            n++;
+        }
+        if (n >= std::max<size_t>(2, options_.universal_min_merge_width)) {
+            count = n;
+        }
+    }
 
-        while (!pq.empty() && std::get<0>(pq.top()) == key) {
-            auto [_, s, t, i] = pq.top();
-            pq.pop();
-            sameKeyIndices.push_back(i);
+    // Still too many runs: merge just enough of the newest to get back under the trigger
+    if (count == 0) {
+        count = std::min(runs.size(), std::max<size_t>(2, runs.size() - trigger + 1));
+    }
 
-            if (s > highestSeq) {
-                highestSeq = s;
-                highestType = t;
-                highestValue = iters[i].entry().value;
+    auto job = std::make_shared<CompactionJob>();
+    job->start_level = runs[0].level;
+    if (count == runs.size()) {
+        job->output_level = static_cast<uint32_t>(version->levels.size() - 1);
+        job->drop_tombstones = true;
+    } else {
+        // Land just above the next older run; tombstones must survive to shadow it
+        job->output_level = runs[count].level == 0 ? 0 : runs[count].level - 1;
+        job->drop_tombstones = false;
+    }
+
+    job->smallest = runs[0].files.front()->minKey;
+    job->largest = runs[0].files.front()->maxKey;
+    for (size_t i = 0; i < count; i++) {
+        for (const SSTableMeta *meta : runs[i].files) {
+            auto sst = version->findSSTableById(meta->id);
+            if (!sst) {
+                continue;
             }
+            job->inputs.push_back(sst);
+            job->input_ids.push_back(meta->id);
+            job->input_bytes += meta->sizeBytes;
+            job->smallest = std::min(job->smallest, meta->minKey);
+            job->largest = std::max(job->largest, meta->maxKey);
         }
+    }
+
+    if (job->inputs.empty() || conflictsWithRunningLocked(*job)) {
+        return nullptr;
+    }
+    return job;
+}
 
-        if (highestType == EntryType::PUT) {
-            merged_data[key] = Entry{highestValue, highestSeq, highestType};
+void StorageEngine::addOverlappingInputs(const std::shared_ptr<TableVersion> &version, CompactionJob &job) {
+    if (job.output_level >= version->levels.size()) {
+        return;
+    }
+
+    std::string smallest = job.smallest;
+    std::string largest = job.largest;
+    for (const auto &meta : version->levels[job.output_level]) {
+        if (!(meta.maxKey < smallest || meta.minKey > largest)) {
+            auto sst = version->findSSTableById(meta.id);
+            if (sst) {
+                job.inputs.push_back(sst);
+                job.input_ids.push_back(meta.id);
+                job.input_bytes += meta.sizeBytes;
+                job.smallest = std::min(job.smallest, meta.minKey);
+                job.largest = std::max(job.largest, meta.maxKey);
+            }
         }
+    }
+}
 
-        for (size_t i : sameKeyIndices) {
-            iters[i].next();
-            if (iters[i].valid()) {
-                const auto &e = iters[i].entry();
-                pq.emplace(e.key, e.seq, e.type, i);
+bool StorageEngine::overlapsBelowOutput(const std::shared_ptr<TableVersion> &version, const CompactionJob &job) {
+    // A tombstone may only be dropped once nothing older it could be shadowing is left beneath it
+    for (size_t level = job.output_level + 1; level < version->levels.size(); level++) {
+        for (const auto &meta : version->levels[level]) {
+            if (!(meta.maxKey < job.smallest || meta.minKey > job.largest)) {
+                return true;
             }
         }
     }
+    return false;
+}
 
-    if (merged_data.empty())
-        return;
+std::vector<std::string> StorageEngine::subcompactionBoundaries(const std::vector<std::shared_ptr<SSTable>> &inputs) const {
+    if (options_.max_subcompactions <= 1) {
+        return {};
+    }
 
-    uint64_t new_flush_counter;
-    {
-        std::lock_guard<std::mutex> lock(metadata_mutex_);
-        flush_counter_++;
-        new_flush_counter = flush_counter_;
+    std::vector<std::string> keys;
+    for (const auto &sst : inputs) {
+        auto indexKeys = sst->indexKeys();
+        keys.insert(keys.end(), std::make_move_iterator(indexKeys.begin()), std::make_move_iterator(indexKeys.end()));
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+    // Every index key starts one data block, so evenly spaced keys give shards of similar byte size
+    size_t shards = std::min(options_.max_subcompactions, keys.size() / MIN_SUBCOMPACTION_BLOCKS);
+    std::vector<std::string> boundaries;
+    for (size_t i = 1; i < shards; i++) {
+        boundaries.push_back(keys[i * keys.size() / shards]);
+    }
+    return boundaries;
+}
+
+void StorageEngine::runSubcompaction(const CompactionJob &job, const std::string &lower, const std::optional<std::string> &upper,
+                                     SubcompactionResult &result) {
+    const uint32_t output_level = job.output_level;
+    std::vector<RangeTombstone> range_tombstones;
+    std::map<std::string, Entry> merged_data =
+        mergeSSTables(job.inputs, lower, upper, job.drop_tombstones, result.obsolete_blobs, range_tombstones);
+    separateBlobs(merged_data, result.obsolete_blobs, &result.added_blobs);
+
+    // Cut the output into files of about target_file_size so later compactions can pick small key ranges.
+    // Every L0 file is a sorted run of its own, so L0 output stays in one file.
+    const size_t target_size = output_level == 0 ? 0 : options_.target_file_size;
+    std::string chunk_lower = lower;
+    bool tombstones_only = merged_data.empty() && !range_tombstones.empty();
+    while (!merged_data.empty() || tombstones_only) {
+        tombstones_only = false;
+        std::map<std::string, Entry> chunk;
+        size_t chunk_bytes = 0;
+        uint64_t max_seq = 0;
+        while (!merged_data.empty() && (chunk.empty() || target_size == 0 || chunk_bytes < target_size)) {
+            auto node = merged_data.extract(merged_data.begin());
+            chunk_bytes += node.key().size() + node.mapped().value.size();
+            max_seq = std::max(max_seq, node.mapped().seq);
+            chunk.insert(std::move(node));
+        }
+
+        // Each file keeps the tombstone pieces up to where the next file starts
+        std::optional<std::string> chunk_upper = merged_data.empty() ? upper : std::optional<std::string>(merged_data.begin()->first);
+        std::vector<RangeTombstone> pieces = clipRangeTombstones(range_tombstones, chunk_lower, chunk_upper);
+        max_seq = std::max(max_seq, maxTombstoneSeq(pieces));
+        if (chunk_upper) {
+            chunk_lower = *chunk_upper;
+        }
+
+        uint64_t new_flush_counter;
+        {
+            std::lock_guard<std::mutex> lock(metadata_mutex_);
+            flush_counter_++;
+            new_flush_counter = flush_counter_;
+        }
+
+        auto newSSTable = writeSSTable(chunk, new_flush_counter, output_level, IOPriority::LOW, pieces);
+
+        SSTableMeta newMeta;
+        newMeta.id = new_flush_counter;
+        newMeta.level = output_level;
+        newMeta.minKey = newSSTable->minKey();
+        newMeta.maxKey = newSSTable->maxKey();
+        newMeta.maxSeq = max_seq;
+        newMeta.sizeBytes = std::filesystem::file_size(newSSTable->filename());
+        newMeta.numEntries = chunk.size();
+        newMeta.numDeletions = countDeletions(chunk);
+        newMeta.expiresAt = latestExpiry(chunk);
+
+        result.outputs.emplace_back(std::move(newSSTable), newMeta);
     }
+}
 
-    auto newSSTable = std::make_shared<SSTable>(SSTable::flush(merged_data, dir_path, new_flush_counter));
+void StorageEngine::runCompaction(const CompactionJob &job) {
+    const uint32_t output_level = job.output_level;
 
-    SSTableMeta newMeta;
-    newMeta.id = new_flush_counter;
-    newMeta.level = level + 1;
-    newMeta.minKey = merged_data.begin()->first;
-    newMeta.maxKey = merged_data.rbegin()->first;
-    newMeta.maxSeq = seq_number_ - 1;
-    newMeta.sizeBytes = std::filesystem::file_size(dir_path + "sstable_" + std::to_string(new_flush_counter) + ".bin");
+    std::vector<std::string> boundaries = output_level == 0 ? std::vector<std::string>{} : subcompactionBoundaries(job.inputs);
+    std::vector<SubcompactionResult> shards(boundaries.size() + 1);
 
-    auto newVersion = version_manager_.getVersionForModification();
+    auto runShard = [&](size_t i) {
+        std::string lower = i == 0 ? std::string() : boundaries[i - 1];
+        std::optional<std::string> upper = i < boundaries.size() ? std::optional<std::string>(boundaries[i]) : std::nullopt;
+        try {
+            runSubcompaction(job, lower, upper, shards[i]);
+        } catch (const std::exception &e) {
+            std::cerr << "Subcompaction failed: " << e.what() << std::endl;
+            shards[i].ok = false;
+        }
+    };
 
-    if (newVersion->levels.size() <= level + 1) {
-        newVersion->levels.resize(level + 2);
+    std::vector<std::future<void>> pending;
+    for (size_t i = 1; i < shards.size(); i++) {
+        if (subcompaction_pool_) {
+            pending.push_back(subcompaction_pool_->submit([&runShard, i] { runShard(i); }));
+        } else {
+            runShard(i);
+        }
+    }
+    runShard(0);
+    for (auto &f : pending) {
+        f.get();
     }
 
-    std::vector<uint64_t> idsToRemove = {srcMeta.id};
-    idsToRemove.insert(idsToRemove.end(), nextLevelIds.begin(), nextLevelIds.end());
-    newVersion->removeSSTablesByIds(idsToRemove);
+    // The outputs were never installed, so no snapshot can reach the blob records written for them
+    auto discardOutputs = [this, &shards] {
+        for (const auto &shard : shards) {
+            for (const auto &[sst, meta] : shard.outputs) {
+                std::filesystem::remove(sst->filename());
+            }
+            for (const auto &handle : shard.added_blobs) {
+                blob_store_->discard(handle);
+            }
+        }
+    };
 
-    newVersion->addSSTable(std::move(newSSTable), newMeta);
-    newVersion->flush_counter = new_flush_counter;
+    // All-or-nothing: a failed shard leaves the inputs in place and its siblings' outputs are discarded
+    if (std::any_of(shards.begin(), shards.end(), [](const SubcompactionResult &r) { return !r.ok; })) {
+        discardOutputs();
+        return;
+    }
 
-    std::sort(newVersion->levels[level + 1].begin(), newVersion->levels[level + 1].end(),
-              [](const SSTableMeta &a, const SSTableMeta &b) { return a.minKey < b.minKey; });
+    VersionEdit edit;
+    edit.removed_ids = job.input_ids;
+    std::vector<BlobHandle> obsoleteBlobs;
+    for (const auto &shard : shards) {
+        edit.added.insert(edit.added.end(), shard.outputs.begin(), shard.outputs.end());
+        obsoleteBlobs.insert(obsoleteBlobs.end(), shard.obsolete_blobs.begin(), shard.obsolete_blobs.end());
+    }
 
-    version_manager_.installVersion(newVersion);
+    if (!version_manager_.applyEdit(edit)) {
+        std::cerr << "Compaction into level " << output_level << " conflicted with a concurrent version change" << std::endl;
+        discardOutputs();
+        return;
+    }
+    releaseBlobs(obsoleteBlobs);
+
+    uint64_t written = 0;
+    for (const auto &[sst, meta] : edit.added) {
+        written += meta.sizeBytes;
+    }
+    compaction_bytes_read_.fetch_add(job.input_bytes, std::memory_order_relaxed);
+    compaction_bytes_written_.fetch_add(written, std::memory_order_relaxed);
+    compactions_completed_.fetch_add(1, std::memory_order_relaxed);
 
     {
         std::lock_guard<std::mutex> lock(metadata_mutex_);
         saveMetadata();
     }
 
-    for (uint64_t id : idsToRemove) {
-        std::filesystem::remove(data_dir_ + "/sstables/sstable_" + std::to_string(id) + ".bin");
+    // Removed once no version or snapshot reads them any more
+    for (const auto &sst : job.inputs) {
+        sst->markObsolete();
     }
+}
 
-    if (cache_) {
-        cache_->clear();
-    }
+CompactionStats StorageEngine::compactionStats() const {
+    CompactionStats stats;
+    stats.flush_bytes_written = flush_bytes_written_.load(std::memory_order_relaxed);
+    stats.compaction_bytes_read = compaction_bytes_read_.load(std::memory_order_relaxed);
+    stats.compaction_bytes_written = compaction_bytes_written_.load(std::memory_order_relaxed);
+    stats.compactions_completed = compactions_completed_.load(std::memory_order_relaxed);
+    stats.pending_compaction_bytes = pending_compaction_bytes_.load(std::memory_order_relaxed);
+    stats.rate_limit_bytes_per_sec = rate_limiter_ ? rate_limiter_->bytesPerSecond() : 0;
+    return stats;
+}
+
+WriteStallStats StorageEngine::writeStallStats() const {
+    return write_controller_.stats();
+}
+
+RowCacheStats StorageEngine::rowCacheStats() const {
+    return cache_ ? cache_->stats() : RowCacheStats{};
 }
 
 void StorageEngine::waitForCompaction() {
@@ -949,7 +2199,7 @@ void StorageEngine::waitForCompaction() {
 
     std::unique_lock<std::mutex> lock(compaction_mutex_);
     compaction_cv_.wait_for(lock, std::chrono::seconds(5), [this] {
-        return !compaction_in_progress_.load(std::memory_order_acquire) && !compaction_needed_.load(std::memory_order_acquire);
+        return running_compactions_.empty() && !compaction_needed_.load(std::memory_order_acquire);
     });
 
     std::this_thread::sleep_for(std::chrono::milliseconds(50));
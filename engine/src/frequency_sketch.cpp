@@ -0,0 +1,53 @@
+#include "frequency_sketch.h"
+#include <algorithm>
+
+// Odd multipliers giving each row its own spread of the same hash
+static constexpr uint64_t ROW_SEEDS[] = {0x9E3779B97F4A7C15ULL, 0xC2B2AE3D27D4EB4FULL, 0x165667B19E3779F9ULL, 0xD6E8FEB86659FD93ULL};
+
+FrequencySketch::FrequencySketch(size_t expected_keys) : width_(16) {
+    while (width_ < expected_keys) {
+        width_ <<= 1;
+    }
+    counters_.assign(ROWS * width_, 0);
+    sample_size_ = 10 * width_;
+}
+
+size_t FrequencySketch::indexOf(uint64_t hash, size_t row) const {
+    uint64_t h = (hash ^ (hash >> 32)) * ROW_SEEDS[row];
+    return row * width_ + static_cast<size_t>((h >> 32) & (width_ - 1));
+}
+
+// Conservative update: only the counters at the current minimum are raised, which keeps keys that share counters
+// with a hot key from inheriting its count
+void FrequencySketch::increment(uint64_t hash) {
+    const uint32_t current = estimate(hash);
+    if (current >= MAX_COUNT) {
+        return;
+    }
+
+    for (size_t row = 0; row < ROWS; row++) {
+        uint8_t &counter = counters_[indexOf(hash, row)];
+        if (counter == current) {
+            counter++;
+        }
+    }
+
+    if (++additions_ >= sample_size_) {
+        age();
+    }
+}
+
+uint32_t FrequencySketch::estimate(uint64_t hash) const {
+    uint32_t count = MAX_COUNT;
+    for (size_t row = 0; row < ROWS; row++) {
+        count = std::min<uint32_t>(count, counters_[indexOf(hash, row)]);
+    }
+    return count;
+}
+
+void FrequencySketch::age() {
+    for (uint8_t &counter : counters_) {
+        counter >>= 1;
+    }
+    additions_ /= 2;
+}
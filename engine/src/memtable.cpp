@@ -1,26 +1,150 @@
 #include "memtable.h"
 
-bool MemTable::put(const std::string &key, const std::string &value, uint64_t seqNumber) {
+// Size of the entry's WAL record, the unit the memtable is measured in
+static size_t recordSize(const std::string &key, const Entry &entry) {
+    constexpr size_t checksumSize = 4;
+    constexpr size_t keyLenSize = 2;
+    constexpr size_t valueLenSize = 2;
+    constexpr size_t opSize = 1;
+    constexpr size_t seqSize = sizeof(uint64_t);
+
+    size_t size = checksumSize + keyLenSize + valueLenSize + opSize + seqSize + key.size();
+    if (entry.type == EntryType::PUT) {
+        size += entry.value.size();
+    }
+    return size;
+}
+
+void MemTable::retainLocked(const std::string &key, Entry entry) {
+    size_ += recordSize(key, entry);
+    older_versions_[key].push_back(std::move(entry));
+}
+
+void MemTable::setLocked(const std::string &key, Entry entry, uint64_t retainSeq) {
+    size_ += recordSize(key, entry);
+    auto [it, inserted] = memtable_.try_emplace(key);
+    if (!inserted) {
+        size_ -= recordSize(key, it->second);
+        if (it->second.seq <= retainSeq) {
+            retainLocked(key, std::move(it->second));
+        }
+    }
+    it->second = std::move(entry);
+}
+
+void MemTable::putLocked(const std::string &key, const std::string &value, uint64_t seqNumber, uint64_t expiresAtMs, uint64_t retainSeq) {
+    setLocked(key, Entry{value, seqNumber, EntryType::PUT, expiresAtMs}, retainSeq);
+}
+
+bool MemTable::delLocked(const std::string &key, uint64_t seqNumber, uint64_t retainSeq) {
+    bool existed = memtable_.contains(key) && memtable_.at(key).type != EntryType::DELETE;
+    setLocked(key, Entry{"", seqNumber, EntryType::DELETE}, retainSeq);
+    return existed;
+}
+
+void MemTable::deleteRangeLocked(const std::string &start, const std::string &end, uint64_t seqNumber, uint64_t retainSeq) {
+    for (auto it = memtable_.lower_bound(start); it != memtable_.end() && it->first < end;) {
+        if (it->second.seq < seqNumber) {
+            size_ -= recordSize(it->first, it->second);
+            if (it->second.seq <= retainSeq) {
+                retainLocked(it->first, std::move(it->second));
+            }
+            it = memtable_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    range_tombstones_.push_back(RangeTombstone{start, end, seqNumber});
+    size_ += recordSize(start, Entry{end, seqNumber, EntryType::PUT});
+}
+
+bool MemTable::put(const std::string &key, const std::string &value, uint64_t seqNumber, uint64_t expiresAtMs) {
     std::unique_lock<std::shared_mutex> lock(mutex_);
-    memtable_[key] = Entry{value, seqNumber, EntryType::PUT};
+    putLocked(key, value, seqNumber, expiresAtMs);
     return true;
 }
 
 bool MemTable::del(const std::string &key, uint64_t seqNumber) {
     std::unique_lock<std::shared_mutex> lock(mutex_);
-    bool existed = memtable_.contains(key) && memtable_.at(key).type != EntryType::DELETE;
-    memtable_[key] = Entry{"", seqNumber, EntryType::DELETE};
-    return existed;
+    return delLocked(key, seqNumber);
+}
+
+void MemTable::deleteRange(const std::string &start, const std::string &end, uint64_t seqNumber) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    deleteRangeLocked(start, end, seqNumber);
 }
 
-bool MemTable::get(const std::string &key, Entry &out) const {
+void MemTable::apply(const std::vector<MemTableWrite> &writes, uint64_t retainSeq) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    for (const auto &write : writes) {
+        switch (write.op) {
+        case Operation::PUT:
+        case Operation::PUT_TTL:
+            putLocked(write.key, write.value, write.seq, write.expires_at_ms, retainSeq);
+            break;
+        case Operation::DELETE:
+            delLocked(write.key, write.seq, retainSeq);
+            break;
+        case Operation::DELETE_RANGE:
+            deleteRangeLocked(write.key, write.value, write.seq, retainSeq);
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+void MemTable::pruneVersions(uint64_t oldestSeq) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    for (auto it = older_versions_.begin(); it != older_versions_.end();) {
+        auto &versions = it->second;
+        // Every read sees the newest version at or below oldestSeq, or something newer; what is older than it is garbage
+        auto current = memtable_.find(it->first);
+        auto keep = std::find_if(versions.rbegin(), versions.rend(), [oldestSeq](const Entry &e) { return e.seq <= oldestSeq; });
+        auto first = versions.begin();
+        if (current != memtable_.end() && current->second.seq <= oldestSeq) {
+            first = versions.end();
+        } else if (keep != versions.rend()) {
+            first = std::prev(keep.base());
+        }
+        for (auto version = versions.begin(); version != first; ++version) {
+            size_ -= recordSize(it->first, *version);
+        }
+        versions.erase(versions.begin(), first);
+        it = versions.empty() ? older_versions_.erase(it) : std::next(it);
+    }
+}
+
+bool MemTable::get(const std::string &key, Entry &out, uint64_t maxSeq) const {
     std::shared_lock<std::shared_mutex> lock(mutex_);
     auto it = memtable_.find(key);
-    if (it == memtable_.end()) {
+    if (it != memtable_.end() && it->second.seq <= maxSeq) {
+        out = it->second;
+        return true;
+    }
+
+    auto older = older_versions_.find(key);
+    if (older == older_versions_.end()) {
         return false;
     }
-    out = it->second;
-    return true;
+    for (auto version = older->second.rbegin(); version != older->second.rend(); ++version) {
+        if (version->seq <= maxSeq) {
+            out = *version;
+            return true;
+        }
+    }
+    return false;
+}
+
+uint64_t MemTable::coveringTombstoneSeq(const std::string &key, uint64_t maxSeq) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    uint64_t seq = 0;
+    for (const auto &tombstone : range_tombstones_) {
+        if (tombstone.covers(key) && tombstone.seq <= maxSeq) {
+            seq = std::max(seq, tombstone.seq);
+        }
+    }
+    return seq;
 }
 
 const std::map<std::string, Entry> MemTable::snapshot() const {
@@ -28,27 +152,32 @@ const std::map<std::string, Entry> MemTable::snapshot() const {
     return memtable_;
 }
 
+std::vector<RangeTombstone> MemTable::rangeTombstones() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return range_tombstones_;
+}
+
+void MemTable::moveTo(MemTable &target) {
+    std::scoped_lock lock(mutex_, target.mutex_);
+    target.memtable_ = std::move(memtable_);
+    target.older_versions_ = std::move(older_versions_);
+    target.range_tombstones_ = std::move(range_tombstones_);
+    target.size_ = size_;
+    memtable_.clear();
+    older_versions_.clear();
+    range_tombstones_.clear();
+    size_ = 0;
+}
+
 void MemTable::clear() {
     std::unique_lock<std::shared_mutex> lock(mutex_);
     memtable_.clear();
+    older_versions_.clear();
+    range_tombstones_.clear();
+    size_ = 0;
 }
 
 size_t MemTable::getSize() const {
     std::shared_lock<std::shared_mutex> lock(mutex_);
-
-    size_t total = 0;
-    constexpr size_t checksumSize = 4;
-    constexpr size_t keyLenSize = 2;
-    constexpr size_t valueLenSize = 2;
-    constexpr size_t opSize = 1;
-    constexpr size_t seqSize = sizeof(uint64_t);
-
-    for (const auto &[key, entry] : memtable_) {
-        total += checksumSize + keyLenSize + valueLenSize + opSize + seqSize + key.size();
-        if (entry.type == EntryType::PUT) {
-            total += entry.value.size();
-        }
-    }
-
-    return total;
+    return size_;
 }
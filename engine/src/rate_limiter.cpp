@@ -0,0 +1,72 @@
+#include "rate_limiter.h"
+#include <algorithm>
+
+RateLimiter::RateLimiter(uint64_t bytes_per_sec, uint64_t burst_micros)
+    : bytes_per_sec_(bytes_per_sec), burst_micros_(std::max<uint64_t>(1, burst_micros)), last_refill_(Clock::now()) {
+}
+
+double RateLimiter::burstBytesLocked() const {
+    return std::max(1.0, static_cast<double>(bytes_per_sec_) * static_cast<double>(burst_micros_) / 1e6);
+}
+
+void RateLimiter::refillLocked() {
+    Clock::time_point now = Clock::now();
+    double elapsed = std::chrono::duration<double>(now - last_refill_).count();
+    last_refill_ = now;
+    available_ = std::min(burstBytesLocked(), available_ + elapsed * static_cast<double>(bytes_per_sec_));
+}
+
+void RateLimiter::request(size_t bytes, IOPriority priority) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    total_bytes_[static_cast<size_t>(priority)] += bytes;
+
+    if (priority == IOPriority::HIGH) {
+        if (bytes_per_sec_ > 0) {
+            refillLocked();
+            available_ -= static_cast<double>(bytes);
+        }
+        return;
+    }
+
+    // Large requests are granted a burst at a time so they cannot lock out everyone else
+    Clock::time_point start = Clock::now();
+    auto remaining = static_cast<double>(bytes);
+    while (remaining > 0 && bytes_per_sec_ > 0) {
+        refillLocked();
+        double chunk = std::min(remaining, burstBytesLocked());
+        if (available_ >= chunk) {
+            available_ -= chunk;
+            remaining -= chunk;
+            continue;
+        }
+
+        auto wait = std::chrono::microseconds(static_cast<int64_t>((chunk - available_) * 1e6 / static_cast<double>(bytes_per_sec_)) + 1);
+        cv_.wait_for(lock, wait);
+    }
+    total_wait_micros_ += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count());
+}
+
+void RateLimiter::setBytesPerSecond(uint64_t bytes_per_sec) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        refillLocked();
+        bytes_per_sec_ = bytes_per_sec;
+        available_ = std::min(available_, burstBytesLocked());
+    }
+    cv_.notify_all();
+}
+
+uint64_t RateLimiter::bytesPerSecond() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return bytes_per_sec_;
+}
+
+uint64_t RateLimiter::totalBytes(IOPriority priority) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return total_bytes_[static_cast<size_t>(priority)];
+}
+
+uint64_t RateLimiter::totalWaitMicros() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return total_wait_micros_;
+}
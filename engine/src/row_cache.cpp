@@ -0,0 +1,211 @@
+#include "row_cache.h"
+
+RowCache::RowCache(size_t capacity_bytes, int shard_bits, RowCachePolicy policy)
+    : num_shards_(size_t{1} << std::max(0, shard_bits)), shards_(std::make_unique<Shard[]>(num_shards_)), policy_(policy) {
+    for (size_t i = 0; i < num_shards_; i++) {
+        Shard &shard = shards_[i];
+        shard.capacity = capacity_bytes / num_shards_;
+        if (policy_ == RowCachePolicy::TINY_LFU) {
+            shard.window_capacity = static_cast<size_t>(static_cast<double>(shard.capacity) * WINDOW_FRACTION);
+            // No more entries than this can fit, however small they are
+            shard.sketch = std::make_unique<FrequencySketch>(shard.capacity / sizeof(Node));
+        }
+    }
+}
+
+size_t RowCache::charge(const std::string &key, const Entry &entry) {
+    return key.size() + entry.value.size() + sizeof(Node);
+}
+
+size_t RowCache::minCapacity(int shard_bits) {
+    return (size_t{1} << std::max(0, shard_bits)) * sizeof(Node);
+}
+
+RowCache::Shard &RowCache::shardFor(size_t hash) const {
+    return shards_[hash & (num_shards_ - 1)];
+}
+
+void RowCache::Shard::erase(std::list<Node>::iterator it) {
+    dropped_seq = std::max(dropped_seq, it->entry.seq);
+    index.erase(std::string_view(it->key));
+    usage -= it->charge;
+    if (it->in_window) {
+        window_usage -= it->charge;
+        window.erase(it);
+    } else {
+        lru.erase(it);
+    }
+}
+
+void RowCache::Shard::evictWindowLocked() {
+    while (window_usage > window_capacity) {
+        admitLocked(std::prev(window.end()));
+    }
+}
+
+// Moves the candidate from the window into the main LRU if it is read more often than every key it would
+// displace there; otherwise drops it and leaves the main LRU untouched
+void RowCache::Shard::admitLocked(std::list<Node>::iterator candidate) {
+    const size_t main_capacity = capacity - window_capacity;
+    const size_t main_usage = usage - window_usage;
+    const uint32_t frequency = sketch->estimate(candidate->hash);
+
+    size_t freed = 0;
+    size_t victims = 0;
+    auto victim = lru.end();
+    while (main_usage - freed + candidate->charge > main_capacity) {
+        if (victim == lru.begin() || sketch->estimate(std::prev(victim)->hash) >= frequency) {
+            stats.rejected++;
+            erase(candidate);
+            return;
+        }
+        --victim;
+        freed += victim->charge;
+        victims++;
+    }
+
+    for (; victims > 0; victims--) {
+        erase(std::prev(lru.end()));
+    }
+    window_usage -= candidate->charge;
+    candidate->in_window = false;
+    lru.splice(lru.begin(), window, candidate);
+}
+
+std::optional<Entry> RowCache::get(const std::string &key) {
+    const size_t hash = std::hash<std::string>{}(key);
+    Shard &shard = shardFor(hash);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (shard.sketch) {
+        shard.sketch->increment(hash);
+    }
+
+    auto it = shard.index.find(std::string_view(key));
+    if (it == shard.index.end()) {
+        shard.stats.misses++;
+        return std::nullopt;
+    }
+
+    shard.stats.hits++;
+    auto &segment = it->second->in_window ? shard.window : shard.lru;
+    segment.splice(segment.begin(), segment, it->second);
+    return it->second->entry;
+}
+
+void RowCache::put(const std::string &key, const Entry &entry) {
+    const size_t hash = std::hash<std::string>{}(key);
+    Shard &shard = shardFor(hash);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    putLocked(shard, key, entry, hash);
+}
+
+void RowCache::putIfCurrent(const std::string &key, const Entry &entry, uint64_t read_seq) {
+    const size_t hash = std::hash<std::string>{}(key);
+    Shard &shard = shardFor(hash);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (shard.dropped_seq > read_seq) {
+        return;
+    }
+    putLocked(shard, key, entry, hash);
+}
+
+void RowCache::putLocked(Shard &shard, const std::string &key, const Entry &entry, size_t hash) {
+    const size_t entryCharge = charge(key, entry);
+    auto it = shard.index.find(std::string_view(key));
+    if (it != shard.index.end()) {
+        // A reader that looked the key up before a write landed must not put back the version it found
+        if (it->second->entry.seq > entry.seq) {
+            return;
+        }
+        shard.erase(it->second);
+    }
+    if (entryCharge > shard.capacity) {
+        shard.dropped_seq = std::max(shard.dropped_seq, entry.seq);
+        return;
+    }
+
+    if (!shard.sketch) {
+        while (shard.usage + entryCharge > shard.capacity) {
+            shard.erase(std::prev(shard.lru.end()));
+        }
+        shard.lru.push_front(Node{key, entry, entryCharge, hash, false});
+        shard.index.emplace(std::string_view(shard.lru.front().key), shard.lru.begin());
+        shard.usage += entryCharge;
+        return;
+    }
+
+    shard.window.push_front(Node{key, entry, entryCharge, hash, true});
+    shard.index.emplace(std::string_view(shard.window.front().key), shard.window.begin());
+    shard.usage += entryCharge;
+    shard.window_usage += entryCharge;
+    shard.evictWindowLocked();
+}
+
+void RowCache::invalidate(const std::string &key) {
+    const size_t hash = std::hash<std::string>{}(key);
+    Shard &shard = shardFor(hash);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.index.find(std::string_view(key));
+    if (it != shard.index.end()) {
+        shard.erase(it->second);
+    }
+}
+
+void RowCache::invalidateRange(const std::string &start, const std::string &end, uint64_t seq) {
+    for (size_t i = 0; i < num_shards_; i++) {
+        Shard &shard = shards_[i];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        // Keys in the range that were not cached are covered too
+        shard.dropped_seq = std::max(shard.dropped_seq, seq);
+        for (auto it = shard.index.begin(); it != shard.index.end();) {
+            auto node = it->second;
+            ++it;
+            if (node->key >= start && node->key < end) {
+                shard.erase(node);
+            }
+        }
+    }
+}
+
+// Access frequencies are kept; only the cached values go. Sequence numbers start over after the engine clears its
+// data, so the dropped seqs do too.
+void RowCache::clear() {
+    for (size_t i = 0; i < num_shards_; i++) {
+        std::lock_guard<std::mutex> lock(shards_[i].mutex);
+        shards_[i].dropped_seq = 0;
+        shards_[i].index.clear();
+        shards_[i].window.clear();
+        shards_[i].lru.clear();
+        shards_[i].usage = 0;
+        shards_[i].window_usage = 0;
+    }
+}
+
+size_t RowCache::size() const {
+    size_t total = 0;
+    for (size_t i = 0; i < num_shards_; i++) {
+        std::lock_guard<std::mutex> lock(shards_[i].mutex);
+        total += shards_[i].index.size();
+    }
+    return total;
+}
+
+size_t RowCache::usage() const {
+    size_t total = 0;
+    for (size_t i = 0; i < num_shards_; i++) {
+        std::lock_guard<std::mutex> lock(shards_[i].mutex);
+        total += shards_[i].usage;
+    }
+    return total;
+}
+
+RowCacheStats RowCache::stats() const {
+    RowCacheStats total;
+    for (size_t i = 0; i < num_shards_; i++) {
+        std::lock_guard<std::mutex> lock(shards_[i].mutex);
+        total.hits += shards_[i].stats.hits;
+        total.misses += shards_[i].stats.misses;
+        total.rejected += shards_[i].stats.rejected;
+    }
+    return total;
+}
@@ -1,18 +1,29 @@
 #include "sstable.h"
 
-SSTable::SSTable(const std::string &path) : path_(path) {
+std::atomic<uint64_t> SSTable::next_cache_id_{1};
+
+SSTable::SSTable(const std::string &path) : path_(path), cache_id_(next_cache_id_.fetch_add(1, std::memory_order_relaxed)) {
     loadMetadata();
 }
 
 SSTable::~SSTable() {
     closeFile();
+    if (obsolete_.load()) {
+        std::error_code ec;
+        std::filesystem::remove(path_, ec);
+    }
+}
+
+void SSTable::markObsolete() {
+    obsolete_.store(true);
 }
 
 // cppcheck-suppress missingMemberCopy
 SSTable::SSTable(SSTable &&other) noexcept
     : path_(std::move(other.path_)), min_key_(std::move(other.min_key_)), max_key_(std::move(other.max_key_)),
       metadata_offset_(other.metadata_offset_), index_(std::move(other.index_)), bloom_filter_(std::move(other.bloom_filter_)),
-      cached_file_(std::move(other.cached_file_)) {
+      dictionary_(std::move(other.dictionary_)), range_tombstones_(std::move(other.range_tombstones_)), cache_id_(other.cache_id_),
+      block_cache_(std::move(other.block_cache_)), obsolete_(other.obsolete_.exchange(false)), cached_file_(std::move(other.cached_file_)) {
 }
 
 SSTable &SSTable::operator=(SSTable &&other) noexcept {
@@ -25,6 +36,11 @@ SSTable &SSTable::operator=(SSTable &&other) noexcept {
         metadata_offset_ = other.metadata_offset_;
         index_ = std::move(other.index_);
         bloom_filter_ = std::move(other.bloom_filter_);
+        dictionary_ = std::move(other.dictionary_);
+        range_tombstones_ = std::move(other.range_tombstones_);
+        cache_id_ = other.cache_id_;
+        block_cache_ = std::move(other.block_cache_);
+        obsolete_.store(other.obsolete_.exchange(false));
         cached_file_ = std::move(other.cached_file_);
     }
     return *this;
@@ -51,7 +67,9 @@ void SSTable::closeFile() const {
     cached_file_.reset();
 }
 
-SSTable SSTable::flush(const std::map<std::string, Entry> &snapshot, const std::string &dir_path, uint64_t flush_counter) {
+SSTable SSTable::flush(const std::map<std::string, Entry> &snapshot, const std::string &dir_path, uint64_t flush_counter,
+                       CompressionType compression, const std::string &dictionary, RateLimiter *rate_limiter, IOPriority priority,
+                       const std::vector<RangeTombstone> &range_tombstones) {
     std::string full_path = dir_path + "sstable_" + std::to_string(flush_counter) + ".bin";
 
     try {
@@ -69,129 +87,199 @@ SSTable SSTable::flush(const std::map<std::string, Entry> &snapshot, const std::
         throw std::runtime_error("Failed to open SSTable file: " + full_path);
     }
 
-    table.bloom_filter_ = std::make_unique<BloomFilter>(snapshot.size(), BLOOM_FP_RATE);
+    table.bloom_filter_ = std::make_unique<BloomFilter>(std::max<size_t>(1, snapshot.size()), BLOOM_FP_RATE);
+    if (compression != CompressionType::NONE) {
+        table.dictionary_ = dictionary;
+    }
 
-    size_t entry_count = 0;
+    BlockBuilder block(RESTART_INTERVAL);
+    std::string blockFirstKey;
+    uint64_t offset = 0;
+
+    // Each block is followed by a one-byte codec tag so incompressible blocks can be stored raw
+    auto flushBlock = [&]() {
+        std::string contents = block.finish();
+        std::string compressed;
+        CompressionType blockType = CompressionType::NONE;
+        if (compressBlock(compression, contents, compressed, table.dictionary_)) {
+            contents = std::move(compressed);
+            blockType = compression;
+        }
+        contents.push_back(static_cast<char>(blockType));
 
-    for (const auto &[k, v] : snapshot) {
+        if (rate_limiter) {
+            rate_limiter->request(contents.size(), priority);
+        }
+        sstableFile.write(contents.data(), contents.size());
+        table.index_.push_back(IndexEntry{blockFirstKey, offset, static_cast<uint32_t>(contents.size())});
+        offset += contents.size();
+    };
 
+    for (const auto &[k, v] : snapshot) {
         table.bloom_filter_->add(k);
 
-        if (entry_count % INDEX_INTERVAL == 0) {
-            uint64_t offset = sstableFile.tellp();
-            table.index_.push_back(IndexEntry{k, offset});
+        if (block.empty()) {
+            blockFirstKey = k;
         }
-        entry_count++;
+        block.add(k, v.value, v.seq, v.type, v.expires_at_ms);
 
-        uint32_t keyLen = k.size();
-        uint32_t valueLen = v.value.size();
-        const char *keyBytes = k.data();
-        const char *valueBytes = v.value.data();
-
-        sstableFile.write(reinterpret_cast<const char *>(&v.seq), sizeof(v.seq));
-        sstableFile.write(reinterpret_cast<const char *>(&v.type), sizeof(v.type));
-        sstableFile.write(reinterpret_cast<const char *>(&keyLen), sizeof(keyLen));
-        sstableFile.write(reinterpret_cast<const char *>(&valueLen), sizeof(valueLen));
-        sstableFile.write(keyBytes, keyLen);
-        sstableFile.write(valueBytes, valueLen);
+        if (block.estimatedSize() >= BLOCK_SIZE) {
+            flushBlock();
+        }
     }
 
-    table.min_key_ = snapshot.begin()->first;
-    table.max_key_ = snapshot.rbegin()->first;
-
-    uint32_t minKeyLen = table.min_key_.size();
-    uint32_t maxKeyLen = table.max_key_.size();
+    if (!block.empty()) {
+        flushBlock();
+    }
 
-    table.metadata_offset_ = sstableFile.tellp();
+    if (!snapshot.empty()) {
+        table.min_key_ = snapshot.begin()->first;
+        table.max_key_ = snapshot.rbegin()->first;
+    }
+    table.range_tombstones_ = range_tombstones;
+    for (size_t i = 0; i < range_tombstones.size(); i++) {
+        const RangeTombstone &t = range_tombstones[i];
+        if ((snapshot.empty() && i == 0) || t.start < table.min_key_) {
+            table.min_key_ = t.start;
+        }
+        if ((snapshot.empty() && i == 0) || t.end > table.max_key_) {
+            table.max_key_ = t.end;
+        }
+    }
+    table.metadata_offset_ = offset;
 
     // Write metadata
-    sstableFile.write(reinterpret_cast<const char *>(&minKeyLen), sizeof(minKeyLen));
-    sstableFile.write(reinterpret_cast<const char *>(&maxKeyLen), sizeof(maxKeyLen));
-    sstableFile.write(table.min_key_.data(), minKeyLen);
-    sstableFile.write(table.max_key_.data(), maxKeyLen);
-
-    // Write the index to file
-    uint32_t indexSize = table.index_.size();
-    sstableFile.write(reinterpret_cast<const char *>(&indexSize), sizeof(indexSize));
-
+    std::string meta;
+    putFixed32(meta, static_cast<uint32_t>(table.min_key_.size()));
+    putFixed32(meta, static_cast<uint32_t>(table.max_key_.size()));
+    meta.append(table.min_key_);
+    meta.append(table.max_key_);
+
+    // Index keys are prefix-compressed against the previous block's first key
+    putFixed32(meta, static_cast<uint32_t>(table.index_.size()));
+    const std::string *prevKey = nullptr;
     for (const auto &entry : table.index_) {
-        uint32_t keyLen = entry.key.size();
-        sstableFile.write(reinterpret_cast<const char *>(&keyLen), sizeof(keyLen));
-        sstableFile.write(entry.key.data(), keyLen);
-        sstableFile.write(reinterpret_cast<const char *>(&entry.offset), sizeof(entry.offset));
+        size_t shared = prevKey ? sharedPrefixLength(*prevKey, entry.key) : 0;
+        putVarint32(meta, static_cast<uint32_t>(shared));
+        putVarint32(meta, static_cast<uint32_t>(entry.key.size() - shared));
+        meta.append(entry.key, shared);
+        putFixed64(meta, entry.offset);
+        putFixed32(meta, entry.size);
+        prevKey = &entry.key;
     }
 
     // Write bloom filter
     std::vector<uint8_t> bloom_data = table.bloom_filter_->serialize();
-    uint32_t bloomSize = bloom_data.size();
-    sstableFile.write(reinterpret_cast<const char *>(&bloomSize), sizeof(bloomSize));
-    sstableFile.write(reinterpret_cast<const char *>(bloom_data.data()), bloomSize);
+    putFixed32(meta, static_cast<uint32_t>(bloom_data.size()));
+    meta.append(reinterpret_cast<const char *>(bloom_data.data()), bloom_data.size());
+
+    // Optional meta blocks: tag u8 | length fixed32 | bytes. Readers skip tags they do not know.
+    if (!table.dictionary_.empty()) {
+        meta.push_back(static_cast<char>(META_DICTIONARY));
+        putFixed32(meta, static_cast<uint32_t>(table.dictionary_.size()));
+        meta.append(table.dictionary_);
+    }
+    if (!table.range_tombstones_.empty()) {
+        std::string contents;
+        putVarint32(contents, static_cast<uint32_t>(table.range_tombstones_.size()));
+        for (const auto &t : table.range_tombstones_) {
+            putVarint32(contents, static_cast<uint32_t>(t.start.size()));
+            contents.append(t.start);
+            putVarint32(contents, static_cast<uint32_t>(t.end.size()));
+            contents.append(t.end);
+            putFixed64(contents, t.seq);
+        }
+        meta.push_back(static_cast<char>(META_RANGE_TOMBSTONES));
+        putFixed32(meta, static_cast<uint32_t>(contents.size()));
+        meta.append(contents);
+    }
 
-    sstableFile.write(reinterpret_cast<const char *>(&table.metadata_offset_), sizeof(table.metadata_offset_));
+    putFixed64(meta, table.metadata_offset_);
+    putFixed64(meta, TABLE_MAGIC);
+    if (rate_limiter) {
+        rate_limiter->request(meta.size(), priority);
+    }
+    sstableFile.write(meta.data(), meta.size());
 
     return table;
 }
 
-std::optional<Entry> SSTable::get(const std::string &key) const {
-    if (key < min_key_ || key > max_key_) {
-        return std::nullopt;
+std::shared_ptr<Block> SSTable::readBlock(std::ifstream &file, const IndexEntry &handle) const {
+    std::string contents(handle.size, '\0');
+    file.clear();
+    file.seekg(handle.offset);
+    if (handle.size == 0 || !file.read(contents.data(), handle.size)) {
+        throw std::runtime_error("Failed to read SSTable block at offset " + std::to_string(handle.offset));
     }
 
-    if (bloom_filter_ && !bloom_filter_->contains(key)) {
-        return std::nullopt;
+    auto type = static_cast<CompressionType>(contents.back());
+    if (type == CompressionType::NONE) {
+        contents.pop_back();
+        return std::make_shared<Block>(std::move(contents));
     }
+    return std::make_shared<Block>(decompressBlock(type, contents.data(), contents.size() - 1, dictionary_));
+}
 
-    // Get the cached file handle
-    std::ifstream &file = getFile();
+void SSTable::setBlockCache(std::shared_ptr<BlockCache> cache) {
+    block_cache_ = std::move(cache);
+}
 
-    // Binary search index to find start position
-    uint64_t search_start = 0;
-    uint64_t search_end = metadata_offset_;
+const std::string &SSTable::dictionary() const {
+    return dictionary_;
+}
 
-    if (!index_.empty()) {
-        auto it = std::upper_bound(index_.begin(), index_.end(), key,
-                                   [](const std::string &k, const IndexEntry &entry) { return k < entry.key; });
-        if (it != index_.begin()) {
-            --it;
-            search_start = it->offset;
-        }
+const std::vector<RangeTombstone> &SSTable::rangeTombstones() const {
+    return range_tombstones_;
+}
 
-        if (it != index_.end() && (it + 1) != index_.end()) {
-            search_end = (it + 1)->offset;
+uint64_t SSTable::coveringTombstoneSeq(const std::string &key) const {
+    uint64_t seq = 0;
+    for (const auto &t : range_tombstones_) {
+        if (t.covers(key)) {
+            seq = std::max(seq, t.seq);
         }
     }
+    return seq;
+}
 
-    // Lock for the actual file I/O operations
-    std::lock_guard<std::mutex> lock(file_mutex_);
-
-    file.seekg(search_start);
+std::optional<Entry> SSTable::get(const std::string &key) const {
+    if (key < min_key_ || key > max_key_) {
+        return std::nullopt;
+    }
 
-    while (file.tellg() < static_cast<std::streampos>(search_end)) {
-        uint64_t seq;
-        EntryType type;
-        uint32_t keyLen, valueLen;
+    if (bloom_filter_ && !bloom_filter_->contains(key)) {
+        return std::nullopt;
+    }
 
-        if (!file.read(reinterpret_cast<char *>(&seq), sizeof(seq)))
-            break;
-        file.read(reinterpret_cast<char *>(&type), sizeof(type));
-        file.read(reinterpret_cast<char *>(&keyLen), sizeof(keyLen));
-        file.read(reinterpret_cast<char *>(&valueLen), sizeof(valueLen));
+    // Binary search index for the last block whose first key is <= key
+    auto it = std::upper_bound(index_.begin(), index_.end(), key,
+                               [](const std::string &k, const IndexEntry &entry) { return k < entry.key; });
+    if (it == index_.begin()) {
+        return std::nullopt;
+    }
+    --it;
 
-        std::string k(keyLen, '\0');
-        std::string v(valueLen, '\0');
+    std::shared_ptr<Block> block = block_cache_ ? block_cache_->get(cache_id_, it->offset) : nullptr;
+    if (!block) {
+        // Get the cached file handle
+        std::ifstream &file = getFile();
 
-        file.read(k.data(), keyLen);
-        if (type == EntryType::PUT) {
-            file.read(v.data(), valueLen);
+        {
+            // Lock for the actual file I/O operations
+            std::lock_guard<std::mutex> lock(file_mutex_);
+            block = readBlock(file, *it);
         }
 
-        if (k == key) {
-            return Entry{v, seq, type};
+        if (block_cache_) {
+            block_cache_->put(cache_id_, it->offset, block);
         }
+    }
 
-        if (k > key) {
-            break;
-        }
+    Block::Iterator iter(*block);
+    iter.seek(key);
+    if (iter.valid() && iter.entry().key == key) {
+        const SSTableEntry &e = iter.entry();
+        return Entry{e.value, e.seq, e.type, e.expires_at_ms};
     }
     return std::nullopt;
 }
@@ -199,124 +287,201 @@ std::optional<Entry> SSTable::get(const std::string &key) const {
 std::map<std::string, Entry> SSTable::getData() const {
     std::map<std::string, Entry> data;
 
-    std::ifstream &file = getFile();
-    std::lock_guard<std::mutex> lock(file_mutex_);
-
-    file.seekg(0);
-
-    while (file.tellg() < static_cast<std::streampos>(metadata_offset_)) {
-        uint64_t seq;
-        EntryType type;
-        uint32_t keyLen, valueLen;
-
-        if (!file.read(reinterpret_cast<char *>(&seq), sizeof(seq)))
-            break;
-        file.read(reinterpret_cast<char *>(&type), sizeof(type));
-        file.read(reinterpret_cast<char *>(&keyLen), sizeof(keyLen));
-        file.read(reinterpret_cast<char *>(&valueLen), sizeof(valueLen));
-
-        std::string k(keyLen, '\0');
-        std::string v(valueLen, '\0');
-
-        file.read(k.data(), keyLen);
-        if (type == EntryType::PUT) {
-            file.read(v.data(), valueLen);
-        }
-
-        data[k] = Entry{v, seq, type};
+    for (Iterator it(*this); it.valid(); it.next()) {
+        const SSTableEntry &e = it.entry();
+        data[e.key] = Entry{e.value, e.seq, e.type, e.expires_at_ms};
     }
     return data;
 }
 
 void SSTable::loadMetadata() {
-    std::ifstream sstableFile(path_, std::ios::binary);
+    std::ifstream sstableFile(path_, std::ios::binary | std::ios::ate);
     if (!sstableFile)
         return;
 
-    sstableFile.seekg(-static_cast<int>(sizeof(uint64_t)), std::ios::end);
-    sstableFile.read(reinterpret_cast<char *>(&metadata_offset_), sizeof(metadata_offset_));
-
-    sstableFile.seekg(metadata_offset_);
-
-    uint32_t minKeyLen, maxKeyLen;
-    sstableFile.read(reinterpret_cast<char *>(&minKeyLen), sizeof(minKeyLen));
-    sstableFile.read(reinterpret_cast<char *>(&maxKeyLen), sizeof(maxKeyLen));
-
-    min_key_.resize(minKeyLen);
-    max_key_.resize(maxKeyLen);
-
-    sstableFile.read(&min_key_[0], minKeyLen);
-    sstableFile.read(&max_key_[0], maxKeyLen);
+    constexpr size_t kFooterSize = 2 * sizeof(uint64_t);
+    const uint64_t fileSize = static_cast<uint64_t>(sstableFile.tellg());
+    if (fileSize < kFooterSize) {
+        throw std::runtime_error("SSTable too small: " + path_);
+    }
 
-    uint32_t indexSize;
-    sstableFile.read(reinterpret_cast<char *>(&indexSize), sizeof(indexSize));
+    char footer[kFooterSize];
+    sstableFile.seekg(fileSize - kFooterSize);
+    sstableFile.read(footer, kFooterSize);
+    metadata_offset_ = decodeFixed64(footer);
+    if (decodeFixed64(footer + sizeof(uint64_t)) != TABLE_MAGIC || metadata_offset_ > fileSize - kFooterSize) {
+        throw std::runtime_error("Unsupported or corrupted SSTable: " + path_);
+    }
 
+    std::string meta(fileSize - kFooterSize - metadata_offset_, '\0');
+    sstableFile.seekg(metadata_offset_);
+    sstableFile.read(meta.data(), meta.size());
+
+    const char *p = meta.data();
+    const char *limit = p + meta.size();
+    auto corrupted = [this]() { return std::runtime_error("Corrupted SSTable metadata: " + path_); };
+    auto readFixed32 = [&]() {
+        if (limit - p < static_cast<std::ptrdiff_t>(sizeof(uint32_t)))
+            throw corrupted();
+        uint32_t v = decodeFixed32(p);
+        p += sizeof(uint32_t);
+        return v;
+    };
+    auto readBytes = [&](std::string &dst, size_t n) {
+        if (static_cast<size_t>(limit - p) < n)
+            throw corrupted();
+        dst.append(p, n);
+        p += n;
+    };
+
+    uint32_t minKeyLen = readFixed32();
+    uint32_t maxKeyLen = readFixed32();
+    min_key_.clear();
+    max_key_.clear();
+    readBytes(min_key_, minKeyLen);
+    readBytes(max_key_, maxKeyLen);
+
+    uint32_t indexSize = readFixed32();
+    index_.clear();
     index_.reserve(indexSize);
+    std::string prevKey;
     for (uint32_t i = 0; i < indexSize; i++) {
-        uint32_t keyLen;
-        sstableFile.read(reinterpret_cast<char *>(&keyLen), sizeof(keyLen));
+        uint32_t shared, unshared;
+        if (!getVarint32(p, limit, shared) || !getVarint32(p, limit, unshared) || shared > prevKey.size())
+            throw corrupted();
 
-        std::string key(keyLen, '\0');
-        sstableFile.read(&key[0], keyLen);
+        std::string key = prevKey.substr(0, shared);
+        readBytes(key, unshared);
 
-        uint64_t offset;
-        sstableFile.read(reinterpret_cast<char *>(&offset), sizeof(offset));
+        if (limit - p < static_cast<std::ptrdiff_t>(sizeof(uint64_t)))
+            throw corrupted();
+        uint64_t offset = decodeFixed64(p);
+        p += sizeof(uint64_t);
+        uint32_t size = readFixed32();
 
-        index_.push_back(IndexEntry{key, offset});
+        prevKey = key;
+        index_.push_back(IndexEntry{std::move(key), offset, size});
     }
 
-    uint32_t bloomSize;
-    sstableFile.read(reinterpret_cast<char *>(&bloomSize), sizeof(bloomSize));
-
-    std::vector<uint8_t> bloom_data(bloomSize);
-    sstableFile.read(reinterpret_cast<char *>(bloom_data.data()), bloomSize);
+    uint32_t bloomSize = readFixed32();
+    if (static_cast<size_t>(limit - p) < bloomSize)
+        throw corrupted();
+    std::vector<uint8_t> bloom_data(p, p + bloomSize);
+    p += bloomSize;
 
     bloom_filter_ = std::make_unique<BloomFilter>(BloomFilter::deserialize(bloom_data));
+
+    dictionary_.clear();
+    range_tombstones_.clear();
+    while (p < limit) {
+        uint8_t tag = static_cast<uint8_t>(*p++);
+        uint32_t length = readFixed32();
+        std::string contents;
+        readBytes(contents, length);
+
+        if (tag == META_DICTIONARY) {
+            dictionary_ = std::move(contents);
+        } else if (tag == META_RANGE_TOMBSTONES) {
+            const char *q = contents.data();
+            const char *end = q + contents.size();
+            auto readString = [&](std::string &dst) {
+                uint32_t len;
+                if (!getVarint32(q, end, len) || static_cast<size_t>(end - q) < len)
+                    throw corrupted();
+                dst.assign(q, len);
+                q += len;
+            };
+
+            uint32_t count;
+            if (!getVarint32(q, end, count))
+                throw corrupted();
+            for (uint32_t i = 0; i < count; i++) {
+                RangeTombstone t;
+                readString(t.start);
+                readString(t.end);
+                if (end - q < static_cast<std::ptrdiff_t>(sizeof(uint64_t)))
+                    throw corrupted();
+                t.seq = decodeFixed64(q);
+                q += sizeof(uint64_t);
+                range_tombstones_.push_back(std::move(t));
+            }
+        }
+    }
 }
 
 const std::string &SSTable::filename() const {
     return path_;
 }
 
-SSTable::Iterator::Iterator(const SSTable &table) : file_(table.path_, std::ios::binary), data_end_(table.metadata_offset_) {
+const std::string &SSTable::minKey() const {
+    return min_key_;
+}
+
+const std::string &SSTable::maxKey() const {
+    return max_key_;
+}
+
+std::vector<std::string> SSTable::indexKeys() const {
+    std::vector<std::string> keys;
+    keys.reserve(index_.size());
+    for (const auto &entry : index_) {
+        keys.push_back(entry.key);
+    }
+    return keys;
+}
+
+SSTable::Iterator::Iterator(const SSTable &table) : table_(&table), file_(table.path_, std::ios::binary) {
     if (!file_) {
         throw std::runtime_error("Failed to open the SSTable: " + table.path_);
     }
 
-    file_.seekg(0);
-
     readNext();
 }
 
 void SSTable::Iterator::readNext() {
-    if (file_.tellg() >= static_cast<std::streampos>(data_end_)) {
-        valid_ = false;
-        return;
+    if (block_iter_) {
+        block_iter_->next();
+        if (block_iter_->valid()) {
+            valid_ = true;
+            return;
+        }
     }
 
-    uint64_t seq;
-    EntryType type;
-    uint32_t keyLen, valueLen;
-
-    if (!file_.read(reinterpret_cast<char *>(&seq), sizeof(seq))) {
-        valid_ = false;
-        return;
+    while (block_index_ < table_->index_.size()) {
+        block_ = table_->readBlock(file_, table_->index_[block_index_++]);
+        block_iter_.emplace(*block_);
+        block_iter_->seekToFirst();
+        if (block_iter_->valid()) {
+            valid_ = true;
+            return;
+        }
     }
 
-    file_.read(reinterpret_cast<char *>(&type), sizeof(type));
-    file_.read(reinterpret_cast<char *>(&keyLen), sizeof(keyLen));
-    file_.read(reinterpret_cast<char *>(&valueLen), sizeof(valueLen));
+    valid_ = false;
+}
+
+void SSTable::Iterator::seek(const std::string &target) {
+    // Start from the last block whose first key is <= target
+    auto it = std::upper_bound(table_->index_.begin(), table_->index_.end(), target,
+                               [](const std::string &k, const IndexEntry &entry) { return k < entry.key; });
+    block_index_ = it == table_->index_.begin() ? 0 : static_cast<size_t>(it - table_->index_.begin()) - 1;
+    block_iter_.reset();
+    valid_ = false;
 
-    std::string key(keyLen, '\0');
-    std::string value(valueLen, '\0');
+    if (block_index_ >= table_->index_.size()) {
+        return;
+    }
 
-    file_.read(key.data(), keyLen);
-    if (type == EntryType::PUT) {
-        file_.read(value.data(), valueLen);
+    block_ = table_->readBlock(file_, table_->index_[block_index_++]);
+    block_iter_.emplace(*block_);
+    block_iter_->seek(target);
+    if (block_iter_->valid()) {
+        valid_ = true;
+        return;
     }
 
-    current_ = SSTableEntry{key, value, seq, type};
-    valid_ = true;
+    block_iter_.reset();
+    readNext();
 }
 
 void SSTable::Iterator::next() {
@@ -328,5 +493,5 @@ bool SSTable::Iterator::valid() const {
 }
 
 const SSTableEntry &SSTable::Iterator::entry() const {
-    return current_;
+    return block_iter_->entry();
 }
@@ -64,3 +64,33 @@ void VersionManager::installVersion(std::shared_ptr<TableVersion> newVersion) {
 std::shared_ptr<TableVersion> VersionManager::getVersionForModification() const {
     return TableVersion::copyFrom(std::atomic_load(&current_version_));
 }
+
+bool VersionManager::applyEdit(const VersionEdit &edit) {
+    std::lock_guard<std::mutex> lock(edit_mutex_);
+    auto newVersion = getVersionForModification();
+
+    for (uint64_t id : edit.removed_ids) {
+        bool live = std::any_of(newVersion->levels.begin(), newVersion->levels.end(), [id](const std::vector<SSTableMeta> &level) {
+            return std::any_of(level.begin(), level.end(), [id](const SSTableMeta &meta) { return meta.id == id; });
+        });
+        if (!live) {
+            return false;
+        }
+    }
+
+    newVersion->removeSSTablesByIds(edit.removed_ids);
+
+    for (const auto &[sst, meta] : edit.added) {
+        newVersion->addSSTable(sst, meta);
+        newVersion->flush_counter = std::max(newVersion->flush_counter, meta.id);
+    }
+
+    // L1+ lookups binary search by key range
+    for (size_t level = 1; level < newVersion->levels.size(); level++) {
+        std::sort(newVersion->levels[level].begin(), newVersion->levels[level].end(),
+                  [](const SSTableMeta &a, const SSTableMeta &b) { return a.minKey < b.minKey; });
+    }
+
+    std::atomic_store(&current_version_, std::move(newVersion));
+    return true;
+}
@@ -0,0 +1,101 @@
+#include "transaction.h"
+#include "coding.h"
+#include "engine.h"
+#include <algorithm>
+#include <iterator>
+
+Transaction::Transaction(StorageEngine &engine) : engine_(engine), snapshot_(engine.getSnapshot()) {
+    reads_.seq = snapshot_->sequence();
+}
+
+Transaction::~Transaction() {
+    if (snapshot_) {
+        engine_.releaseSnapshot(snapshot_);
+    }
+}
+
+bool Transaction::get(const std::string &key, Entry &out) {
+    auto it = writes_.find(key);
+    if (it != writes_.end()) {
+        if (!it->second) {
+            return false;
+        }
+        out = Entry{*it->second, reads_.seq, EntryType::PUT};
+        return true;
+    }
+
+    // Missing keys are recorded too: inserting one concurrently is as much a conflict as updating it
+    reads_.keys.push_back(key);
+    ReadOptions options;
+    options.snapshot = snapshot_;
+    return engine_.get(options, key, out);
+}
+
+void Transaction::put(const std::string &key, const std::string &value) {
+    writes_[key] = value;
+}
+
+void Transaction::del(const std::string &key) {
+    writes_[key] = std::nullopt;
+}
+
+bool Transaction::commit() {
+    if (committed_) {
+        return false;
+    }
+    committed_ = true;
+
+    bool ok = true;
+    // Everything a read-only transaction saw came from one snapshot, so there is nothing to validate
+    if (!writes_.empty()) {
+        std::sort(reads_.keys.begin(), reads_.keys.end());
+        reads_.keys.erase(std::unique(reads_.keys.begin(), reads_.keys.end()), reads_.keys.end());
+        ok = engine_.commitTransaction(encodeTransactionWrites(writes_), reads_);
+    }
+
+    engine_.releaseSnapshot(snapshot_);
+    snapshot_ = nullptr;
+    return ok;
+}
+
+std::string encodeTransactionWrites(const std::map<std::string, std::optional<std::string>> &writes) {
+    std::string encoded;
+    for (const auto &[key, value] : writes) {
+        encoded.push_back(static_cast<char>(value ? Operation::PUT : Operation::DELETE));
+        putVarint32(encoded, static_cast<uint32_t>(key.size()));
+        encoded.append(key);
+        putVarint32(encoded, static_cast<uint32_t>(value ? value->size() : 0));
+        if (value) {
+            encoded.append(*value);
+        }
+    }
+    return encoded;
+}
+
+bool decodeTransactionWrites(const std::string &encoded, uint64_t first_seq, std::vector<MemTableWrite> &out) {
+    std::vector<MemTableWrite> writes;
+    const char *ptr = encoded.data();
+    const char *limit = ptr + encoded.size();
+
+    while (ptr < limit) {
+        auto op = static_cast<Operation>(*ptr++);
+        if (op != Operation::PUT && op != Operation::DELETE) {
+            return false;
+        }
+        uint32_t keyLength;
+        if (!getVarint32(ptr, limit, keyLength) || static_cast<size_t>(limit - ptr) < keyLength) {
+            return false;
+        }
+        std::string key(ptr, keyLength);
+        ptr += keyLength;
+        uint32_t valueLength;
+        if (!getVarint32(ptr, limit, valueLength) || static_cast<size_t>(limit - ptr) < valueLength) {
+            return false;
+        }
+        writes.push_back(MemTableWrite{op, std::move(key), std::string(ptr, valueLength), first_seq + writes.size()});
+        ptr += valueLength;
+    }
+
+    out.insert(out.end(), std::make_move_iterator(writes.begin()), std::make_move_iterator(writes.end()));
+    return true;
+}
@@ -1,6 +1,7 @@
 #include "wal.h"
 
-WriteAheadLog::WriteAheadLog(const std::string &path, int sync_interval_ms) : path_(path), sync_interval_ms_(sync_interval_ms) {
+WriteAheadLog::WriteAheadLog(const std::string &path, int sync_interval_ms)
+    : path_(path), rotated_path_(path + ".old"), sync_interval_ms_(sync_interval_ms) {
     std::filesystem::path p(path_);
     std::filesystem::create_directories(p.parent_path());
 
@@ -52,10 +53,13 @@ void WriteAheadLog::syncThreadLoop() {
 }
 
 void WriteAheadLog::doSync() {
+    // Generations are handed out under buffer_mutex_, so every append made before this generation is in the buffer
+    uint64_t generation;
     {
         std::lock_guard<std::mutex> lock(buffer_mutex_);
+        generation = sync_generation_.load();
         if (write_buffer_size_ == 0) {
-            synced_generation_.store(sync_generation_.load());
+            synced_generation_.store(generation);
             sync_done_cv_.notify_all();
             return;
         }
@@ -74,7 +78,10 @@ void WriteAheadLog::doSync() {
         sync_buffer_.clear();
     }
 
-    synced_generation_.store(sync_generation_.load());
+    {
+        std::lock_guard<std::mutex> lock(buffer_mutex_);
+        synced_generation_.store(generation);
+    }
     sync_done_cv_.notify_all();
 }
 
@@ -135,35 +142,41 @@ void WriteAheadLog::append(Operation op, const std::string &key, const std::stri
 }
 
 void WriteAheadLog::flush() {
-    sync_generation_.fetch_add(1);
-    uint64_t my_gen = sync_generation_.load();
-    {
-        std::lock_guard<std::mutex> lock(sync_mutex_);
-        sync_requested_ = true;
-    }
-    sync_cv_.notify_one();
-
-    std::unique_lock<std::mutex> lock(buffer_mutex_);
-    sync_done_cv_.wait(lock, [this, my_gen] { return synced_generation_.load() >= my_gen; });
+    waitForSync(requestSync());
 }
 
 // cppcheck-suppress unusedFunction
 void WriteAheadLog::syncFlush() {
-    sync_generation_.fetch_add(1);
-    uint64_t my_gen = sync_generation_.load();
+    waitForSync(requestSync());
+}
 
+uint64_t WriteAheadLog::requestSync() {
+    uint64_t generation;
+    {
+        std::lock_guard<std::mutex> lock(buffer_mutex_);
+        generation = sync_generation_.fetch_add(1) + 1;
+    }
     {
         std::lock_guard<std::mutex> lock(sync_mutex_);
         sync_requested_ = true;
     }
     sync_cv_.notify_one();
+    return generation;
+}
 
+void WriteAheadLog::waitForSync(uint64_t generation) {
     std::unique_lock<std::mutex> lock(buffer_mutex_);
-    sync_done_cv_.wait(lock, [this, my_gen] { return synced_generation_.load() >= my_gen; });
+    sync_done_cv_.wait(lock, [this, generation] { return synced_generation_.load() >= generation; });
 }
 
 void WriteAheadLog::replay(std::function<void(uint64_t, Operation, std::string &, std::string &)> apply) {
-    std::ifstream inputFile(path_, std::ios::in | std::ios::binary);
+    replayFile(rotated_path_, apply);
+    replayFile(path_, apply);
+}
+
+void WriteAheadLog::replayFile(const std::string &path,
+                               const std::function<void(uint64_t, Operation, std::string &, std::string &)> &apply) {
+    std::ifstream inputFile(path, std::ios::in | std::ios::binary);
     if (!inputFile) {
         return;
     }
@@ -193,8 +206,41 @@ void WriteAheadLog::replay(std::function<void(uint64_t, Operation, std::string &
 }
 
 bool WriteAheadLog::empty() const {
-    if (!std::filesystem::exists(path_)) {
-        return true;
+    auto fileEmpty = [](const std::string &path) { return !std::filesystem::exists(path) || std::filesystem::file_size(path) == 0; };
+    return fileEmpty(path_) && fileEmpty(rotated_path_);
+}
+
+void WriteAheadLog::rotate() {
+    flush();
+
+    std::lock_guard<std::mutex> lock(buffer_mutex_);
+    if (fd_ != -1) {
+        close(fd_);
     }
-    return std::filesystem::file_size(path_) == 0;
+
+    if (std::filesystem::exists(rotated_path_)) {
+        // Both logs were replayed into the memtable being flushed, so both are needed until it is on disk
+        std::ifstream current(path_, std::ios::in | std::ios::binary);
+        std::vector<char> records((std::istreambuf_iterator<char>(current)), std::istreambuf_iterator<char>());
+        int rotated = open(rotated_path_.c_str(), O_WRONLY | O_APPEND);
+        if (rotated == -1 || write(rotated, records.data(), records.size()) != static_cast<ssize_t>(records.size())) {
+            std::cerr << "Failed to append to rotated WAL file: " << rotated_path_ << " - " << strerror(errno) << std::endl;
+        }
+        if (rotated != -1) {
+            fsync(rotated);
+            close(rotated);
+        }
+        std::filesystem::remove(path_);
+    } else if (std::filesystem::exists(path_)) {
+        std::filesystem::rename(path_, rotated_path_);
+    }
+
+    fd_ = open(path_.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (fd_ == -1) {
+        std::cerr << "Failed to open WAL file: " << path_ << " - " << strerror(errno) << std::endl;
+    }
+}
+
+void WriteAheadLog::removeRotated() {
+    std::filesystem::remove(rotated_path_);
 }
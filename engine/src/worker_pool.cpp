@@ -0,0 +1,59 @@
+#include "worker_pool.h"
+
+WorkerPool::WorkerPool(size_t num_threads) {
+    workers_.reserve(num_threads);
+    for (size_t i = 0; i < num_threads; i++) {
+        workers_.emplace_back(&WorkerPool::workerLoop, this);
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        shutdown_ = true;
+    }
+    cv_.notify_all();
+
+    for (auto &worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+std::future<void> WorkerPool::submit(std::function<void()> job) {
+    std::packaged_task<void()> task(std::move(job));
+    std::future<void> future = task.get_future();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        jobs_.push(std::move(task));
+    }
+    cv_.notify_one();
+
+    return future;
+}
+
+size_t WorkerPool::size() const {
+    return workers_.size();
+}
+
+void WorkerPool::workerLoop() {
+    while (true) {
+        std::packaged_task<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return shutdown_ || !jobs_.empty(); });
+
+            // Drain queued jobs before exiting so no future is left without a result
+            if (jobs_.empty()) {
+                return;
+            }
+
+            task = std::move(jobs_.front());
+            jobs_.pop();
+        }
+
+        task();
+    }
+}
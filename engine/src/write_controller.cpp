@@ -0,0 +1,104 @@
+#include "write_controller.h"
+#include <algorithm>
+
+// Pacing sleeps shorter than this are batched up; the scheduler cannot honour them anyway
+static constexpr double MIN_DELAY_MICROS = 1000.0;
+
+static double stallFraction(uint64_t value, uint64_t soft, uint64_t hard) {
+    if (soft == 0 || value < soft || hard <= soft) {
+        return 0.0;
+    }
+    return std::min(1.0, static_cast<double>(value - soft) / static_cast<double>(hard - soft));
+}
+
+WriteController::WriteController(size_t l0_slowdown_trigger, size_t l0_stop_trigger, uint64_t soft_pending_bytes,
+                                 uint64_t hard_pending_bytes, uint64_t delayed_write_rate)
+    : l0_slowdown_trigger_(l0_slowdown_trigger), l0_stop_trigger_(l0_stop_trigger), soft_pending_bytes_(soft_pending_bytes),
+      hard_pending_bytes_(hard_pending_bytes), delayed_write_rate_(std::max<uint64_t>(1, delayed_write_rate)) {
+}
+
+void WriteController::update(size_t l0_files, uint64_t pending_compaction_bytes) {
+    bool l0Stop = l0_stop_trigger_ > 0 && l0_files >= l0_stop_trigger_;
+    bool pendingStop = hard_pending_bytes_ > 0 && pending_compaction_bytes >= hard_pending_bytes_;
+    bool l0Slowdown = l0_slowdown_trigger_ > 0 && l0_files >= l0_slowdown_trigger_;
+    bool pendingSlowdown = soft_pending_bytes_ > 0 && pending_compaction_bytes >= soft_pending_bytes_;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (l0Stop || pendingStop) {
+            condition_ = WriteStallCondition::STOPPED;
+            l0_cause_ = l0Stop;
+            pending_cause_ = pendingStop;
+        } else if (l0Slowdown || pendingSlowdown) {
+            condition_ = WriteStallCondition::DELAYED;
+            l0_cause_ = l0Slowdown;
+            pending_cause_ = pendingSlowdown;
+            severity_ = std::max(stallFraction(l0_files, l0_slowdown_trigger_, l0_stop_trigger_),
+                                 stallFraction(pending_compaction_bytes, soft_pending_bytes_, hard_pending_bytes_));
+        } else {
+            condition_ = WriteStallCondition::NORMAL;
+            l0_cause_ = false;
+            pending_cause_ = false;
+        }
+    }
+    cv_.notify_all();
+}
+
+void WriteController::throttle(size_t bytes) {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    if (condition_ == WriteStallCondition::STOPPED && !shutdown_) {
+        stats_.l0_stops += l0_cause_ ? 1 : 0;
+        stats_.pending_compaction_stops += pending_cause_ ? 1 : 0;
+
+        Clock::time_point start = Clock::now();
+        cv_.wait(lock, [this] { return shutdown_ || condition_ != WriteStallCondition::STOPPED; });
+        stats_.stopped_micros += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count());
+    }
+
+    if (condition_ != WriteStallCondition::DELAYED || shutdown_) {
+        delay_debt_micros_ = 0.0;
+        return;
+    }
+
+    stats_.l0_slowdowns += l0_cause_ ? 1 : 0;
+    stats_.pending_compaction_slowdowns += pending_cause_ ? 1 : 0;
+
+    double rate = static_cast<double>(delayed_write_rate_) * std::max(0.1, 1.0 - severity_);
+    delay_debt_micros_ += static_cast<double>(bytes) * 1e6 / rate;
+    if (delay_debt_micros_ < MIN_DELAY_MICROS) {
+        return;
+    }
+
+    Clock::time_point start = Clock::now();
+    cv_.wait_for(lock, std::chrono::microseconds(static_cast<int64_t>(delay_debt_micros_)),
+                 [this] { return shutdown_ || condition_ == WriteStallCondition::NORMAL; });
+    stats_.delayed_micros += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count());
+    delay_debt_micros_ = 0.0;
+}
+
+void WriteController::recordMemtableStop(uint64_t micros) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.memtable_stops++;
+    stats_.stopped_micros += micros;
+}
+
+void WriteController::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        shutdown_ = true;
+    }
+    cv_.notify_all();
+}
+
+WriteStallCondition WriteController::condition() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return condition_;
+}
+
+WriteStallStats WriteController::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    WriteStallStats stats = stats_;
+    stats.condition = condition_;
+    return stats;
+}
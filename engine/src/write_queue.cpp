@@ -1,98 +1,244 @@
 #include "write_queue.h"
+#include <algorithm>
+#include <thread>
 
-WriteQueue::WriteQueue(size_t max_size) : max_size_(max_size) {
+WriteQueue::WriteQueue(size_t max_size) : capacity_(std::max<size_t>(1, max_size)), slots_(std::make_unique<Slot[]>(capacity_)) {
+    for (size_t i = 0; i < capacity_; i++) {
+        slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
 }
 
 WriteQueue::~WriteQueue() {
     shutdown();
+    while (auto request = tryPop()) {
+        complete(std::move(request), false);
+    }
 }
 
-std::future<bool> WriteQueue::push(Operation op, const std::string &key, const std::string &value) {
-    auto request = std::make_unique<WriteRequest>(op, key, value);
-    std::future<bool> future = request->completion.get_future();
+void WriteWaiter::notify(bool ok) {
+    if (!ok) {
+        failed_.store(true, std::memory_order_relaxed);
+    }
+    const uint32_t previous = state_.fetch_sub(1 << PENDING_SHIFT);
+    // A waiter that never parked may return, and its frame go away, as soon as the count reaches zero; one that
+    // parked holds on until RELEASED, which is the last this thread touches of it
+    if ((previous >> PENDING_SHIFT) == 1 && (previous & PARKED)) {
+        state_.notify_all();
+        state_.fetch_or(RELEASED, std::memory_order_release);
+    }
+}
+
+bool WriteWaiter::wait() {
+    uint32_t state = state_.load();
+    while ((state >> PENDING_SHIFT) != 0) {
+        if (!(state & PARKED)) {
+            if (!state_.compare_exchange_weak(state, state | PARKED)) {
+                continue;
+            }
+            state |= PARKED;
+        }
+        state_.wait(state);
+        state = state_.load();
+    }
+    // Only waits out the few instructions between the waker's futex call and its release
+    if (state & PARKED) {
+        while (!(state_.load(std::memory_order_acquire) & RELEASED)) {
+            std::this_thread::yield();
+        }
+    }
+    return !failed_.load(std::memory_order_relaxed);
+}
 
-    {
-        std::unique_lock<std::mutex> lock(mutex_);
+void WriteQueue::complete(WriteRequestPtr request, bool ok, const Resumer &resume) {
+    WriteRequest *raw = request.get();
+    if (!raw->queue_owned) {
+        request.release();
+    }
 
-        not_full_cv_.wait(lock, [this] { return queue_.size() < max_size_ || shutdown_; });
+    if (raw->waiter) {
+        raw->waiter->notify(ok);
+    } else if (raw->completion) {
+        raw->completion->set_value(ok);
+    } else if (raw->callback) {
+        raw->callback(ok);
+    } else if (raw->coroutine) {
+        raw->coroutine_ok = ok;
+        const auto coroutine = raw->coroutine;
+        if (resume) {
+            resume(coroutine);
+        } else {
+            coroutine.resume();
+        }
+    }
+}
 
-        if (shutdown_) {
-            request->completion.set_value(false);
-            return future;
+// A slot at position pos is free for a producer when its sequence is pos, and holds a request for the consumer
+// when its sequence is pos + 1. Popping hands it to the producer one lap later by setting it to pos + capacity.
+bool WriteQueue::tryPush(WriteRequest *request) {
+    size_t pos = tail_.load(std::memory_order_relaxed);
+    Slot *slot;
+    while (true) {
+        slot = &slots_[pos % capacity_];
+        const size_t sequence = slot->sequence.load(std::memory_order_acquire);
+        const auto diff = static_cast<std::ptrdiff_t>(sequence - pos);
+        if (diff == 0) {
+            if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return false; // Full: the consumer has not freed this slot yet
+        } else {
+            pos = tail_.load(std::memory_order_relaxed);
         }
+    }
+
+    slot->request = request;
+    slot->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
 
-        queue_.push(std::move(request));
+WriteRequestPtr WriteQueue::tryPop() {
+    size_t pos = head_.load(std::memory_order_relaxed);
+    Slot *slot;
+    while (true) {
+        slot = &slots_[pos % capacity_];
+        const size_t sequence = slot->sequence.load(std::memory_order_acquire);
+        const auto diff = static_cast<std::ptrdiff_t>(sequence - (pos + 1));
+        if (diff == 0) {
+            if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return nullptr; // Empty: no producer has published this slot yet
+        } else {
+            pos = head_.load(std::memory_order_relaxed);
+        }
     }
 
-    not_empty_cv_.notify_one();
+    WriteRequestPtr request(slot->request);
+    slot->request = nullptr;
+    slot->sequence.store(pos + capacity_, std::memory_order_release);
+    return request;
+}
+
+std::future<bool> WriteQueue::push(Operation op, const std::string &key, const std::string &value) {
+    auto *request = new WriteRequest(op, key, value);
+    request->queue_owned = true;
+    std::future<bool> future = request->completion.emplace().get_future();
+    enqueue(request);
     return future;
 }
 
-std::optional<std::unique_ptr<WriteRequest>> WriteQueue::pop() {
-    std::unique_lock<std::mutex> lock(mutex_);
+void WriteQueue::push(Operation op, const std::string &key, const std::string &value, std::function<void(bool)> callback) {
+    auto *request = new WriteRequest(op, key, value);
+    request->queue_owned = true;
+    request->callback = std::move(callback);
+    enqueue(request);
+}
 
-    not_empty_cv_.wait(lock, [this] { return !queue_.empty() || shutdown_; });
+void WriteQueue::push(WriteRequest &request) {
+    enqueue(&request);
+}
 
-    if (queue_.empty()) {
-        return std::nullopt;
+void WriteQueue::enqueue(WriteRequest *request) {
+    if (shutdown_.load(std::memory_order_acquire)) {
+        complete(WriteRequestPtr(request), false);
+        return;
     }
 
-    auto request = std::move(queue_.front());
-    queue_.pop();
-
-    not_full_cv_.notify_one();
+    while (!tryPush(request)) {
+        // Register before the last check so a pop landing in between is either seen here or wakes us
+        producers_parked_.store(true);
+        const uint32_t pops = pops_.load();
+        if (shutdown_.load()) {
+            complete(WriteRequestPtr(request), false);
+            return;
+        }
+        if (tryPush(request)) {
+            break;
+        }
+        pops_.wait(pops);
+    }
 
-    return request;
+    pushes_.fetch_add(1);
+    if (consumer_parked_.load() && consumer_parked_.exchange(false)) {
+        pushes_.notify_all();
+    }
 }
 
-std::vector<std::unique_ptr<WriteRequest>> WriteQueue::popBatch(size_t max_batch_size) {
-    std::vector<std::unique_ptr<WriteRequest>> batch;
-
-    std::unique_lock<std::mutex> lock(mutex_);
+WriteRequestPtr WriteQueue::waitPop() {
+    while (true) {
+        if (auto request = tryPop()) {
+            return request;
+        }
+        if (shutdown_.load(std::memory_order_acquire)) {
+            // Drain whatever was published before shutdown
+            return tryPop();
+        }
 
-    not_empty_cv_.wait(lock, [this] { return !queue_.empty() || shutdown_; });
+        consumer_parked_.store(true);
+        const uint32_t pushes = pushes_.load();
+        if (auto request = tryPop()) {
+            return request;
+        }
+        if (!shutdown_.load()) {
+            pushes_.wait(pushes);
+        }
+    }
+}
 
-    if (queue_.empty()) {
-        return batch;
+std::optional<WriteRequestPtr> WriteQueue::pop() {
+    auto request = waitPop();
+    if (!request) {
+        return std::nullopt;
     }
 
-    if (queue_.size() < max_batch_size / 10) {
-        lock.unlock();
-        std::this_thread::yield();
-        lock.lock();
+    pops_.fetch_add(1);
+    if (producers_parked_.load() && producers_parked_.exchange(false)) {
+        pops_.notify_all();
     }
+    return request;
+}
 
-    batch.reserve(std::min(queue_.size(), max_batch_size));
+std::vector<WriteRequestPtr> WriteQueue::popBatch(size_t max_batch_size) {
+    std::vector<WriteRequestPtr> batch;
 
-    while (!queue_.empty() && batch.size() < max_batch_size) {
-        batch.push_back(std::move(queue_.front()));
-        queue_.pop();
+    auto first = waitPop();
+    if (!first) {
+        return batch;
     }
 
-    if (batch.size() > 1) {
-        not_full_cv_.notify_all();
-    } else {
-        not_full_cv_.notify_one();
+    batch.reserve(std::min(size() + 1, max_batch_size));
+    batch.push_back(std::move(first));
+    while (batch.size() < max_batch_size) {
+        auto request = tryPop();
+        if (!request) {
+            break;
+        }
+        batch.push_back(std::move(request));
     }
 
+    pops_.fetch_add(1);
+    if (producers_parked_.load() && producers_parked_.exchange(false)) {
+        pops_.notify_all();
+    }
     return batch;
 }
 
 void WriteQueue::shutdown() {
-    {
-        std::lock_guard<std::mutex> lock(mutex_);
-        shutdown_ = true;
-    }
-    not_empty_cv_.notify_all();
-    not_full_cv_.notify_all();
+    shutdown_.store(true, std::memory_order_release);
+    pushes_.fetch_add(1);
+    pushes_.notify_all();
+    pops_.fetch_add(1);
+    pops_.notify_all();
 }
 
 bool WriteQueue::isShutdown() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return shutdown_;
+    return shutdown_.load(std::memory_order_acquire);
 }
 
 size_t WriteQueue::size() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return queue_.size();
+    const size_t head = head_.load(std::memory_order_acquire);
+    const size_t tail = tail_.load(std::memory_order_acquire);
+    return tail > head ? tail - head : 0;
 }
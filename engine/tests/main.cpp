@@ -5,9 +5,18 @@ void run_memtable_tests(TestFramework &framework);
 void run_wal_tests(TestFramework &framework);
 void run_bloom_filter_tests(TestFramework &framework);
 void run_sstable_tests(TestFramework &framework);
-void run_lru_cache_tests(TestFramework &framework);
+void run_row_cache_tests(TestFramework &framework);
+void run_frequency_sketch_tests(TestFramework &framework);
 void run_table_version_tests(TestFramework &framework);
 void run_write_queue_tests(TestFramework &framework);
+void run_block_tests(TestFramework &framework);
+void run_compression_tests(TestFramework &framework);
+void run_block_cache_tests(TestFramework &framework);
+void run_blob_store_tests(TestFramework &framework);
+void run_worker_pool_tests(TestFramework &framework);
+void run_rate_limiter_tests(TestFramework &framework);
+void run_write_controller_tests(TestFramework &framework);
+void run_transaction_tests(TestFramework &framework);
 
 int main() {
     TestFramework framework("All tests");
@@ -17,9 +26,18 @@ int main() {
     run_wal_tests(framework);
     run_bloom_filter_tests(framework);
     run_sstable_tests(framework);
-    run_lru_cache_tests(framework);
+    run_row_cache_tests(framework);
+    run_frequency_sketch_tests(framework);
     run_table_version_tests(framework);
     run_write_queue_tests(framework);
+    run_block_tests(framework);
+    run_compression_tests(framework);
+    run_block_cache_tests(framework);
+    run_blob_store_tests(framework);
+    run_worker_pool_tests(framework);
+    run_rate_limiter_tests(framework);
+    run_write_controller_tests(framework);
+    run_transaction_tests(framework);
 
     framework.printSummary();
     return framework.exitCode();
@@ -0,0 +1,148 @@
+#include "blob_store.h"
+#include "test_framework.h"
+#include <filesystem>
+#include <string>
+
+class BlobStoreTest {
+  public:
+    BlobStoreTest() {
+        setUp();
+    }
+
+    void setUp() {
+        test_dir_ = "./test_blobs";
+        tearDown();
+        std::filesystem::create_directories(test_dir_);
+    }
+
+    void tearDown() {
+        if (std::filesystem::exists(test_dir_)) {
+            std::filesystem::remove_all(test_dir_);
+        }
+    }
+
+    ~BlobStoreTest() {
+        tearDown();
+    }
+
+    const std::string &getTestDir() const {
+        return test_dir_;
+    }
+
+    size_t blobFileCount() const {
+        size_t count = 0;
+        for (const auto &entry : std::filesystem::directory_iterator(test_dir_)) {
+            if (entry.path().extension() == ".blob") {
+                count++;
+            }
+        }
+        return count;
+    }
+
+  private:
+    std::string test_dir_;
+};
+
+bool test_blob_handle_encoding(BlobStoreTest &fixture) {
+    fixture.setUp();
+
+    BlobHandle handle{42, 1ULL << 40, 65536};
+    BlobHandle decoded{};
+    ASSERT_TRUE(BlobHandle::decode(handle.encode(), decoded), "Handle should decode");
+    ASSERT_EQ(decoded.file_number, 42u, "File number should round trip");
+    ASSERT_EQ(decoded.offset, 1ULL << 40, "Offset should round trip");
+    ASSERT_EQ(decoded.size, 65536u, "Size should round trip");
+
+    ASSERT_TRUE(!BlobHandle::decode("", decoded), "Empty input should not decode");
+    ASSERT_TRUE(!BlobHandle::decode(handle.encode() + "x", decoded), "Trailing bytes should not decode");
+
+    return true;
+}
+
+bool test_blob_add_and_read(BlobStoreTest &fixture) {
+    fixture.setUp();
+    BlobStore store(fixture.getTestDir());
+
+    std::string big(8192, 'a');
+    BlobHandle h1 = store.add("key1", big);
+    BlobHandle h2 = store.add("key2", "second value");
+    store.sync();
+
+    ASSERT_EQ(store.read(h1), big, "First blob should read back");
+    ASSERT_EQ(store.read(h2), "second value", "Second blob should read back");
+    ASSERT_EQ(h1.file_number, h2.file_number, "Blobs should share the active file");
+
+    return true;
+}
+
+bool test_blob_file_rollover(BlobStoreTest &fixture) {
+    fixture.setUp();
+    BlobStore store(fixture.getTestDir(), 1024);
+
+    BlobHandle first = store.add("k1", std::string(2000, 'x'));
+    BlobHandle second = store.add("k2", std::string(10, 'y'));
+    store.sync();
+
+    ASSERT_TRUE(second.file_number > first.file_number, "Full file should be sealed and a new one started");
+    ASSERT_EQ(store.read(first), std::string(2000, 'x'), "Sealed file should stay readable");
+    ASSERT_EQ(fixture.blobFileCount(), 2u, "Two blob files should exist");
+
+    return true;
+}
+
+bool test_blob_discard_deletes_sealed_file(BlobStoreTest &fixture) {
+    fixture.setUp();
+    BlobStore store(fixture.getTestDir(), 1024, 0.5);
+
+    BlobHandle a = store.add("a", std::string(600, 'a'));
+    BlobHandle b = store.add("b", std::string(600, 'b'));
+    store.add("c", std::string(10, 'c'));
+    store.sync();
+
+    ASSERT_TRUE(!store.shouldRelocate(a.file_number), "Live file should not be relocated");
+
+    store.discard(a);
+    ASSERT_TRUE(store.shouldRelocate(a.file_number), "Half-garbage sealed file should be relocated");
+    ASSERT_EQ(store.stats().at(a.file_number).discarded_bytes, 600u, "Discard should be counted");
+
+    store.discard(b);
+    ASSERT_TRUE(!store.stats().contains(a.file_number), "Fully discarded file should be dropped");
+    ASSERT_EQ(fixture.blobFileCount(), 1u, "Fully discarded file should be deleted");
+
+    return true;
+}
+
+bool test_blob_stats_persist(BlobStoreTest &fixture) {
+    fixture.setUp();
+    BlobHandle handle{};
+    {
+        BlobStore store(fixture.getTestDir(), 1024);
+        handle = store.add("key", std::string(600, 'z'));
+        store.add("other", std::string(600, 'o'));
+        store.discard(handle);
+        store.saveStats();
+    }
+
+    BlobStore reopened(fixture.getTestDir(), 1024);
+    auto stats = reopened.stats();
+    ASSERT_TRUE(stats.contains(handle.file_number), "Stats should be reloaded");
+    ASSERT_EQ(stats.at(handle.file_number).discarded_bytes, 600u, "Discarded bytes should persist");
+
+    BlobHandle next = reopened.add("new", "value");
+    ASSERT_TRUE(next.file_number > handle.file_number, "Reopened store should write to a fresh file");
+
+    return true;
+}
+
+void run_blob_store_tests(TestFramework &framework) {
+    BlobStoreTest fixture;
+
+    std::cout << "Running Blob Store Tests" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    framework.run("test_blob_handle_encoding", [&]() { return test_blob_handle_encoding(fixture); });
+    framework.run("test_blob_add_and_read", [&]() { return test_blob_add_and_read(fixture); });
+    framework.run("test_blob_file_rollover", [&]() { return test_blob_file_rollover(fixture); });
+    framework.run("test_blob_discard_deletes_sealed_file", [&]() { return test_blob_discard_deletes_sealed_file(fixture); });
+    framework.run("test_blob_stats_persist", [&]() { return test_blob_stats_persist(fixture); });
+}
@@ -0,0 +1,186 @@
+#include "block.h"
+#include "test_framework.h"
+#include <string>
+#include <vector>
+
+class BlockTest {
+  public:
+    BlockTest() {
+        setUp();
+    }
+
+    static void setUp() {
+        // Tests build their own blocks as needed
+    }
+
+    static std::string makeKey(int i) {
+        std::string n = std::to_string(i);
+        return "user:" + std::string(7 - n.size(), '0') + n + ":profile";
+    }
+};
+
+bool test_block_roundtrip(BlockTest &fixture) {
+    fixture.setUp();
+    BlockBuilder builder(4);
+
+    for (int i = 0; i < 50; i++) {
+        builder.add(BlockTest::makeKey(i), "value" + std::to_string(i), i + 1, EntryType::PUT);
+    }
+
+    Block block(builder.finish());
+    ASSERT_EQ(block.numRestarts(), 13u, "One restart point every 4 entries");
+
+    Block::Iterator it(block);
+    int count = 0;
+    for (it.seekToFirst(); it.valid(); it.next()) {
+        ASSERT_EQ(it.entry().key, BlockTest::makeKey(count), "Keys should decode in order");
+        ASSERT_EQ(it.entry().value, "value" + std::to_string(count), "Values should decode in order");
+        ASSERT_EQ(it.entry().seq, static_cast<uint64_t>(count + 1), "Sequence numbers should round trip");
+        count++;
+    }
+    ASSERT_EQ(count, 50, "Iterator should visit every entry");
+
+    return true;
+}
+
+bool test_block_seek(BlockTest &fixture) {
+    fixture.setUp();
+    BlockBuilder builder(16);
+
+    for (int i = 0; i < 200; i += 2) {
+        builder.add(BlockTest::makeKey(i), "v", i, EntryType::PUT);
+    }
+
+    Block block(builder.finish());
+    Block::Iterator it(block);
+
+    it.seek(BlockTest::makeKey(100));
+    ASSERT_TRUE(it.valid(), "Seek to existing key should be valid");
+    ASSERT_EQ(it.entry().key, BlockTest::makeKey(100), "Seek should land on exact key");
+
+    it.seek(BlockTest::makeKey(101));
+    ASSERT_TRUE(it.valid(), "Seek between keys should be valid");
+    ASSERT_EQ(it.entry().key, BlockTest::makeKey(102), "Seek should land on next larger key");
+
+    it.seek("");
+    ASSERT_TRUE(it.valid(), "Seek before first key should be valid");
+    ASSERT_EQ(it.entry().key, BlockTest::makeKey(0), "Seek before first key should land on first key");
+
+    it.seek("zzz");
+    ASSERT_TRUE(!it.valid(), "Seek past last key should be invalid");
+
+    return true;
+}
+
+bool test_block_tombstones(BlockTest &fixture) {
+    fixture.setUp();
+    BlockBuilder builder;
+
+    builder.add("a", "1", 1, EntryType::PUT);
+    builder.add("b", "", 2, EntryType::DELETE);
+    builder.add("c", "3", 3, EntryType::PUT);
+
+    Block block(builder.finish());
+    Block::Iterator it(block);
+    it.seek("b");
+    ASSERT_TRUE(it.valid(), "Should find tombstone");
+    ASSERT_TRUE(it.entry().type == EntryType::DELETE, "Type should be DELETE");
+    ASSERT_EQ(it.entry().value, "", "Tombstone should have empty value");
+
+    return true;
+}
+
+bool test_block_expiry(BlockTest &fixture) {
+    fixture.setUp();
+    BlockBuilder builder;
+
+    builder.add("a", "1", 1, EntryType::PUT);
+    builder.add("b", "2", 2, EntryType::PUT, 1700000000000ULL);
+    builder.add("c", "3", 3, EntryType::BLOB_INDEX, 42);
+
+    Block block(builder.finish());
+    Block::Iterator it(block);
+    it.seekToFirst();
+    ASSERT_EQ(it.entry().expires_at_ms, 0u, "Entry without TTL should never expire");
+    it.next();
+    ASSERT_EQ(it.entry().expires_at_ms, 1700000000000ULL, "Expiry should round trip");
+    ASSERT_TRUE(it.entry().type == EntryType::PUT, "Expiry flag should not leak into the type");
+    ASSERT_EQ(it.entry().value, "2", "Value should follow the expiry");
+    it.next();
+    ASSERT_TRUE(it.entry().type == EntryType::BLOB_INDEX, "Type should survive alongside an expiry");
+    ASSERT_EQ(it.entry().expires_at_ms, 42u, "Expiry should round trip");
+    it.next();
+    ASSERT_TRUE(!it.valid(), "Block should hold three entries");
+
+    return true;
+}
+
+bool test_block_prefix_compression(BlockTest &fixture) {
+    fixture.setUp();
+    BlockBuilder compressed(16);
+    BlockBuilder uncompressed(1);
+
+    for (int i = 0; i < 100; i++) {
+        std::string key = BlockTest::makeKey(i);
+        compressed.add(key, "", i, EntryType::PUT);
+        uncompressed.add(key, "", i, EntryType::PUT);
+    }
+
+    size_t compressed_size = compressed.finish().size();
+    size_t uncompressed_size = uncompressed.finish().size();
+    ASSERT_TRUE(compressed_size * 3 < uncompressed_size * 2, "Shared prefixes should shrink the block");
+
+    return true;
+}
+
+bool test_block_builder_reset(BlockTest &fixture) {
+    fixture.setUp();
+    BlockBuilder builder;
+
+    ASSERT_TRUE(builder.empty(), "New builder should be empty");
+    builder.add("key", "value", 1, EntryType::PUT);
+    ASSERT_TRUE(!builder.empty(), "Builder should not be empty after add");
+
+    builder.finish();
+    ASSERT_TRUE(builder.empty(), "Builder should be empty after finish");
+
+    builder.add("other", "value", 2, EntryType::PUT);
+    Block block(builder.finish());
+    Block::Iterator it(block);
+    it.seekToFirst();
+    ASSERT_TRUE(it.valid(), "Reused builder should produce a valid block");
+    ASSERT_EQ(it.entry().key, "other", "Reused builder should not leak previous keys");
+
+    return true;
+}
+
+bool test_block_malformed(BlockTest &fixture) {
+    fixture.setUp();
+
+    Block empty("");
+    Block::Iterator it(empty);
+    it.seekToFirst();
+    ASSERT_TRUE(!it.valid(), "Empty block should not be iterable");
+
+    Block garbage(std::string("\xff\xff\xff\xff", 4));
+    Block::Iterator it2(garbage);
+    it2.seek("a");
+    ASSERT_TRUE(!it2.valid(), "Malformed block should not be iterable");
+
+    return true;
+}
+
+void run_block_tests(TestFramework &framework) {
+    BlockTest fixture;
+
+    std::cout << "Running Block Tests" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    framework.run("test_block_roundtrip", [&]() { return test_block_roundtrip(fixture); });
+    framework.run("test_block_seek", [&]() { return test_block_seek(fixture); });
+    framework.run("test_block_tombstones", [&]() { return test_block_tombstones(fixture); });
+    framework.run("test_block_expiry", [&]() { return test_block_expiry(fixture); });
+    framework.run("test_block_prefix_compression", [&]() { return test_block_prefix_compression(fixture); });
+    framework.run("test_block_builder_reset", [&]() { return test_block_builder_reset(fixture); });
+    framework.run("test_block_malformed", [&]() { return test_block_malformed(fixture); });
+}
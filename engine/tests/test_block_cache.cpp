@@ -0,0 +1,93 @@
+#include "block_cache.h"
+#include "test_framework.h"
+#include <memory>
+#include <string>
+
+class BlockCacheTest {
+  public:
+    BlockCacheTest() {
+        setUp();
+    }
+
+    static void setUp() {
+        // Tests create their own caches as needed
+    }
+
+    static std::shared_ptr<Block> makeBlock(size_t bytes) {
+        return std::make_shared<Block>(std::string(bytes, 'x'));
+    }
+};
+
+bool test_block_cache_put_and_get(BlockCacheTest &fixture) {
+    fixture.setUp();
+    BlockCache cache(1024);
+
+    auto block = BlockCacheTest::makeBlock(100);
+    cache.put(1, 0, block);
+
+    ASSERT_TRUE(cache.get(1, 0) == block, "Should return the cached block");
+    ASSERT_TRUE(cache.get(1, 100) == nullptr, "Different offset should miss");
+    ASSERT_TRUE(cache.get(2, 0) == nullptr, "Different table should miss");
+    ASSERT_EQ(cache.usage(), 100u, "Usage should be charged by block size");
+
+    return true;
+}
+
+bool test_block_cache_evicts_by_bytes(BlockCacheTest &fixture) {
+    fixture.setUp();
+    BlockCache cache(300);
+
+    cache.put(1, 0, BlockCacheTest::makeBlock(100));
+    cache.put(1, 100, BlockCacheTest::makeBlock(100));
+    cache.put(1, 200, BlockCacheTest::makeBlock(100));
+
+    // Touch the oldest entry so the middle one becomes LRU
+    ASSERT_TRUE(cache.get(1, 0) != nullptr, "First block should still be cached");
+
+    cache.put(1, 300, BlockCacheTest::makeBlock(100));
+
+    ASSERT_TRUE(cache.get(1, 100) == nullptr, "LRU block should be evicted");
+    ASSERT_TRUE(cache.get(1, 0) != nullptr, "Recently used block should survive");
+    ASSERT_TRUE(cache.usage() <= 300, "Usage should stay within capacity");
+
+    return true;
+}
+
+bool test_block_cache_rejects_oversized(BlockCacheTest &fixture) {
+    fixture.setUp();
+    BlockCache cache(100);
+
+    cache.put(1, 0, BlockCacheTest::makeBlock(50));
+    cache.put(1, 50, BlockCacheTest::makeBlock(500));
+
+    ASSERT_TRUE(cache.get(1, 50) == nullptr, "Block larger than capacity should not be cached");
+    ASSERT_TRUE(cache.get(1, 0) != nullptr, "Oversized insert should not evict other blocks");
+
+    return true;
+}
+
+bool test_block_cache_clear(BlockCacheTest &fixture) {
+    fixture.setUp();
+    BlockCache cache(1024);
+
+    cache.put(1, 0, BlockCacheTest::makeBlock(10));
+    cache.put(2, 0, BlockCacheTest::makeBlock(10));
+    cache.clear();
+
+    ASSERT_EQ(cache.size(), 0u, "Cache should be empty after clear");
+    ASSERT_EQ(cache.usage(), 0u, "Usage should reset after clear");
+
+    return true;
+}
+
+void run_block_cache_tests(TestFramework &framework) {
+    BlockCacheTest fixture;
+
+    std::cout << "Running Block Cache Tests" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    framework.run("test_block_cache_put_and_get", [&]() { return test_block_cache_put_and_get(fixture); });
+    framework.run("test_block_cache_evicts_by_bytes", [&]() { return test_block_cache_evicts_by_bytes(fixture); });
+    framework.run("test_block_cache_rejects_oversized", [&]() { return test_block_cache_rejects_oversized(fixture); });
+    framework.run("test_block_cache_clear", [&]() { return test_block_cache_clear(fixture); });
+}
@@ -0,0 +1,140 @@
+#include "compression.h"
+#include "test_framework.h"
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+class CompressionTest {
+  public:
+    CompressionTest() {
+        setUp();
+    }
+
+    static void setUp() {
+        // Tests build their own payloads as needed
+    }
+
+    static std::string repetitiveJson(size_t records) {
+        std::string out;
+        for (size_t i = 0; i < records; i++) {
+            out += "{\"user\":" + std::to_string(i) + ",\"status\":\"active\",\"region\":\"us-east-1\"}";
+        }
+        return out;
+    }
+};
+
+bool test_zlib_roundtrip(CompressionTest &fixture) {
+    fixture.setUp();
+    std::string raw = CompressionTest::repetitiveJson(100);
+
+    std::string compressed;
+    ASSERT_TRUE(compressBlock(CompressionType::ZLIB, raw, compressed), "Repetitive data should compress");
+    ASSERT_TRUE(compressed.size() < raw.size() / 2, "Compressed data should be much smaller");
+
+    std::string restored = decompressBlock(CompressionType::ZLIB, compressed.data(), compressed.size());
+    ASSERT_EQ(restored, raw, "Decompressed data should match the original");
+
+    return true;
+}
+
+bool test_none_codec_is_passthrough(CompressionTest &fixture) {
+    fixture.setUp();
+    std::string raw = CompressionTest::repetitiveJson(10);
+
+    std::string compressed;
+    ASSERT_TRUE(!compressBlock(CompressionType::NONE, raw, compressed), "NONE codec should never compress");
+    ASSERT_TRUE(compressed.empty(), "Output should be untouched");
+    ASSERT_EQ(decompressBlock(CompressionType::NONE, raw.data(), raw.size()), raw, "NONE codec should copy input");
+
+    return true;
+}
+
+bool test_incompressible_data_rejected(CompressionTest &fixture) {
+    fixture.setUp();
+    std::string raw;
+    uint32_t state = 12345;
+    for (int i = 0; i < 4096; i++) {
+        state = state * 1103515245 + 12345;
+        raw.push_back(static_cast<char>(state >> 16));
+    }
+
+    std::string compressed;
+    ASSERT_TRUE(!compressBlock(CompressionType::ZLIB, raw, compressed), "Random data should be stored raw");
+
+    return true;
+}
+
+bool test_corrupted_block_throws(CompressionTest &fixture) {
+    fixture.setUp();
+    std::string raw = CompressionTest::repetitiveJson(50);
+    std::string compressed;
+    compressBlock(CompressionType::ZLIB, raw, compressed);
+    compressed[compressed.size() / 2] ^= 0x5a;
+
+    bool threw = false;
+    try {
+        decompressBlock(CompressionType::ZLIB, compressed.data(), compressed.size());
+    } catch (const std::runtime_error &) {
+        threw = true;
+    }
+    ASSERT_TRUE(threw, "Corrupted input should throw");
+
+    return true;
+}
+
+bool test_dictionary_roundtrip(CompressionTest &fixture) {
+    fixture.setUp();
+    std::vector<std::string> samples;
+    for (size_t i = 0; i < 500; i++) {
+        samples.push_back(CompressionTest::repetitiveJson(1) + std::to_string(i * 7919));
+    }
+
+    std::string dictionary = trainDictionary(samples, 4096);
+    ASSERT_TRUE(!dictionary.empty(), "Similar samples should produce a dictionary");
+    ASSERT_TRUE(dictionary.size() <= 4096, "Dictionary should respect the size limit");
+
+    std::string raw = CompressionTest::repetitiveJson(2);
+    std::string with_dict;
+    std::string without_dict;
+    ASSERT_TRUE(compressBlock(CompressionType::ZLIB, raw, with_dict, dictionary), "Should compress with dictionary");
+    bool plain_compressed = compressBlock(CompressionType::ZLIB, raw, without_dict);
+    ASSERT_TRUE(!plain_compressed || with_dict.size() < without_dict.size(), "Dictionary should improve small-value compression");
+
+    std::string restored = decompressBlock(CompressionType::ZLIB, with_dict.data(), with_dict.size(), dictionary);
+    ASSERT_EQ(restored, raw, "Decompressing with the dictionary should restore the input");
+
+    bool threw = false;
+    try {
+        decompressBlock(CompressionType::ZLIB, with_dict.data(), with_dict.size());
+    } catch (const std::runtime_error &) {
+        threw = true;
+    }
+    ASSERT_TRUE(threw, "Decompressing without the dictionary should fail");
+
+    return true;
+}
+
+bool test_dictionary_ignores_unique_content(CompressionTest &fixture) {
+    fixture.setUp();
+    std::vector<std::string> samples = {"alpha-unique-content", "bravo-different-bytes", "charlie-nothing-shared"};
+
+    ASSERT_EQ(trainDictionary(samples, 4096), "", "Samples with nothing in common should not produce a dictionary");
+    ASSERT_EQ(trainDictionary({}, 4096), "", "No samples should produce no dictionary");
+    ASSERT_EQ(trainDictionary(samples, 0), "", "Zero budget should produce no dictionary");
+
+    return true;
+}
+
+void run_compression_tests(TestFramework &framework) {
+    CompressionTest fixture;
+
+    std::cout << "Running Compression Tests" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    framework.run("test_zlib_roundtrip", [&]() { return test_zlib_roundtrip(fixture); });
+    framework.run("test_none_codec_is_passthrough", [&]() { return test_none_codec_is_passthrough(fixture); });
+    framework.run("test_incompressible_data_rejected", [&]() { return test_incompressible_data_rejected(fixture); });
+    framework.run("test_corrupted_block_throws", [&]() { return test_corrupted_block_throws(fixture); });
+    framework.run("test_dictionary_roundtrip", [&]() { return test_dictionary_roundtrip(fixture); });
+    framework.run("test_dictionary_ignores_unique_content", [&]() { return test_dictionary_ignores_unique_content(fixture); });
+}
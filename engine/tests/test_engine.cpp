@@ -1,9 +1,16 @@
 #include "engine.h"
 #include "test_framework.h"
+#include <atomic>
 #include <filesystem>
+#include <chrono>
+#include <coroutine>
+#include <fstream>
 #include <functional>
 #include <iostream>
+#include <map>
+#include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
 class StorageEngineTest {
@@ -101,6 +108,23 @@ bool test_delete_nonexistent_key(StorageEngineTest &fixture) {
     return true;
 }
 
+bool test_blind_delete(StorageEngineTest &fixture) {
+    fixture.setUp();
+    auto &engine = fixture.getEngine();
+
+    engine.put("key1", "value1");
+    engine.flush();
+
+    ASSERT_TRUE(engine.blindDel("key1"), "Blind delete should write the tombstone");
+    ASSERT_TRUE(engine.blindDel("nonexistent"), "Blind delete cannot tell a missing key apart");
+
+    Entry out;
+    ASSERT_TRUE(!engine.get("key1", out), "Blindly deleted key should be gone");
+    ASSERT_TRUE(!engine.del("key1"), "Checked delete should still report the key as missing");
+
+    return true;
+}
+
 // Sequence number tests
 bool test_sequence_numbers_memtable_priority(StorageEngineTest &fixture) {
     fixture.setUp();
@@ -200,7 +224,82 @@ bool test_recovery_with_updates(StorageEngineTest &fixture) {
     return true;
 }
 
+// Writes in the WAL but not yet in the memtable when flush() runs must survive the log being swapped out
+bool test_flush_during_writes_recovered(StorageEngineTest &fixture) {
+    fixture.tearDown();
+    const std::string dir = "data_flush_recovery";
+    std::filesystem::remove_all(dir);
+
+    const int num_threads = 4;
+    const int per_thread = 300;
+    {
+        StorageEngine engine(dir);
+        std::atomic<bool> flushed{false};
+        std::vector<std::thread> writers;
+        for (int t = 0; t < num_threads; t++) {
+            writers.emplace_back([&engine, &flushed, t]() {
+                // Keep writing past the last flush, so some writes are only in the log it left behind
+                for (int i = 0; i < per_thread || !flushed.load(); i++) {
+                    engine.put("t" + std::to_string(t) + "_" + std::to_string(i % per_thread), std::to_string(i % per_thread));
+                }
+            });
+        }
+        for (int i = 0; i < 5; i++) {
+            engine.flush();
+        }
+        flushed.store(true);
+        for (auto &writer : writers) {
+            writer.join();
+        }
+    }
+
+    {
+        StorageEngine engine(dir);
+        for (int t = 0; t < num_threads; t++) {
+            for (int i = 0; i < per_thread; i++) {
+                Entry out;
+                const std::string key = "t" + std::to_string(t) + "_" + std::to_string(i);
+                ASSERT_TRUE(engine.get(key, out), "Acknowledged write should survive a concurrent flush: " + key);
+                ASSERT_EQ(out.value, std::to_string(i), "Recovered value should match");
+            }
+        }
+    }
+
+    std::filesystem::remove_all(dir);
+    return true;
+}
+
 // Flush and SSTable tests
+bool test_recovery_removes_unlisted_sstables(StorageEngineTest &fixture) {
+    fixture.tearDown();
+    const std::string dir = "data_unlisted_sstables";
+    std::filesystem::remove_all(dir);
+
+    {
+        StorageEngine engine(dir);
+        engine.put("key", "value");
+        engine.flush();
+    }
+    // Left behind by a crash: a table no metadata lists, next to an unrelated file
+    const std::string stray = dir + "/sstables/sstable_999999.bin";
+    const std::string unrelated = dir + "/sstables/notes.txt";
+    std::ofstream(stray) << "stray";
+    std::ofstream(unrelated) << "keep";
+
+    {
+        StorageEngine engine(dir);
+        ASSERT_TRUE(!std::filesystem::exists(stray), "Unlisted SSTable should be removed on recovery");
+        ASSERT_TRUE(std::filesystem::exists(unrelated), "Files that are not SSTables should be left alone");
+
+        Entry out;
+        ASSERT_TRUE(engine.get("key", out), "Listed SSTable should still be readable");
+        ASSERT_EQ(out.value, "value", "Recovered value should match");
+    }
+
+    std::filesystem::remove_all(dir);
+    return true;
+}
+
 bool test_flush_creates_sstable(StorageEngineTest &fixture) {
     fixture.setUp();
     auto &engine = fixture.getEngine();
@@ -447,43 +546,1601 @@ bool test_persistence_across_restarts(StorageEngineTest &fixture) {
     return true;
 }
 
-// run tests
-void run_storage_engine_tests(TestFramework &framework) {
-    StorageEngineTest fixture;
-    std::cout << "Running Storage Engine Tests" << std::endl;
-    std::cout << "========================================" << std::endl;
-    framework.run("test_simple_put_and_get", [&]() { return test_simple_put_and_get(fixture); });
-    framework.run("test_update_existing_key", [&]() { return test_update_existing_key(fixture); });
-    framework.run("test_get_nonexistent_key", [&]() { return test_get_nonexistent_key(fixture); });
-    framework.run("test_simple_delete", [&]() { return test_simple_delete(fixture); });
-    framework.run("test_delete_nonexistent_key", [&]() { return test_delete_nonexistent_key(fixture); });
+// Compression tests
+bool test_compressed_levels_readable(StorageEngineTest &fixture) {
+    fixture.tearDown();
+    const std::string dir = "data_compression";
+    std::filesystem::remove_all(dir);
 
-    framework.run("test_sequence_numbers_memtable_priority", [&]() { return test_sequence_numbers_memtable_priority(fixture); });
-    framework.run("test_delete_then_put_sequence", [&]() { return test_delete_then_put_sequence(fixture); });
-    framework.run("test_multiple_sstables_newest_wins", [&]() { return test_multiple_sstables_newest_wins(fixture); });
+    EngineOptions options;
+    options.compression_per_level = {CompressionType::ZLIB};
+    options.block_cache_bytes = 64 * 1024;
 
-    framework.run("test_recovery_from_wal", [&]() { return test_recovery_from_wal(fixture); });
-    framework.run("test_recovery_with_updates", [&]() { return test_recovery_with_updates(fixture); });
+    {
+        StorageEngine engine(dir, options);
+        for (int round = 0; round < 4; round++) {
+            for (int i = 0; i < 200; i++) {
+                engine.put("key" + std::to_string(i), "{\"round\":" + std::to_string(round) + ",\"payload\":\"aaaaaaaaaaaaaaaa\"}");
+            }
+            engine.flush();
+        }
+        engine.waitForCompaction();
+    }
 
-    framework.run("test_flush_creates_sstable", [&]() { return test_flush_creates_sstable(fixture); });
-    framework.run("test_read_from_sstable_after_flush", [&]() { return test_read_from_sstable_after_flush(fixture); });
+    {
+        StorageEngine engine(dir, options);
+        for (int i = 0; i < 200; i++) {
+            Entry result;
+            ASSERT_TRUE(engine.get("key" + std::to_string(i), result), "Key should be readable from compressed SSTables");
+            ASSERT_EQ(result.value, "{\"round\":3,\"payload\":\"aaaaaaaaaaaaaaaa\"}", "Latest value should win");
+        }
+    }
 
-    framework.run("test_compaction_merges_sstables", [&]() { return test_compaction_merges_sstables(fixture); });
-    framework.run("test_compaction_removes_tombstones", [&]() { return test_compaction_removes_tombstones(fixture); });
-    framework.run("test_compaction_keeps_latest_version", [&]() { return test_compaction_keeps_latest_version(fixture); });
+    std::filesystem::remove_all(dir);
+    return true;
+}
 
-    framework.run("test_bloom_filter_negative_lookup", [&]() { return test_bloom_filter_negative_lookup(fixture); });
+// Blob separation tests
+bool test_large_values_separated_into_blobs(StorageEngineTest &fixture) {
+    fixture.tearDown();
+    const std::string dir = "data_blobs";
+    std::filesystem::remove_all(dir);
 
-    framework.run("test_large_dataset_with_index", [&]() { return test_large_dataset_with_index(fixture); });
+    EngineOptions options;
+    options.blob_value_threshold = 1024;
 
-    framework.run("test_many_operations", [&]() { return test_many_operations(fixture); });
-    framework.run("test_mixed_operations", [&]() { return test_mixed_operations(fixture); });
+    const std::string large(4096, 'L');
+    {
+        StorageEngine engine(dir, options);
+        engine.put("large", large);
+        engine.put("small", "inline");
+        engine.flush();
+        engine.waitForCompaction();
 
-    framework.run("test_empty_key", [&]() { return test_empty_key(fixture); });
-    framework.run("test_empty_value", [&]() { return test_empty_value(fixture); });
-    framework.run("test_large_value", [&]() { return test_large_value(fixture); });
+        Entry result;
+        ASSERT_TRUE(engine.get("large", result), "Large value should be readable");
+        ASSERT_EQ(result.value, large, "Large value should come back from the blob file");
+        ASSERT_TRUE(result.type == EntryType::PUT, "Resolved blob should look like a PUT");
+    }
 
-    framework.run("test_persistence_across_restarts", [&]() { return test_persistence_across_restarts(fixture); });
+    bool has_blob = false;
+    for (const auto &entry : std::filesystem::directory_iterator(dir + "/blobs")) {
+        has_blob |= entry.path().extension() == ".blob";
+    }
+    ASSERT_TRUE(has_blob, "Large value should be written to a blob file");
+    ASSERT_TRUE(std::filesystem::file_size(dir + "/sstables/sstable_1.bin") < large.size(), "SSTable should only hold the handle");
+
+    {
+        StorageEngine engine(dir, options);
+        Entry result;
+        ASSERT_TRUE(engine.get("large", result), "Blob value should survive restart");
+        ASSERT_EQ(result.value, large, "Blob value should match after restart");
+        ASSERT_TRUE(engine.get("small", result), "Inline value should survive restart");
+        ASSERT_EQ(result.value, "inline", "Inline value should match");
+    }
+
+    std::filesystem::remove_all(dir);
+    return true;
+}
+
+bool test_blob_garbage_collected_by_compaction(StorageEngineTest &fixture) {
+    fixture.tearDown();
+    const std::string dir = "data_blob_gc";
+    std::filesystem::remove_all(dir);
+
+    EngineOptions options;
+    options.blob_value_threshold = 512;
+    options.blob_file_size = 4096;
+
+    {
+        StorageEngine engine(dir, options);
+        for (int round = 0; round < 4; round++) {
+            for (int i = 0; i < 8; i++) {
+                engine.put("key" + std::to_string(i), std::string(1024, static_cast<char>('a' + round)));
+            }
+            engine.flush();
+        }
+        engine.waitForCompaction();
+
+        for (int i = 0; i < 8; i++) {
+            Entry result;
+            ASSERT_TRUE(engine.get("key" + std::to_string(i), result), "Key should exist after compaction");
+            ASSERT_EQ(result.value, std::string(1024, 'd'), "Latest blob value should win");
+        }
+    }
+
+    size_t blob_bytes = 0;
+    for (const auto &entry : std::filesystem::directory_iterator(dir + "/blobs")) {
+        if (entry.path().extension() == ".blob") {
+            blob_bytes += entry.file_size();
+        }
+    }
+    ASSERT_TRUE(blob_bytes < 3 * 8 * 1024, "Overwritten blob files should be reclaimed");
+
+    std::filesystem::remove_all(dir);
+    return true;
+}
+
+// Subcompaction tests
+static std::vector<SSTableMeta> readLevel(const std::string &dir, uint32_t level) {
+    std::vector<SSTableMeta> metas;
+    std::ifstream levelFile(dir + "/levels.txt");
+    std::string line;
+    while (std::getline(levelFile, line)) {
+        std::istringstream iss(line);
+        SSTableMeta meta;
+        if (!(iss >> meta.id >> meta.level >> meta.minKey >> meta.maxKey >> meta.maxSeq >> meta.sizeBytes >> meta.numEntries >>
+              meta.numDeletions)) {
+            continue;
+        }
+        if (meta.level == level) {
+            metas.push_back(meta);
+        }
+    }
+    return metas;
+}
+
+bool test_subcompactions_split_output(StorageEngineTest &fixture) {
+    fixture.tearDown();
+
+    for (size_t max_subcompactions : {size_t{1}, size_t{4}}) {
+        const std::string dir = "data_subcompaction";
+        std::filesystem::remove_all(dir);
+
+        EngineOptions options;
+        options.row_cache_bytes = 0;
+        options.max_subcompactions = max_subcompactions;
+
+        {
+            StorageEngine engine(dir, options);
+            for (int round = 0; round < 4; round++) {
+                for (int i = 0; i < 2000; i++) {
+                    engine.put("key" + std::to_string(i), std::string(100, static_cast<char>('a' + round)));
+                }
+                engine.flush();
+            }
+            engine.waitForCompaction();
+
+            for (int i = 0; i < 2000; i += 37) {
+                Entry result;
+                ASSERT_TRUE(engine.get("key" + std::to_string(i), result), "Key should survive compaction");
+                ASSERT_EQ(result.value, std::string(100, 'd'), "Newest value should win");
+            }
+        }
+
+        auto outputs = readLevel(dir, options.num_levels - 1);
+        if (max_subcompactions == 1) {
+            ASSERT_EQ(outputs.size(), 1u, "Single-threaded compaction should write one file");
+        } else {
+            ASSERT_TRUE(outputs.size() > 1, "Subcompactions should write one file per shard");
+            for (size_t i = 1; i < outputs.size(); i++) {
+                ASSERT_TRUE(outputs[i - 1].maxKey < outputs[i].minKey, "Shard outputs should not overlap");
+            }
+        }
+        ASSERT_TRUE(readLevel(dir, 0).empty(), "All L0 files should be compacted in one version");
+
+        {
+            StorageEngine engine(dir, options);
+            Entry result;
+            ASSERT_TRUE(engine.get("key1999", result), "Key should survive restart");
+            ASSERT_EQ(result.value, std::string(100, 'd'), "Value should survive restart");
+        }
+
+        std::filesystem::remove_all(dir);
+    }
+
+    return true;
+}
+
+bool test_concurrent_compactions(StorageEngineTest &fixture) {
+    fixture.tearDown();
+    const std::string dir = "data_concurrent_compaction";
+    std::filesystem::remove_all(dir);
+
+    EngineOptions options;
+    options.row_cache_bytes = 0;
+    options.max_background_compactions = 4;
+
+    {
+        StorageEngine engine(dir, options);
+        for (int round = 0; round < 12; round++) {
+            for (int i = 0; i < 500; i++) {
+                engine.put("key" + std::to_string((i * 7 + round * 131) % 1500), "round" + std::to_string(round));
+            }
+            engine.flush();
+        }
+        // Shut down with compactions still queued or running
+    }
+
+    {
+        StorageEngine engine(dir, options);
+        engine.waitForCompaction();
+
+        std::map<std::string, std::string> expected;
+        for (int round = 0; round < 12; round++) {
+            for (int i = 0; i < 500; i++) {
+                expected["key" + std::to_string((i * 7 + round * 131) % 1500)] = "round" + std::to_string(round);
+            }
+        }
+        for (const auto &[key, value] : expected) {
+            Entry result;
+            ASSERT_TRUE(engine.get(key, result), "Key should survive concurrent compactions: " + key);
+            ASSERT_EQ(result.value, value, "Newest value should win for " + key);
+        }
+    }
+
+    for (uint32_t level = 1; level < options.num_levels; level++) {
+        auto files = readLevel(dir, level);
+        for (size_t i = 1; i < files.size(); i++) {
+            ASSERT_TRUE(files[i - 1].maxKey < files[i].minKey, "Files within a level should not overlap");
+        }
+    }
+
+    std::filesystem::remove_all(dir);
+    return true;
+}
+
+// Leveled compaction shape tests
+static uint64_t levelSize(const std::string &dir, uint32_t level) {
+    uint64_t bytes = 0;
+    for (const auto &meta : readLevel(dir, level)) {
+        bytes += meta.sizeBytes;
+    }
+    return bytes;
+}
+
+bool test_static_level_targets(StorageEngineTest &fixture) {
+    fixture.tearDown();
+    const std::string dir = "data_static_levels";
+    std::filesystem::remove_all(dir);
+
+    EngineOptions options;
+    options.row_cache_bytes = 0;
+    options.num_levels = 5;
+    options.dynamic_level_bytes = false;
+    options.max_bytes_for_level_base = 64 * 1024;
+    options.level_size_multiplier = 4;
+    options.level0_compaction_trigger = 2;
+    options.compression_per_level = {CompressionType::NONE};
+
+    {
+        StorageEngine engine(dir, options);
+        for (int round = 0; round < 8; round++) {
+            for (int i = 0; i < 1000; i++) {
+                engine.put("key" + std::to_string(round * 1000 + i), std::string(100, 'v'));
+            }
+            engine.flush();
+            engine.waitForCompaction();
+        }
+        engine.waitForCompaction();
+
+        Entry result;
+        ASSERT_TRUE(engine.get("key0", result), "Oldest key should be readable");
+        ASSERT_TRUE(engine.get("key7999", result), "Newest key should be readable");
+    }
+
+    uint64_t target = options.max_bytes_for_level_base;
+    for (uint32_t level = 1; level + 1 < options.num_levels; level++) {
+        ASSERT_TRUE(levelSize(dir, level) <= target, "Level " + std::to_string(level) + " should be within its target");
+        target *= 4;
+    }
+    ASSERT_TRUE(levelSize(dir, 2) > 0 || levelSize(dir, 3) > 0, "Data should flow past L1");
+
+    std::filesystem::remove_all(dir);
+    return true;
+}
+
+bool test_dynamic_level_targets(StorageEngineTest &fixture) {
+    fixture.tearDown();
+    const std::string dir = "data_dynamic_levels";
+    std::filesystem::remove_all(dir);
+
+    EngineOptions options;
+    options.row_cache_bytes = 0;
+    options.num_levels = 5;
+    options.max_bytes_for_level_base = 64 * 1024;
+    options.level0_compaction_trigger = 2;
+
+    {
+        StorageEngine engine(dir, options);
+        for (int round = 0; round < 2; round++) {
+            for (int i = 0; i < 200; i++) {
+                engine.put("key" + std::to_string(i), "round" + std::to_string(round));
+            }
+            engine.flush();
+        }
+        engine.waitForCompaction();
+
+        Entry result;
+        ASSERT_TRUE(engine.get("key42", result), "Key should be readable");
+        ASSERT_EQ(result.value, "round1", "Newest value should win");
+    }
+
+    // A tree smaller than the base size has a single used level: the bottom one
+    ASSERT_TRUE(readLevel(dir, 0).empty(), "L0 should be compacted");
+    for (uint32_t level = 1; level + 1 < options.num_levels; level++) {
+        ASSERT_TRUE(readLevel(dir, level).empty(), "Intermediate levels should be unused");
+    }
+    ASSERT_TRUE(!readLevel(dir, options.num_levels - 1).empty(), "L0 should compact into the bottom level");
+
+    std::filesystem::remove_all(dir);
+    return true;
+}
+
+// Compaction picking tests
+bool test_compaction_output_split_by_size(StorageEngineTest &fixture) {
+    fixture.tearDown();
+    const std::string dir = "data_output_split";
+    std::filesystem::remove_all(dir);
+
+    EngineOptions options;
+    options.row_cache_bytes = 0;
+    options.target_file_size = 64 * 1024;
+    options.max_subcompactions = 1;
+
+    {
+        StorageEngine engine(dir, options);
+        for (int round = 0; round < 4; round++) {
+            for (int i = 0; i < 1000; i++) {
+                engine.put("key" + std::to_string(round * 1000 + i), std::string(100, 'v'));
+            }
+            engine.flush();
+        }
+        engine.waitForCompaction();
+    }
+
+    auto files = readLevel(dir, options.num_levels - 1);
+    ASSERT_TRUE(files.size() >= 4, "Output should be cut into target-sized files");
+    for (size_t i = 1; i < files.size(); i++) {
+        ASSERT_TRUE(files[i - 1].maxKey < files[i].minKey, "Output files should not overlap");
+    }
+
+    std::filesystem::remove_all(dir);
+    return true;
+}
+
+bool test_compaction_pri_styles(StorageEngineTest &fixture) {
+    fixture.tearDown();
+
+    for (CompactionPri pri : {CompactionPri::ROUND_ROBIN, CompactionPri::MIN_OVERLAP, CompactionPri::OLDEST_SEQ_FIRST}) {
+        const std::string dir = "data_compaction_pri";
+        std::filesystem::remove_all(dir);
+
+        EngineOptions options;
+        options.row_cache_bytes = 0;
+        options.num_levels = 4;
+        options.dynamic_level_bytes = false;
+        options.max_bytes_for_level_base = 64 * 1024;
+        options.level_size_multiplier = 4;
+        options.level0_compaction_trigger = 2;
+        options.target_file_size = 16 * 1024;
+        options.compaction_pri = pri;
+        options.compression_per_level = {CompressionType::NONE};
+
+        std::map<std::string, std::string> expected;
+        StorageEngine engine(dir, options);
+        for (int round = 0; round < 10; round++) {
+            for (int i = 0; i < 500; i++) {
+                std::string key = "key" + std::to_string((i * 37 + round * 101) % 3000);
+                std::string value = "r" + std::to_string(round) + std::string(80, 'v');
+                engine.put(key, value);
+                expected[key] = value;
+            }
+            engine.flush();
+            engine.waitForCompaction();
+        }
+
+        for (const auto &[key, value] : expected) {
+            Entry result;
+            ASSERT_TRUE(engine.get(key, result), "Key should survive compaction: " + key);
+            ASSERT_EQ(result.value, value, "Newest value should win for " + key);
+        }
+
+        CompactionStats stats = engine.compactionStats();
+        ASSERT_TRUE(stats.compactions_completed > 0, "Compactions should have run");
+        ASSERT_TRUE(stats.compaction_bytes_read > 0, "Compaction input bytes should be counted");
+        ASSERT_TRUE(stats.writeAmplification() > 1.0, "Compaction should add to write amplification");
+    }
+
+    std::filesystem::remove_all("data_compaction_pri");
+    return true;
+}
+
+// Universal compaction tests
+static size_t sortedRunCount(const std::string &dir, uint32_t num_levels) {
+    size_t runs = readLevel(dir, 0).size();
+    for (uint32_t level = 1; level < num_levels; level++) {
+        runs += readLevel(dir, level).empty() ? 0 : 1;
+    }
+    return runs;
+}
+
+bool test_universal_compaction(StorageEngineTest &fixture) {
+    fixture.tearDown();
+    const std::string dir = "data_universal";
+    std::filesystem::remove_all(dir);
+
+    EngineOptions options;
+    options.row_cache_bytes = 0;
+    options.compaction_style = CompactionStyle::UNIVERSAL;
+    options.level0_compaction_trigger = 4;
+
+    std::map<std::string, std::string> expected;
+    {
+        StorageEngine engine(dir, options);
+        for (int round = 0; round < 20; round++) {
+            for (int i = 0; i < 300; i++) {
+                std::string key = "key" + std::to_string((i * 13 + round * 97) % 2000);
+                std::string value = "round" + std::to_string(round);
+                engine.put(key, value);
+                expected[key] = value;
+            }
+            engine.flush();
+            engine.waitForCompaction();
+        }
+
+        for (const auto &[key, value] : expected) {
+            Entry result;
+            ASSERT_TRUE(engine.get(key, result), "Key should survive universal compaction: " + key);
+            ASSERT_EQ(result.value, value, "Newest value should win for " + key);
+        }
+
+        ASSERT_TRUE(engine.compactionStats().compactions_completed > 0, "Universal compactions should have run");
+    }
+
+    ASSERT_TRUE(sortedRunCount(dir, options.num_levels) < options.level0_compaction_trigger, "Sorted runs should stay under the trigger");
+    for (uint32_t level = 1; level < options.num_levels; level++) {
+        auto files = readLevel(dir, level);
+        for (size_t i = 1; i < files.size(); i++) {
+            ASSERT_TRUE(files[i - 1].maxKey < files[i].minKey, "Each level should hold one sorted run");
+        }
+    }
+
+    std::filesystem::remove_all(dir);
+    return true;
+}
+
+bool test_universal_compaction_keeps_tombstones(StorageEngineTest &fixture) {
+    fixture.tearDown();
+    const std::string dir = "data_universal_tombstones";
+    std::filesystem::remove_all(dir);
+
+    EngineOptions options;
+    options.row_cache_bytes = 0;
+    options.compaction_style = CompactionStyle::UNIVERSAL;
+    options.level0_compaction_trigger = 3;
+    // Never merge everything, so deletes are compacted into runs above the old data
+    options.universal_max_size_amplification_percent = 1000000;
+
+    StorageEngine engine(dir, options);
+    for (int i = 0; i < 2000; i++) {
+        engine.put("key" + std::to_string(i), std::string(200, 'o'));
+    }
+    engine.flush();
+
+    for (int round = 0; round < 6; round++) {
+        engine.del("key" + std::to_string(round));
+        engine.put("filler" + std::to_string(round), "f");
+        engine.flush();
+        engine.waitForCompaction();
+    }
+
+    for (int round = 0; round < 6; round++) {
+        Entry result;
+        ASSERT_TRUE(!engine.get("key" + std::to_string(round), result), "Deleted key must not reappear");
+    }
+    Entry result;
+    ASSERT_TRUE(engine.get("key100", result), "Untouched key should remain");
+
+    std::filesystem::remove_all(dir);
+    return true;
+}
+
+bool test_rate_limited_compaction(StorageEngineTest &fixture) {
+    fixture.tearDown();
+    const std::string dir = "data_rate_limited";
+    std::filesystem::remove_all(dir);
+
+    EngineOptions options;
+    options.row_cache_bytes = 0;
+    options.rate_limit_bytes_per_sec = 4 * 1024 * 1024;
+
+    StorageEngine engine(dir, options);
+    for (int round = 0; round < 6; round++) {
+        for (int i = 0; i < 1000; i++) {
+            engine.put("key" + std::to_string(i), "round" + std::to_string(round) + std::string(100, 'v'));
+        }
+        engine.flush();
+    }
+    engine.waitForCompaction();
+
+    CompactionStats stats = engine.compactionStats();
+    ASSERT_EQ(stats.rate_limit_bytes_per_sec, options.rate_limit_bytes_per_sec, "Fixed budget should be in effect");
+    ASSERT_TRUE(stats.compactions_completed > 0, "Compaction should still make progress under the limit");
+
+    for (int i = 0; i < 1000; i++) {
+        Entry result;
+        ASSERT_TRUE(engine.get("key" + std::to_string(i), result), "Key should survive rate-limited compaction");
+        ASSERT_EQ(result.value, "round5" + std::string(100, 'v'), "Newest value should win");
+    }
+
+    std::filesystem::remove_all(dir);
+    return true;
+}
+
+bool test_rate_limiter_auto_tune(StorageEngineTest &fixture) {
+    fixture.tearDown();
+    const std::string dir = "data_rate_auto_tune";
+    std::filesystem::remove_all(dir);
+
+    EngineOptions options;
+    options.row_cache_bytes = 0;
+    options.rate_limit_bytes_per_sec = 100 * 1024 * 1024;
+    options.rate_limit_auto_tune = true;
+    options.rate_limit_auto_tune_pending_bytes = 64 * 1024;
+
+    StorageEngine engine(dir, options);
+    ASSERT_EQ(engine.compactionStats().rate_limit_bytes_per_sec, options.rate_limit_bytes_per_sec / 10,
+              "Idle engine should start at the lowest budget");
+
+    // Build up L0 past the trigger while compaction is held back
+    engine.pauseCompaction();
+    for (int round = 0; round < 5; round++) {
+        for (int i = 0; i < 500; i++) {
+            engine.put("key" + std::to_string(i), std::string(100, 'a' + round));
+        }
+        engine.flush();
+    }
+    engine.flush();
+
+    CompactionStats backlog = engine.compactionStats();
+    ASSERT_TRUE(backlog.pending_compaction_bytes >= options.rate_limit_auto_tune_pending_bytes, "L0 backlog should count as pending");
+    ASSERT_EQ(backlog.rate_limit_bytes_per_sec, options.rate_limit_bytes_per_sec, "Backlog should raise the budget to the full rate");
+
+    engine.resumeCompaction();
+    engine.waitForCompaction();
+
+    CompactionStats caughtUp = engine.compactionStats();
+    ASSERT_EQ(caughtUp.pending_compaction_bytes, 0u, "Nothing should be pending once compaction catches up");
+    ASSERT_EQ(caughtUp.rate_limit_bytes_per_sec, options.rate_limit_bytes_per_sec / 10, "Budget should drop back once caught up");
+
+    std::filesystem::remove_all(dir);
+    return true;
+}
+
+bool test_write_stall_on_l0_backlog(StorageEngineTest &fixture) {
+    fixture.tearDown();
+    const std::string dir = "data_write_stall";
+    std::filesystem::remove_all(dir);
+
+    EngineOptions options;
+    options.row_cache_bytes = 0;
+    options.level0_compaction_trigger = 2;
+    options.level0_slowdown_writes_trigger = 2;
+    options.level0_stop_writes_trigger = 3;
+
+    StorageEngine engine(dir, options);
+    engine.pauseCompaction();
+    for (int round = 0; round < 3; round++) {
+        engine.put("key" + std::to_string(round), "value");
+        engine.flush();
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (engine.writeStallStats().condition != WriteStallCondition::STOPPED && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_TRUE(engine.writeStallStats().condition == WriteStallCondition::STOPPED, "L0 at the stop trigger should stop writes");
+
+    std::future<bool> write = engine.putAsync("blocked", "value");
+    bool blocked = write.wait_for(std::chrono::milliseconds(100)) == std::future_status::timeout;
+
+    engine.resumeCompaction();
+    ASSERT_TRUE(write.wait_for(std::chrono::seconds(5)) == std::future_status::ready, "Write should resume after compaction");
+    ASSERT_TRUE(write.get(), "Stalled write should succeed");
+    ASSERT_TRUE(blocked, "Write should wait while L0 is over the stop trigger");
+
+    engine.waitForCompaction();
+    WriteStallStats stats = engine.writeStallStats();
+    ASSERT_TRUE(stats.l0_stops >= 1, "Stop should be counted against L0");
+    ASSERT_TRUE(stats.stopped_micros > 0, "Stop time should be recorded");
+    ASSERT_TRUE(stats.condition == WriteStallCondition::NORMAL, "Writes should flow normally once L0 is drained");
+
+    Entry result;
+    ASSERT_TRUE(engine.get("blocked", result), "Stalled write should be readable");
+
+    std::filesystem::remove_all(dir);
+    return true;
+}
+
+// Tombstone handling tests. Phase one settles data in the bottom level; phase two reopens with an L1 large
+// enough that nothing moves past it by size.
+static EngineOptions tombstoneTestOptions(uint64_t level_base) {
+    EngineOptions options;
+    options.row_cache_bytes = 0;
+    options.dynamic_level_bytes = false;
+    options.num_levels = 3;
+    options.level0_compaction_trigger = 1;
+    options.max_bytes_for_level_base = level_base;
+    return options;
+}
+
+static void settleInBottomLevel(const std::string &dir, int num_keys) {
+    StorageEngine engine(dir, tombstoneTestOptions(1024));
+    for (int i = 0; i < num_keys; i++) {
+        engine.put("key" + std::to_string(i), std::string(100, 'v'));
+    }
+    engine.flush();
+    engine.waitForCompaction();
+}
+
+bool test_tombstones_kept_above_older_data(StorageEngineTest &fixture) {
+    fixture.tearDown();
+    const std::string dir = "data_tombstones_kept";
+    std::filesystem::remove_all(dir);
+    settleInBottomLevel(dir, 500);
+    ASSERT_TRUE(!readLevel(dir, 2).empty(), "Phase one should leave data in the bottom level");
+
+    EngineOptions options = tombstoneTestOptions(64 * 1024 * 1024);
+    options.tombstone_compaction_ratio = 0.0;
+    {
+        StorageEngine engine(dir, options);
+        for (int i = 0; i < 10; i++) {
+            engine.del("key" + std::to_string(i));
+        }
+        engine.flush();
+        engine.waitForCompaction();
+
+        for (int i = 0; i < 10; i++) {
+            Entry result;
+            ASSERT_TRUE(!engine.get("key" + std::to_string(i), result), "Deleted key must not resurface from the bottom level");
+        }
+        Entry result;
+        ASSERT_TRUE(engine.get("key100", result), "Untouched key should remain");
+    }
+
+    auto l1 = readLevel(dir, 1);
+    ASSERT_EQ(l1.size(), 1u, "Deletes should have been compacted into L1");
+    ASSERT_EQ(l1[0].numDeletions, 10u, "Tombstones over older data must be kept");
+    ASSERT_EQ(l1[0].numEntries, 10u, "Entry count should be recorded");
+
+    std::filesystem::remove_all(dir);
+    return true;
+}
+
+bool test_tombstones_dropped_without_older_data(StorageEngineTest &fixture) {
+    fixture.tearDown();
+    const std::string dir = "data_tombstones_dropped";
+    std::filesystem::remove_all(dir);
+
+    EngineOptions options = tombstoneTestOptions(64 * 1024 * 1024);
+    {
+        StorageEngine engine(dir, options);
+        for (int i = 0; i < 100; i++) {
+            engine.put("key" + std::to_string(i), "value");
+        }
+        engine.flush();
+        engine.waitForCompaction();
+
+        for (int i = 0; i < 10; i++) {
+            engine.del("key" + std::to_string(i));
+        }
+        engine.flush();
+        engine.waitForCompaction();
+    }
+
+    // Nothing lies below L1, so the merge into it may discard the tombstones along with what they shadow
+    auto l1 = readLevel(dir, 1);
+    ASSERT_EQ(l1.size(), 1u, "Data should sit in L1");
+    ASSERT_EQ(l1[0].numDeletions, 0u, "Tombstones with nothing beneath them should be dropped");
+    ASSERT_EQ(l1[0].numEntries, 90u, "Deleted keys should be gone");
+
+    std::filesystem::remove_all(dir);
+    return true;
+}
+
+bool test_tombstone_density_triggers_compaction(StorageEngineTest &fixture) {
+    fixture.tearDown();
+    const std::string dir = "data_tombstone_density";
+    std::filesystem::remove_all(dir);
+    settleInBottomLevel(dir, 3000);
+    uint64_t bottomBefore = levelSize(dir, 2);
+
+    EngineOptions options = tombstoneTestOptions(64 * 1024 * 1024);
+    options.tombstone_compaction_min_entries = 100;
+    {
+        StorageEngine engine(dir, options);
+        for (int i = 0; i < 2000; i++) {
+            engine.del("key" + std::to_string(i));
+        }
+        engine.flush();
+        engine.waitForCompaction();
+
+        for (int i = 0; i < 3000; i++) {
+            Entry result;
+            ASSERT_EQ(engine.get("key" + std::to_string(i), result), i >= 2000, "Only undeleted keys should remain");
+        }
+    }
+
+    // L1 is far under target, so only the tombstone density can have pushed the deletes down
+    ASSERT_TRUE(readLevel(dir, 1).empty(), "Delete-heavy L1 file should be compacted into the bottom level");
+    ASSERT_TRUE(levelSize(dir, 2) * 2 < bottomBefore, "Deleted data should be reclaimed from the bottom level");
+    for (const auto &meta : readLevel(dir, 2)) {
+        ASSERT_EQ(meta.numDeletions, 0u, "Bottom level should hold no tombstones");
+    }
+
+    std::filesystem::remove_all(dir);
+    return true;
+}
+
+bool test_delete_range_hides_keys(StorageEngineTest &fixture) {
+    fixture.tearDown();
+    const std::string dir = "data_delete_range";
+    std::filesystem::remove_all(dir);
+    settleInBottomLevel(dir, 500);
+
+    // key1 and key10..key199 sort inside [key1, key2)
+    auto deleted = [](int i) { return std::to_string(i)[0] == '1'; };
+    auto checkKeys = [&](StorageEngine &engine, const std::string &stage) {
+        for (int i = 0; i < 500; i++) {
+            Entry result;
+            bool visible = engine.get("key" + std::to_string(i), result);
+            ASSERT_EQ(visible, !deleted(i) || i == 150, "Range delete visibility " + stage + " for key" + std::to_string(i));
+        }
+        return true;
+    };
+
+    {
+        StorageEngine engine(dir, tombstoneTestOptions(64 * 1024 * 1024));
+        ASSERT_TRUE(engine.deleteRange("key1", "key2"), "Range delete should succeed");
+        ASSERT_TRUE(!engine.deleteRange("key2", "key1"), "Empty range should be rejected");
+        engine.put("key150", "rewritten");
+        if (!checkKeys(engine, "in the memtable"))
+            return false;
+
+        engine.flush();
+        engine.waitForCompaction();
+        if (!checkKeys(engine, "after compaction"))
+            return false;
+    }
+
+    // The bottom level still holds the deleted keys, so the tombstone must have been carried into L1
+    ASSERT_TRUE(!readLevel(dir, 1).empty(), "Range tombstone should be compacted into L1");
+    {
+        StorageEngine engine(dir, tombstoneTestOptions(64 * 1024 * 1024));
+        if (!checkKeys(engine, "after reopening"))
+            return false;
+        Entry result;
+        ASSERT_TRUE(engine.get("key150", result) && result.value == "rewritten", "Write after the range delete should win");
+    }
+
+    std::filesystem::remove_all(dir);
+    return true;
+}
+
+bool test_delete_range_recovered_from_wal(StorageEngineTest &fixture) {
+    fixture.tearDown();
+    const std::string dir = "data_delete_range_wal";
+    std::filesystem::remove_all(dir);
+
+    {
+        StorageEngine engine(dir);
+        for (int i = 0; i < 10; i++) {
+            engine.put("key" + std::to_string(i), "value");
+        }
+        engine.flush();
+    }
+
+    {
+        StorageEngine engine(dir);
+        engine.deleteRange("key2", "key5");
+    }
+
+    {
+        StorageEngine engine(dir);
+        for (int i = 0; i < 10; i++) {
+            Entry result;
+            ASSERT_EQ(engine.get("key" + std::to_string(i), result), i < 2 || i >= 5, "Range delete should be replayed from the WAL");
+        }
+    }
+
+    std::filesystem::remove_all(dir);
+    return true;
+}
+
+bool test_delete_range_drops_covered_files(StorageEngineTest &fixture) {
+    fixture.tearDown();
+    const std::string dir = "data_delete_range_files";
+    std::filesystem::remove_all(dir);
+
+    EngineOptions options;
+    options.level0_compaction_trigger = 100;
+    {
+        StorageEngine engine(dir, options);
+        for (const std::string tenant : {"tenant1/", "tenant2/"}) {
+            for (int i = 0; i < 100; i++) {
+                engine.put(tenant + std::to_string(i), std::string(100, 'v'));
+            }
+            engine.flush();
+        }
+        engine.waitForCompaction();
+        ASSERT_EQ(readLevel(dir, 0).size(), 2u, "Each tenant should have its own L0 file");
+
+        engine.deleteRange("tenant1/", "tenant10");
+        engine.flush();
+        engine.waitForCompaction();
+
+        // The tenant1 file is dropped outright; only the tenant2 file and the tombstone are left
+        auto l0 = readLevel(dir, 0);
+        ASSERT_EQ(l0.size(), 2u, "File inside the deleted range should be dropped");
+        ASSERT_TRUE(std::all_of(l0.begin(), l0.end(), [](const SSTableMeta &m) { return m.numEntries == 0 || m.minKey >= "tenant2/"; }),
+                    "Remaining files should be the tombstone and the other tenant");
+        ASSERT_EQ(engine.compactionStats().compaction_bytes_written, 0u, "Purge should not rewrite any data");
+
+        for (int i = 0; i < 100; i++) {
+            Entry result;
+            ASSERT_TRUE(!engine.get("tenant1/" + std::to_string(i), result), "Purged tenant should be gone");
+            ASSERT_TRUE(engine.get("tenant2/" + std::to_string(i), result), "Other tenant should remain");
+        }
+    }
+
+    std::filesystem::remove_all(dir);
+    return true;
+}
+
+bool test_delete_range_drops_blob_values(StorageEngineTest &fixture) {
+    fixture.tearDown();
+    const std::string dir = "data_delete_range_blobs";
+    std::filesystem::remove_all(dir);
+
+    EngineOptions options;
+    options.level0_compaction_trigger = 100;
+    options.blob_value_threshold = 512;
+    options.blob_file_size = 4096;
+    auto blobBytes = [&dir] {
+        size_t bytes = 0;
+        for (const auto &entry : std::filesystem::directory_iterator(dir + "/blobs")) {
+            bytes += entry.path().extension() == ".blob" ? entry.file_size() : 0;
+        }
+        return bytes;
+    };
+    {
+        StorageEngine engine(dir, options);
+        for (int i = 0; i < 16; i++) {
+            engine.put("tenant1/" + std::to_string(i), std::string(1024, 'v'));
+        }
+        engine.flush();
+        engine.put("tenant2/0", "inline");
+        engine.flush();
+        engine.waitForCompaction();
+        ASSERT_TRUE(blobBytes() >= 16 * 1024, "Large values should be written to blob files");
+
+        engine.deleteRange("tenant1/", "tenant10");
+        engine.flush();
+        engine.waitForCompaction();
+
+        ASSERT_EQ(engine.compactionStats().compaction_bytes_written, 0u, "Purge should not rewrite any data");
+        ASSERT_TRUE(blobBytes() < 4096, "Blob files of the dropped file should be reclaimed");
+        Entry result;
+        ASSERT_TRUE(!engine.get("tenant1/0", result), "Purged tenant should be gone");
+        ASSERT_TRUE(engine.get("tenant2/0", result) && result.value == "inline", "Other tenant should remain");
+    }
+
+    std::filesystem::remove_all(dir);
+    return true;
+}
+
+bool test_ttl_expires_keys(StorageEngineTest &fixture) {
+    fixture.setUp();
+    auto &engine = fixture.getEngine();
+
+    engine.put("shadowed", "old");
+    engine.flush();
+    engine.put("shadowed", "new", std::chrono::milliseconds(100));
+    engine.put("short", "value", std::chrono::milliseconds(100));
+    engine.put("long", "value", std::chrono::hours(1));
+    engine.put("forever", "value");
+
+    Entry result;
+    ASSERT_TRUE(engine.get("short", result), "Key should be readable before it expires");
+    ASSERT_EQ(result.value, "value", "Value should be stored without its expiry");
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    ASSERT_TRUE(!engine.get("short", result), "Expired key should read as missing");
+    ASSERT_TRUE(!engine.get("shadowed", result), "Expired value must not uncover an older version");
+    ASSERT_TRUE(engine.get("long", result), "Key with a long TTL should remain");
+    ASSERT_TRUE(engine.get("forever", result), "Key without a TTL should remain");
+
+    engine.flush();
+    engine.waitForCompaction();
+    ASSERT_TRUE(!engine.get("short", result), "Expired key should stay missing after a flush");
+    ASSERT_TRUE(engine.get("long", result), "Expiry should survive the flush");
+
+    return true;
+}
+
+bool test_ttl_recovered_from_wal(StorageEngineTest &fixture) {
+    fixture.tearDown();
+    const std::string dir = "data_ttl_wal";
+    std::filesystem::remove_all(dir);
+
+    {
+        StorageEngine engine(dir);
+        engine.put("short", "value", std::chrono::milliseconds(100));
+        engine.put("long", "value", std::chrono::hours(1));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    {
+        StorageEngine engine(dir);
+        Entry result;
+        ASSERT_TRUE(!engine.get("short", result), "Expiry should be replayed from the WAL");
+        ASSERT_TRUE(engine.get("long", result), "Unexpired key should be replayed from the WAL");
+        ASSERT_EQ(result.value, "value", "Replayed value should not include the expiry");
+    }
+
+    std::filesystem::remove_all(dir);
+    return true;
+}
+
+bool test_expired_entries_dropped_by_compaction(StorageEngineTest &fixture) {
+    fixture.tearDown();
+    const std::string dir = "data_ttl_compaction";
+    std::filesystem::remove_all(dir);
+
+    {
+        StorageEngine engine(dir, tombstoneTestOptions(64 * 1024 * 1024));
+        for (int i = 0; i < 100; i++) {
+            engine.put("ttl" + std::to_string(i), "value", std::chrono::milliseconds(100));
+            engine.put("key" + std::to_string(i), "value");
+        }
+        engine.flush();
+        engine.waitForCompaction();
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+        engine.put("trigger", "value");
+        engine.flush();
+        engine.waitForCompaction();
+    }
+
+    // Nothing lies below L1, so the expired values go without leaving tombstones behind
+    auto l1 = readLevel(dir, 1);
+    ASSERT_EQ(l1.size(), 1u, "Data should sit in L1");
+    ASSERT_EQ(l1[0].numEntries, 101u, "Expired entries should be dropped by compaction");
+    ASSERT_EQ(l1[0].numDeletions, 0u, "Expiry should not write tombstones");
+
+    std::filesystem::remove_all(dir);
+    return true;
+}
+
+bool test_expired_files_dropped(StorageEngineTest &fixture) {
+    fixture.tearDown();
+    const std::string dir = "data_ttl_files";
+    std::filesystem::remove_all(dir);
+
+    EngineOptions options;
+    options.level0_compaction_trigger = 100;
+    {
+        StorageEngine engine(dir, options);
+        for (int i = 0; i < 100; i++) {
+            engine.put("key" + std::to_string(i), std::string(100, 'v'), std::chrono::milliseconds(300));
+        }
+        engine.flush();
+        engine.waitForCompaction();
+        ASSERT_EQ(readLevel(dir, 0).size(), 1u, "Flush should write one L0 file");
+
+        // No further writes: the compaction thread wakes up by itself once the file's last value expires
+        std::this_thread::sleep_for(std::chrono::milliseconds(600));
+        ASSERT_TRUE(readLevel(dir, 0).empty(), "Fully expired file should be dropped");
+        ASSERT_EQ(engine.compactionStats().compaction_bytes_read, 0u, "Expired file should be dropped without being read");
+    }
+
+    std::filesystem::remove_all(dir);
+    return true;
+}
+
+bool test_expired_files_release_blobs(StorageEngineTest &fixture) {
+    fixture.tearDown();
+    const std::string dir = "data_ttl_blobs";
+    std::filesystem::remove_all(dir);
+
+    EngineOptions options;
+    options.level0_compaction_trigger = 100;
+    options.blob_value_threshold = 512;
+    options.blob_file_size = 4096;
+    auto blobBytes = [&dir] {
+        size_t bytes = 0;
+        for (const auto &entry : std::filesystem::directory_iterator(dir + "/blobs")) {
+            bytes += entry.path().extension() == ".blob" ? entry.file_size() : 0;
+        }
+        return bytes;
+    };
+    {
+        StorageEngine engine(dir, options);
+        for (int i = 0; i < 16; i++) {
+            engine.put("key" + std::to_string(i), std::string(1024, 'v'), std::chrono::milliseconds(300));
+        }
+        engine.flush();
+        engine.waitForCompaction();
+        ASSERT_TRUE(blobBytes() >= 16 * 1024, "Large values should be written to blob files");
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(600));
+        ASSERT_TRUE(readLevel(dir, 0).empty(), "Fully expired file should be dropped");
+        ASSERT_TRUE(blobBytes() < 4096, "Blob files of the expired file should be reclaimed");
+    }
+
+    std::filesystem::remove_all(dir);
+    return true;
+}
+
+bool test_cache_written_through(StorageEngineTest &fixture) {
+    fixture.setUp();
+    auto &engine = fixture.getEngine();
+    Entry out;
+
+    engine.put("key1", "value1");
+    ASSERT_TRUE(engine.get("key1", out), "Key should be readable");
+    ASSERT_EQ(out.value, "value1", "Value should match");
+
+    engine.put("key1", "value2");
+    ASSERT_TRUE(engine.get("key1", out), "Key should be readable");
+    ASSERT_EQ(out.value, "value2", "Cache should hold the overwritten value");
+
+    engine.blindDel("key1");
+    ASSERT_TRUE(!engine.get("key1", out), "Cached delete should read as missing");
+
+    RowCacheStats stats = engine.rowCacheStats();
+    ASSERT_EQ(stats.hits, 3u, "Every read should be answered by the cache");
+    ASSERT_EQ(stats.misses, 0u, "Writes should fill the cache");
+
+    return true;
+}
+
+bool test_cache_survives_flush_and_compaction(StorageEngineTest &fixture) {
+    fixture.tearDown();
+    const std::string dir = "data_cache_flush";
+    std::filesystem::remove_all(dir);
+
+    EngineOptions options;
+    options.level0_compaction_trigger = 2;
+    {
+        StorageEngine engine(dir, options);
+        for (int round = 0; round < 3; round++) {
+            for (int i = 0; i < 100; i++) {
+                engine.put("key" + std::to_string(i), "value" + std::to_string(round));
+            }
+            engine.flush();
+        }
+        engine.waitForCompaction();
+        ASSERT_TRUE(engine.compactionStats().compactions_completed > 0, "Flushed files should have been compacted");
+
+        for (int i = 0; i < 100; i++) {
+            Entry out;
+            ASSERT_TRUE(engine.get("key" + std::to_string(i), out), "Key should be readable");
+            ASSERT_EQ(out.value, "value2", "Newest value should be read");
+        }
+        ASSERT_EQ(engine.rowCacheStats().misses, 0u, "Flush and compaction should leave the cache intact");
+    }
+
+    std::filesystem::remove_all(dir);
+    return true;
+}
+
+bool test_cache_delete_range(StorageEngineTest &fixture) {
+    fixture.setUp();
+    auto &engine = fixture.getEngine();
+    Entry out;
+
+    engine.put("a", "1");
+    engine.put("b", "2");
+    engine.put("c", "3");
+    engine.deleteRange("a", "c");
+
+    ASSERT_TRUE(!engine.get("a", out), "Cached key inside the range should be gone");
+    ASSERT_TRUE(!engine.get("b", out), "Cached key inside the range should be gone");
+    ASSERT_TRUE(engine.get("c", out), "Range end is exclusive");
+    ASSERT_EQ(engine.rowCacheStats().hits, 1u, "Key outside the range should stay cached");
+
+    return true;
+}
+
+bool test_negative_lookups_cached(StorageEngineTest &fixture) {
+    fixture.setUp();
+    auto &engine = fixture.getEngine();
+    Entry out;
+
+    engine.put("present", "value");
+    engine.flush();
+
+    ASSERT_TRUE(!engine.get("absent", out), "Absent key should be missing");
+    ASSERT_TRUE(!engine.get("absent", out), "Absent key should still be missing");
+    RowCacheStats stats = engine.rowCacheStats();
+    ASSERT_EQ(stats.misses, 1u, "Only the first lookup should reach the tables");
+    ASSERT_EQ(stats.hits, 1u, "Repeated miss should be answered by the cache");
+
+    engine.put("absent", "now here");
+    ASSERT_TRUE(engine.get("absent", out), "Write should replace the cached miss");
+    ASSERT_EQ(out.value, "now here", "Value should match");
+
+    return true;
+}
+
+bool test_negative_lookups_disabled(StorageEngineTest &fixture) {
+    fixture.tearDown();
+    const std::string dir = "data_negative_cache";
+    std::filesystem::remove_all(dir);
+
+    EngineOptions options;
+    options.row_cache_negative_lookups = false;
+    {
+        StorageEngine engine(dir, options);
+        Entry out;
+        ASSERT_TRUE(!engine.get("absent", out), "Absent key should be missing");
+        ASSERT_TRUE(!engine.get("absent", out), "Absent key should still be missing");
+        ASSERT_EQ(engine.rowCacheStats().misses, 2u, "Misses should not be cached");
+    }
+
+    std::filesystem::remove_all(dir);
+    return true;
+}
+
+bool test_pipelined_writes_from_many_threads(StorageEngineTest &fixture) {
+    fixture.setUp();
+    auto &engine = fixture.getEngine();
+
+    const int num_threads = 8;
+    const int writes_per_thread = 500;
+    std::atomic<int> failed{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; t++) {
+        threads.emplace_back([&engine, &failed, t]() {
+            for (int i = 0; i < writes_per_thread; i++) {
+                std::string key = "key_" + std::to_string(t) + "_" + std::to_string(i);
+                if (!engine.put(key, "v" + std::to_string(i))) {
+                    failed++;
+                }
+                // A completed write must already be readable
+                Entry out;
+                if (!engine.get(key, out) || out.value != "v" + std::to_string(i)) {
+                    failed++;
+                }
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    ASSERT_EQ(failed.load(), 0, "Every write should succeed and be visible once it returns");
+
+    return true;
+}
+
+bool test_write_batch(StorageEngineTest &fixture) {
+    fixture.setUp();
+    auto &engine = fixture.getEngine();
+
+    engine.put("b", "old");
+    engine.put("c", "old");
+
+    std::vector<BatchWrite> batch = {
+        {Operation::PUT, "a", "1"},
+        {Operation::DELETE, "b", ""},
+        {Operation::DELETE_RANGE, "c", "d"},
+        {Operation::PUT, "c2", "2"},
+    };
+    ASSERT_TRUE(engine.write(batch), "Every write of the batch should succeed");
+
+    Entry out;
+    ASSERT_TRUE(engine.get("a", out) && out.value == "1", "Batched put should be visible");
+    ASSERT_TRUE(!engine.get("b", out), "Batched delete should hide the key");
+    ASSERT_TRUE(!engine.get("c", out), "Batched range delete should hide the key");
+    ASSERT_TRUE(engine.get("c2", out) && out.value == "2", "Later write should land after the range delete");
+
+    // Writes are applied one by one, so an invalid write fails the batch without stopping the rest
+    std::vector<BatchWrite> invalid = {
+        {Operation::DELETE_RANGE, "z", "a"},
+        {Operation::PUT, "e", "3"},
+    };
+    ASSERT_TRUE(!engine.write(invalid), "Batch with an empty range should fail");
+    ASSERT_TRUE(engine.get("e", out) && out.value == "3", "Valid write of a failed batch should still be applied");
+    ASSERT_TRUE(engine.write({}), "Empty batch should succeed");
+
+    return true;
+}
+
+bool test_snapshot_reads(StorageEngineTest &fixture) {
+    fixture.setUp();
+    auto &engine = fixture.getEngine();
+
+    engine.put("a", "1");
+    engine.put("b", "1");
+    engine.put("c1", "1");
+    const Snapshot *snapshot = engine.getSnapshot();
+
+    engine.put("a", "2");
+    engine.put("a", "3");
+    engine.blindDel("b");
+    engine.deleteRange("c", "d");
+    engine.put("new", "1");
+
+    ReadOptions options{snapshot};
+    Entry out;
+    ASSERT_TRUE(engine.get(options, "a", out) && out.value == "1", "Snapshot should not see later overwrites");
+    ASSERT_TRUE(engine.get(options, "b", out) && out.value == "1", "Snapshot should not see a later delete");
+    ASSERT_TRUE(engine.get(options, "c1", out) && out.value == "1", "Snapshot should not see a later range delete");
+    ASSERT_TRUE(!engine.get(options, "new", out), "Snapshot should not see keys written after it");
+
+    ASSERT_TRUE(engine.get("a", out) && out.value == "3", "Latest read should see the newest value");
+    ASSERT_TRUE(!engine.get("b", out), "Latest read should see the delete");
+    ASSERT_TRUE(!engine.get("c1", out), "Latest read should see the range delete");
+    ASSERT_TRUE(engine.get(ReadOptions{}, "new", out), "Default read options should read the latest data");
+
+    engine.releaseSnapshot(snapshot);
+
+    return true;
+}
+
+bool test_snapshot_release_prunes_older_versions(StorageEngineTest &fixture) {
+    fixture.setUp();
+    auto &engine = fixture.getEngine();
+
+    engine.put("a", "1");
+    const Snapshot *first = engine.getSnapshot();
+    engine.put("a", "2");
+    const Snapshot *second = engine.getSnapshot();
+    engine.put("a", "3");
+    engine.flush();
+    engine.put("a", "4");
+
+    // Pruning what the first snapshot alone needed leaves the second one intact, before and after a flush
+    engine.releaseSnapshot(first);
+    Entry out;
+    ASSERT_TRUE(engine.get(ReadOptions{second}, "a", out) && out.value == "2", "Newer snapshot should keep its version");
+    engine.flush();
+    engine.waitForCompaction();
+    ASSERT_TRUE(engine.get(ReadOptions{second}, "a", out) && out.value == "2", "Flush should keep the snapshot's version");
+    engine.releaseSnapshot(second);
+    ASSERT_TRUE(engine.get("a", out) && out.value == "4", "Latest read should see the newest version");
+
+    return true;
+}
+
+bool test_snapshot_survives_flush_and_compaction(StorageEngineTest &fixture) {
+    fixture.setUp();
+    auto &engine = fixture.getEngine();
+
+    const int num_keys = 200;
+    for (int i = 0; i < num_keys; i++) {
+        engine.put("key" + std::to_string(i), "old");
+    }
+    engine.flush();
+    // Unflushed when the snapshot is taken, flushed while it lives
+    engine.put("mem", "old");
+    const Snapshot *snapshot = engine.getSnapshot();
+
+    for (int round = 0; round < 4; round++) {
+        for (int i = 0; i < num_keys; i++) {
+            engine.put("key" + std::to_string(i), "new" + std::to_string(round));
+        }
+        engine.put("mem", "new");
+        engine.flush();
+    }
+    engine.waitForCompaction();
+    ASSERT_TRUE(engine.compactionStats().compactions_completed > 0, "Overwrites should have been compacted");
+
+    ReadOptions options{snapshot};
+    for (int i = 0; i < num_keys; i++) {
+        Entry out;
+        ASSERT_TRUE(engine.get(options, "key" + std::to_string(i), out), "Snapshot should still find the key");
+        ASSERT_EQ(out.value, "old", "Snapshot should read the version compaction dropped");
+    }
+    Entry out;
+    ASSERT_TRUE(engine.get(options, "mem", out) && out.value == "old", "Snapshot should read the memtable flushed after it");
+    ASSERT_TRUE(engine.get("key0", out) && out.value == "new3", "Latest read should see the newest version");
+
+    const std::string first_file = "data/sstables/sstable_1.bin";
+    ASSERT_TRUE(std::filesystem::exists(first_file), "Compacted file should stay while the snapshot reads it");
+    engine.releaseSnapshot(snapshot);
+    ASSERT_TRUE(!std::filesystem::exists(first_file), "Compacted file should be removed with the last snapshot");
+
+    return true;
+}
+
+// Blocks until count completions have been signalled
+class Completions {
+  public:
+    void signal() {
+        done_.fetch_add(1);
+        done_.notify_all();
+    }
+
+    void waitFor(int count) {
+        for (int done = done_.load(); done < count; done = done_.load()) {
+            done_.wait(done);
+        }
+    }
+
+  private:
+    std::atomic<int> done_{0};
+};
+
+bool test_async_write_callbacks(StorageEngineTest &fixture) {
+    fixture.setUp();
+    auto &engine = fixture.getEngine();
+
+    const int num_writes = 500;
+    Completions completions;
+    std::atomic<int> failed{0};
+    for (int i = 0; i < num_writes; i++) {
+        engine.putAsync("key" + std::to_string(i), "v" + std::to_string(i), [&](bool ok) {
+            if (!ok) {
+                failed++;
+            }
+            completions.signal();
+        });
+    }
+    completions.waitFor(num_writes);
+    ASSERT_EQ(failed.load(), 0, "Every async write should succeed");
+
+    Entry out;
+    ASSERT_TRUE(engine.get("key499", out) && out.value == "v499", "Async write should be visible once its callback ran");
+
+    // Callbacks may chain further async writes, but a blocking write there would wait on its own thread
+    std::atomic<bool> blocking_ok{true};
+    std::atomic<bool> chained_ok{false};
+    engine.delAsync("key0", [&](bool) {
+        blocking_ok.store(engine.put("blocked", "value"));
+        engine.putAsync("chained", "value", [&](bool ok) {
+            chained_ok.store(ok);
+            completions.signal();
+        });
+    });
+    completions.waitFor(num_writes + 1);
+    ASSERT_TRUE(!blocking_ok.load(), "Blocking write from a callback should fail instead of deadlocking");
+    ASSERT_TRUE(chained_ok.load(), "Async write queued from a callback should succeed");
+    ASSERT_TRUE(!engine.get("key0", out), "Async delete should be applied");
+    ASSERT_TRUE(!engine.get("blocked", out), "Refused blocking write should not be applied");
+
+    return true;
+}
+
+bool test_async_get(StorageEngineTest &fixture) {
+    fixture.tearDown();
+
+    // No row cache, so every lookup goes through the read pool
+    EngineOptions options;
+    options.row_cache_bytes = 0;
+    StorageEngine engine("data", options);
+    engine.put("present", "value");
+    engine.flush();
+
+    Completions completions;
+    std::optional<Entry> present;
+    std::optional<Entry> missing{Entry{}};
+    engine.getAsync("present", [&](std::optional<Entry> result) {
+        present = std::move(result);
+        completions.signal();
+    });
+    engine.getAsync("missing", [&](std::optional<Entry> result) {
+        missing = std::move(result);
+        completions.signal();
+    });
+    completions.waitFor(2);
+
+    ASSERT_TRUE(present && present->value == "value", "Async get should find the flushed key");
+    ASSERT_TRUE(!missing, "Async get of a missing key should report nullopt");
+
+    return true;
+}
+
+// Starts running at once and frees itself when it finishes
+struct DetachedTask {
+    struct promise_type {
+        DetachedTask get_return_object() {
+            return {};
+        }
+        std::suspend_never initial_suspend() noexcept {
+            return {};
+        }
+        std::suspend_never final_suspend() noexcept {
+            return {};
+        }
+        void return_void() {
+        }
+        void unhandled_exception() {
+            std::terminate();
+        }
+    };
+};
+
+DetachedTask readModifyWrite(StorageEngine &engine, std::string key, int rounds, std::atomic<int> &failed, Completions &completions) {
+    for (int i = 0; i < rounds; i++) {
+        std::optional<Entry> current = co_await engine.awaitGet(key);
+        int next = current ? std::stoi(current->value) + 1 : 1;
+        if (!co_await engine.awaitPut(key, std::to_string(next))) {
+            failed++;
+        }
+    }
+    if (!co_await engine.awaitDel(key + "_scratch")) {
+        failed++;
+    }
+    completions.signal();
+}
+
+bool test_coroutine_writes_and_reads(StorageEngineTest &fixture) {
+    fixture.setUp();
+    auto &engine = fixture.getEngine();
+
+    // Many coroutines in flight at once, all started from this one thread
+    const int num_tasks = 200;
+    const int rounds = 5;
+    std::atomic<int> failed{0};
+    Completions completions;
+    for (int t = 0; t < num_tasks; t++) {
+        readModifyWrite(engine, "counter" + std::to_string(t), rounds, failed, completions);
+    }
+    completions.waitFor(num_tasks);
+
+    ASSERT_EQ(failed.load(), 0, "Every awaited write should succeed");
+    for (int t = 0; t < num_tasks; t++) {
+        Entry out;
+        ASSERT_TRUE(engine.get("counter" + std::to_string(t), out), "Counter should exist");
+        ASSERT_EQ(out.value, std::to_string(rounds), "Each coroutine should see its own previous write");
+    }
+
+    return true;
+}
+
+DetachedTask writeThenBlock(StorageEngine &engine, int id, std::atomic<int> &failed, Completions &completions) {
+    const std::string suffix = std::to_string(id);
+    bool ok = co_await engine.awaitPut("async" + suffix, "1");
+    // Resumed off the commit thread, so a blocking write can follow
+    ok = ok && engine.put("blocking" + suffix, "1");
+    if (!ok) {
+        failed++;
+    }
+    completions.signal();
+}
+
+bool test_coroutine_blocking_write_after_await(StorageEngineTest &fixture) {
+    fixture.setUp();
+    auto &engine = fixture.getEngine();
+
+    const int num_tasks = 20;
+    std::atomic<int> failed{0};
+    Completions completions;
+    for (int t = 0; t < num_tasks; t++) {
+        writeThenBlock(engine, t, failed, completions);
+    }
+    completions.waitFor(num_tasks);
+
+    ASSERT_EQ(failed.load(), 0, "Blocking writes after an awaited write should succeed");
+    Entry out;
+    ASSERT_TRUE(engine.get("blocking0", out), "Blocking write should be visible");
+
+    return true;
+}
+
+DetachedTask readInline(StorageEngine &engine, int rounds, int &found, Completions &completions) {
+    for (int i = 0; i < rounds; i++) {
+        std::optional<Entry> value = co_await engine.awaitGet("key" + std::to_string(i % 10));
+        found += value ? 1 : 0;
+    }
+    completions.signal();
+}
+
+bool test_coroutine_reads_inline(StorageEngineTest &fixture) {
+    fixture.tearDown();
+    const std::string dir = "data_inline_reads";
+    std::filesystem::remove_all(dir);
+
+    EngineOptions options;
+    options.async_read_threads = 0;
+    options.row_cache_bytes = 0;
+    {
+        StorageEngine engine(dir, options);
+        for (int i = 0; i < 5; i++) {
+            engine.put("key" + std::to_string(i), "value");
+        }
+
+        // Enough awaits that resuming each one nested inside the last would overflow the stack
+        const int rounds = 200000;
+        int found = 0;
+        Completions completions;
+        readInline(engine, rounds, found, completions);
+        completions.waitFor(1);
+        ASSERT_EQ(found, rounds / 2, "Inline reads should find every key that exists");
+    }
+
+    std::filesystem::remove_all(dir);
+    return true;
+}
+
+// run tests
+void run_storage_engine_tests(TestFramework &framework) {
+    StorageEngineTest fixture;
+    std::cout << "Running Storage Engine Tests" << std::endl;
+    std::cout << "========================================" << std::endl;
+    framework.run("test_simple_put_and_get", [&]() { return test_simple_put_and_get(fixture); });
+    framework.run("test_update_existing_key", [&]() { return test_update_existing_key(fixture); });
+    framework.run("test_get_nonexistent_key", [&]() { return test_get_nonexistent_key(fixture); });
+    framework.run("test_simple_delete", [&]() { return test_simple_delete(fixture); });
+    framework.run("test_delete_nonexistent_key", [&]() { return test_delete_nonexistent_key(fixture); });
+    framework.run("test_blind_delete", [&]() { return test_blind_delete(fixture); });
+
+    framework.run("test_sequence_numbers_memtable_priority", [&]() { return test_sequence_numbers_memtable_priority(fixture); });
+    framework.run("test_delete_then_put_sequence", [&]() { return test_delete_then_put_sequence(fixture); });
+    framework.run("test_multiple_sstables_newest_wins", [&]() { return test_multiple_sstables_newest_wins(fixture); });
+
+    framework.run("test_recovery_from_wal", [&]() { return test_recovery_from_wal(fixture); });
+    framework.run("test_recovery_with_updates", [&]() { return test_recovery_with_updates(fixture); });
+    framework.run("test_flush_during_writes_recovered", [&]() { return test_flush_during_writes_recovered(fixture); });
+
+    framework.run("test_recovery_removes_unlisted_sstables", [&]() { return test_recovery_removes_unlisted_sstables(fixture); });
+
+    framework.run("test_flush_creates_sstable", [&]() { return test_flush_creates_sstable(fixture); });
+    framework.run("test_read_from_sstable_after_flush", [&]() { return test_read_from_sstable_after_flush(fixture); });
+
+    framework.run("test_compaction_merges_sstables", [&]() { return test_compaction_merges_sstables(fixture); });
+    framework.run("test_compaction_removes_tombstones", [&]() { return test_compaction_removes_tombstones(fixture); });
+    framework.run("test_compaction_keeps_latest_version", [&]() { return test_compaction_keeps_latest_version(fixture); });
+
+    framework.run("test_bloom_filter_negative_lookup", [&]() { return test_bloom_filter_negative_lookup(fixture); });
+
+    framework.run("test_large_dataset_with_index", [&]() { return test_large_dataset_with_index(fixture); });
+
+    framework.run("test_many_operations", [&]() { return test_many_operations(fixture); });
+    framework.run("test_mixed_operations", [&]() { return test_mixed_operations(fixture); });
+
+    framework.run("test_empty_key", [&]() { return test_empty_key(fixture); });
+    framework.run("test_empty_value", [&]() { return test_empty_value(fixture); });
+    framework.run("test_large_value", [&]() { return test_large_value(fixture); });
+
+    framework.run("test_persistence_across_restarts", [&]() { return test_persistence_across_restarts(fixture); });
+
+    framework.run("test_compressed_levels_readable", [&]() { return test_compressed_levels_readable(fixture); });
+
+    framework.run("test_large_values_separated_into_blobs", [&]() { return test_large_values_separated_into_blobs(fixture); });
+    framework.run("test_blob_garbage_collected_by_compaction", [&]() { return test_blob_garbage_collected_by_compaction(fixture); });
+
+    framework.run("test_subcompactions_split_output", [&]() { return test_subcompactions_split_output(fixture); });
+    framework.run("test_concurrent_compactions", [&]() { return test_concurrent_compactions(fixture); });
+    framework.run("test_static_level_targets", [&]() { return test_static_level_targets(fixture); });
+    framework.run("test_dynamic_level_targets", [&]() { return test_dynamic_level_targets(fixture); });
+    framework.run("test_compaction_output_split_by_size", [&]() { return test_compaction_output_split_by_size(fixture); });
+    framework.run("test_compaction_pri_styles", [&]() { return test_compaction_pri_styles(fixture); });
+    framework.run("test_universal_compaction", [&]() { return test_universal_compaction(fixture); });
+    framework.run("test_universal_compaction_keeps_tombstones", [&]() { return test_universal_compaction_keeps_tombstones(fixture); });
+    framework.run("test_rate_limited_compaction", [&]() { return test_rate_limited_compaction(fixture); });
+    framework.run("test_rate_limiter_auto_tune", [&]() { return test_rate_limiter_auto_tune(fixture); });
+    framework.run("test_write_stall_on_l0_backlog", [&]() { return test_write_stall_on_l0_backlog(fixture); });
+    framework.run("test_tombstones_kept_above_older_data", [&]() { return test_tombstones_kept_above_older_data(fixture); });
+    framework.run("test_tombstones_dropped_without_older_data", [&]() { return test_tombstones_dropped_without_older_data(fixture); });
+    framework.run("test_tombstone_density_triggers_compaction", [&]() { return test_tombstone_density_triggers_compaction(fixture); });
+    framework.run("test_delete_range_hides_keys", [&]() { return test_delete_range_hides_keys(fixture); });
+    framework.run("test_delete_range_recovered_from_wal", [&]() { return test_delete_range_recovered_from_wal(fixture); });
+    framework.run("test_delete_range_drops_covered_files", [&]() { return test_delete_range_drops_covered_files(fixture); });
+    framework.run("test_delete_range_drops_blob_values", [&]() { return test_delete_range_drops_blob_values(fixture); });
+    framework.run("test_ttl_expires_keys", [&]() { return test_ttl_expires_keys(fixture); });
+    framework.run("test_ttl_recovered_from_wal", [&]() { return test_ttl_recovered_from_wal(fixture); });
+    framework.run("test_expired_entries_dropped_by_compaction", [&]() { return test_expired_entries_dropped_by_compaction(fixture); });
+    framework.run("test_expired_files_dropped", [&]() { return test_expired_files_dropped(fixture); });
+    framework.run("test_expired_files_release_blobs", [&]() { return test_expired_files_release_blobs(fixture); });
+    framework.run("test_cache_written_through", [&]() { return test_cache_written_through(fixture); });
+    framework.run("test_cache_survives_flush_and_compaction", [&]() { return test_cache_survives_flush_and_compaction(fixture); });
+    framework.run("test_cache_delete_range", [&]() { return test_cache_delete_range(fixture); });
+    framework.run("test_negative_lookups_cached", [&]() { return test_negative_lookups_cached(fixture); });
+    framework.run("test_negative_lookups_disabled", [&]() { return test_negative_lookups_disabled(fixture); });
+    framework.run("test_pipelined_writes_from_many_threads", [&]() { return test_pipelined_writes_from_many_threads(fixture); });
+    framework.run("test_write_batch", [&]() { return test_write_batch(fixture); });
+    framework.run("test_snapshot_reads", [&]() { return test_snapshot_reads(fixture); });
+    framework.run("test_snapshot_release_prunes_older_versions", [&]() { return test_snapshot_release_prunes_older_versions(fixture); });
+    framework.run("test_snapshot_survives_flush_and_compaction", [&]() { return test_snapshot_survives_flush_and_compaction(fixture); });
+    framework.run("test_async_write_callbacks", [&]() { return test_async_write_callbacks(fixture); });
+    framework.run("test_async_get", [&]() { return test_async_get(fixture); });
+    framework.run("test_coroutine_writes_and_reads", [&]() { return test_coroutine_writes_and_reads(fixture); });
+    framework.run("test_coroutine_blocking_write_after_await", [&]() { return test_coroutine_blocking_write_after_await(fixture); });
+    framework.run("test_coroutine_reads_inline", [&]() { return test_coroutine_reads_inline(fixture); });
 
     std::cout << "========================================" << std::endl;
 }
@@ -0,0 +1,93 @@
+#include "frequency_sketch.h"
+#include "test_framework.h"
+#include <functional>
+#include <string>
+
+class FrequencySketchTest {
+  public:
+    FrequencySketchTest() {
+        setUp();
+    }
+
+    static void setUp() {
+        // Tests will create their own sketches as needed
+    }
+
+    static uint64_t hashOf(const std::string &key) {
+        return std::hash<std::string>{}(key);
+    }
+};
+
+bool test_sketch_unseen_key_is_zero(FrequencySketchTest &fixture) {
+    fixture.setUp();
+    FrequencySketch sketch(1024);
+
+    ASSERT_EQ(sketch.estimate(FrequencySketchTest::hashOf("key1")), 0, "Unseen key should have no frequency");
+
+    return true;
+}
+
+bool test_sketch_counts_increments(FrequencySketchTest &fixture) {
+    fixture.setUp();
+    FrequencySketch sketch(1024);
+
+    for (int i = 0; i < 5; i++) {
+        sketch.increment(FrequencySketchTest::hashOf("hot"));
+    }
+    sketch.increment(FrequencySketchTest::hashOf("cold"));
+
+    ASSERT_TRUE(sketch.estimate(FrequencySketchTest::hashOf("hot")) >= 5, "Estimate should never undercount");
+    ASSERT_TRUE(sketch.estimate(FrequencySketchTest::hashOf("cold")) >= 1, "Estimate should never undercount");
+    ASSERT_TRUE(sketch.estimate(FrequencySketchTest::hashOf("hot")) > sketch.estimate(FrequencySketchTest::hashOf("cold")),
+                "Hot key should be estimated above cold key");
+
+    return true;
+}
+
+bool test_sketch_saturates(FrequencySketchTest &fixture) {
+    fixture.setUp();
+    FrequencySketch sketch(1024);
+
+    for (int i = 0; i < 100; i++) {
+        sketch.increment(FrequencySketchTest::hashOf("key1"));
+    }
+
+    ASSERT_EQ(sketch.estimate(FrequencySketchTest::hashOf("key1")), FrequencySketch::MAX_COUNT, "Counter should saturate");
+
+    return true;
+}
+
+bool test_sketch_ages_counts(FrequencySketchTest &fixture) {
+    fixture.setUp();
+    FrequencySketch sketch(16);
+
+    for (int i = 0; i < 10; i++) {
+        sketch.increment(FrequencySketchTest::hashOf("old"));
+    }
+
+    // Increments alone never lower an estimate, so any drop comes from the counters being halved
+    bool aged = false;
+    uint32_t previous = sketch.estimate(FrequencySketchTest::hashOf("old"));
+    for (int i = 0; i < 1000 && !aged; i++) {
+        sketch.increment(FrequencySketchTest::hashOf("key" + std::to_string(i)));
+        uint32_t current = sketch.estimate(FrequencySketchTest::hashOf("old"));
+        aged = current < previous;
+        previous = current;
+    }
+
+    ASSERT_TRUE(aged, "Counters should be halved once the sample size is reached");
+
+    return true;
+}
+
+void run_frequency_sketch_tests(TestFramework &framework) {
+    FrequencySketchTest fixture;
+
+    std::cout << "Running Frequency Sketch Tests" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    framework.run("test_sketch_unseen_key_is_zero", [&]() { return test_sketch_unseen_key_is_zero(fixture); });
+    framework.run("test_sketch_counts_increments", [&]() { return test_sketch_counts_increments(fixture); });
+    framework.run("test_sketch_saturates", [&]() { return test_sketch_saturates(fixture); });
+    framework.run("test_sketch_ages_counts", [&]() { return test_sketch_ages_counts(fixture); });
+}
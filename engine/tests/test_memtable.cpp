@@ -130,6 +130,114 @@ bool test_get_size(MemTableTest &fixture) {
     return true;
 }
 
+bool test_delete_range(MemTableTest &fixture) {
+    fixture.setUp();
+    auto &mt = fixture.getMemTable();
+
+    mt.put("a", "1", 1);
+    mt.put("b", "2", 2);
+    mt.put("c", "3", 3);
+    mt.deleteRange("a", "c", 4);
+    mt.put("b", "4", 5);
+
+    Entry out;
+    ASSERT_TRUE(!mt.get("a", out), "Key written before the range delete should be gone");
+    ASSERT_TRUE(mt.get("b", out), "Key rewritten after the range delete should be visible");
+    ASSERT_EQ(out.value, std::string("4"), "Rewritten key should hold its new value");
+    ASSERT_TRUE(mt.get("c", out), "Range end is exclusive");
+
+    ASSERT_EQ(mt.coveringTombstoneSeq("a"), static_cast<uint64_t>(4), "Tombstone should cover the range start");
+    ASSERT_EQ(mt.coveringTombstoneSeq("c"), static_cast<uint64_t>(0), "Tombstone should not cover the range end");
+    ASSERT_EQ(mt.rangeTombstones().size(), static_cast<size_t>(1), "Tombstone should be kept for older data");
+
+    mt.clear();
+    ASSERT_TRUE(mt.rangeTombstones().empty(), "Clear should drop range tombstones");
+    return true;
+}
+
+bool test_apply_batch(MemTableTest &fixture) {
+    fixture.setUp();
+    auto &mt = fixture.getMemTable();
+
+    mt.put("c", "old", 1);
+    mt.apply({
+        MemTableWrite{Operation::PUT, "a", "1", 2},
+        MemTableWrite{Operation::PUT_TTL, "b", "2", 3, 12345},
+        MemTableWrite{Operation::DELETE_RANGE, "c", "d", 4},
+        MemTableWrite{Operation::PUT, "a", "5", 5},
+        MemTableWrite{Operation::DELETE, "e", "", 6},
+    });
+
+    Entry out;
+    ASSERT_TRUE(mt.get("a", out), "Put should be applied");
+    ASSERT_EQ(out.value, std::string("5"), "Later write in the batch should win");
+    ASSERT_TRUE(mt.get("b", out), "TTL put should be applied");
+    ASSERT_EQ(out.expires_at_ms, static_cast<uint64_t>(12345), "Expiry should be kept");
+    ASSERT_TRUE(!mt.get("c", out), "Range delete should drop the older key");
+    ASSERT_TRUE(mt.get("e", out), "Delete should leave a tombstone");
+    ASSERT_TRUE(out.type == EntryType::DELETE, "Tombstone should be a delete");
+
+    return true;
+}
+
+bool test_versions_retained_for_older_reads(MemTableTest &fixture) {
+    fixture.setUp();
+    auto &mt = fixture.getMemTable();
+
+    mt.apply({MemTableWrite{Operation::PUT, "a", "1", 1}, MemTableWrite{Operation::PUT, "b", "1", 2}});
+    // A reader at seq 2 needs every version written so far
+    mt.apply(
+        {
+            MemTableWrite{Operation::PUT, "a", "2", 3},
+            MemTableWrite{Operation::DELETE_RANGE, "b", "c", 4},
+            MemTableWrite{Operation::PUT, "a", "3", 5},
+        },
+        2);
+
+    Entry out;
+    ASSERT_TRUE(mt.get("a", out) && out.value == "3", "Latest read should see the newest version");
+    ASSERT_TRUE(mt.get("a", out, 2) && out.value == "1", "Read at seq 2 should see the version it was taken on");
+    ASSERT_TRUE(mt.get("b", out, 2) && out.value == "1", "Key dropped by the range delete should stay readable at seq 2");
+    ASSERT_EQ(mt.coveringTombstoneSeq("b", 2), 0, "Range tombstone newer than the read should be ignored");
+    ASSERT_EQ(mt.coveringTombstoneSeq("b"), 4, "Latest read should see the range tombstone");
+    ASSERT_EQ(mt.snapshot().size(), 1, "Snapshot should hold the newest version of each key only");
+
+    MemTable target;
+    size_t size = mt.getSize();
+    mt.moveTo(target);
+    ASSERT_EQ(mt.getSize(), 0, "Moved-from memtable should be empty");
+    ASSERT_EQ(target.getSize(), size, "Size should move along");
+    ASSERT_TRUE(target.get("a", out, 2) && out.value == "1", "Older versions should move along");
+
+    return true;
+}
+
+bool test_versions_pruned(MemTableTest &fixture) {
+    fixture.setUp();
+    auto &mt = fixture.getMemTable();
+
+    mt.apply({MemTableWrite{Operation::PUT, "a", "1", 1}, MemTableWrite{Operation::PUT, "b", "1", 2}});
+    mt.apply({MemTableWrite{Operation::PUT, "a", "2", 3}, MemTableWrite{Operation::PUT, "b", "2", 4}}, 4);
+    mt.apply({MemTableWrite{Operation::PUT, "a", "3", 5}, MemTableWrite{Operation::DELETE_RANGE, "b", "c", 6}}, 4);
+    const size_t size = mt.getSize();
+
+    // Reads as of seq 3 or later still need a=2 and b=2, but never a=1 or b=1
+    mt.pruneVersions(3);
+    Entry out;
+    ASSERT_TRUE(mt.get("a", out, 3) && out.value == "2", "Version visible at the oldest seq should be kept");
+    ASSERT_TRUE(mt.get("b", out, 4) && out.value == "2", "Version dropped by the range delete should be kept");
+    ASSERT_TRUE(!mt.get("a", out, 2), "Versions older than the oldest seq should be dropped");
+    ASSERT_TRUE(mt.getSize() < size, "Dropped versions should no longer count towards the size");
+
+    // Once the newest version is old enough, nothing else is read
+    mt.pruneVersions(5);
+    ASSERT_TRUE(!mt.get("a", out, 4), "Overwritten versions should be dropped");
+    ASSERT_TRUE(mt.get("a", out) && out.value == "3", "Newest version should stay");
+    ASSERT_TRUE(mt.get("b", out, 5) && out.value == "2", "Key without a newer version should keep its last one");
+
+    return true;
+}
+
 void run_memtable_tests(TestFramework &framework) {
     MemTableTest fixture;
 
@@ -147,4 +255,12 @@ void run_memtable_tests(TestFramework &framework) {
     framework.run("test_snapshot", [&]() { return test_snapshot(fixture); });
 
     framework.run("test_get_size", [&]() { return test_get_size(fixture); });
+
+    framework.run("test_delete_range", [&]() { return test_delete_range(fixture); });
+
+    framework.run("test_apply_batch", [&]() { return test_apply_batch(fixture); });
+
+    framework.run("test_versions_retained_for_older_reads", [&]() { return test_versions_retained_for_older_reads(fixture); });
+
+    framework.run("test_versions_pruned", [&]() { return test_versions_pruned(fixture); });
 }
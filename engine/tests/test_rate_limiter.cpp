@@ -0,0 +1,115 @@
+#include "rate_limiter.h"
+#include "test_framework.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+class RateLimiterTest {
+  public:
+    RateLimiterTest() {
+        setUp();
+    }
+
+    static void setUp() {
+        // Tests create their own limiters as needed
+    }
+
+    static double elapsedMs(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+};
+
+bool test_rate_limiter_throttles_low_priority(RateLimiterTest &fixture) {
+    fixture.setUp();
+    RateLimiter limiter(1024 * 1024, 10'000);
+
+    // ~200ms worth of budget at 1 MiB/s, with only 10ms saved up at a time
+    auto start = std::chrono::steady_clock::now();
+    limiter.request(200 * 1024, IOPriority::LOW);
+    double ms = RateLimiterTest::elapsedMs(start);
+
+    ASSERT_TRUE(ms >= 150.0, "LOW request should be held to the configured rate");
+    ASSERT_EQ(limiter.totalBytes(IOPriority::LOW), 200u * 1024, "LOW bytes should be counted");
+    ASSERT_TRUE(limiter.totalWaitMicros() > 0, "Waiting should be recorded");
+
+    return true;
+}
+
+bool test_rate_limiter_high_priority_never_waits(RateLimiterTest &fixture) {
+    fixture.setUp();
+    RateLimiter limiter(1024);
+
+    auto start = std::chrono::steady_clock::now();
+    limiter.request(1024 * 1024, IOPriority::HIGH);
+    double ms = RateLimiterTest::elapsedMs(start);
+
+    ASSERT_TRUE(ms < 100.0, "HIGH request should not wait for budget");
+    ASSERT_EQ(limiter.totalBytes(IOPriority::HIGH), 1024u * 1024, "HIGH bytes should be counted");
+    ASSERT_EQ(limiter.totalWaitMicros(), 0u, "HIGH requests never wait");
+
+    return true;
+}
+
+bool test_rate_limiter_high_priority_debt_delays_low(RateLimiterTest &fixture) {
+    fixture.setUp();
+    RateLimiter limiter(1024 * 1024, 10'000);
+
+    // A flush spends ~100ms of budget up front; compaction has to wait until it is repaid
+    limiter.request(100 * 1024, IOPriority::HIGH);
+    auto start = std::chrono::steady_clock::now();
+    limiter.request(1, IOPriority::LOW);
+    double ms = RateLimiterTest::elapsedMs(start);
+
+    ASSERT_TRUE(ms >= 70.0, "LOW request should wait for HIGH debt to be repaid");
+
+    return true;
+}
+
+bool test_rate_limiter_set_rate_wakes_waiters(RateLimiterTest &fixture) {
+    fixture.setUp();
+    RateLimiter limiter(1024);
+    ASSERT_EQ(limiter.bytesPerSecond(), 1024u, "Initial rate should be reported");
+
+    // Would take ~100s at the initial rate
+    std::atomic<bool> done{false};
+    std::thread waiter([&] {
+        limiter.request(100 * 1024, IOPriority::LOW);
+        done = true;
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    bool waiting = !done.load();
+
+    limiter.setBytesPerSecond(0);
+    waiter.join();
+    ASSERT_TRUE(waiting, "LOW request should have been waiting");
+    ASSERT_TRUE(done.load(), "Lifting the limit should release the waiter");
+    ASSERT_EQ(limiter.bytesPerSecond(), 0u, "New rate should be reported");
+
+    return true;
+}
+
+bool test_rate_limiter_unlimited(RateLimiterTest &fixture) {
+    fixture.setUp();
+    RateLimiter limiter(0);
+
+    auto start = std::chrono::steady_clock::now();
+    limiter.request(64 * 1024 * 1024, IOPriority::LOW);
+    ASSERT_TRUE(RateLimiterTest::elapsedMs(start) < 100.0, "Unlimited limiter should never wait");
+
+    return true;
+}
+
+void run_rate_limiter_tests(TestFramework &framework) {
+    RateLimiterTest fixture;
+
+    std::cout << "Running Rate Limiter Tests" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    framework.run("test_rate_limiter_throttles_low_priority", [&]() { return test_rate_limiter_throttles_low_priority(fixture); });
+    framework.run("test_rate_limiter_high_priority_never_waits", [&]() { return test_rate_limiter_high_priority_never_waits(fixture); });
+    framework.run("test_rate_limiter_high_priority_debt_delays_low",
+                  [&]() { return test_rate_limiter_high_priority_debt_delays_low(fixture); });
+    framework.run("test_rate_limiter_set_rate_wakes_waiters", [&]() { return test_rate_limiter_set_rate_wakes_waiters(fixture); });
+    framework.run("test_rate_limiter_unlimited", [&]() { return test_rate_limiter_unlimited(fixture); });
+}
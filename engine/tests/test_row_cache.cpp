@@ -0,0 +1,808 @@
+#include "row_cache.h"
+#include "test_framework.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+class RowCacheTest {
+  public:
+    RowCacheTest() {
+        setUp();
+    }
+
+    static void setUp() {
+        // Tests will create their own caches as needed
+    }
+
+    // Capacity holding n entries the size of key1/value1
+    static size_t entries(size_t n) {
+        return n * RowCache::charge("key1", Entry{"value1", 1, EntryType::PUT});
+    }
+
+    // Looks the key up and caches it on a miss, the way the engine does
+    static void readThrough(RowCache &cache, const std::string &key) {
+        if (!cache.get(key)) {
+            cache.put(key, Entry{"value1", 1, EntryType::PUT});
+        }
+    }
+
+    // Reads a hot set of 50 keys twenty times each, then sweeps 2000 cold keys once; returns how many hot keys
+    // are still cached afterwards
+    static int hotKeysAfterScan(RowCache &cache) {
+        for (int round = 0; round < 20; round++) {
+            for (int i = 0; i < 50; i++) {
+                readThrough(cache, "hot" + std::to_string(i));
+            }
+        }
+        for (int i = 0; i < 2000; i++) {
+            readThrough(cache, "cold" + std::to_string(i));
+        }
+
+        int cached = 0;
+        for (int i = 0; i < 50; i++) {
+            if (cache.get("hot" + std::to_string(i))) {
+                cached++;
+            }
+        }
+        return cached;
+    }
+};
+
+bool test_basic_put_and_get(RowCacheTest &fixture) {
+    fixture.setUp();
+    RowCache cache(RowCacheTest::entries(10), 0);
+
+    Entry entry1{"value1", 1, EntryType::PUT};
+    cache.put("key1", entry1);
+
+    auto result = cache.get("key1");
+    ASSERT_TRUE(result.has_value(), "Should find key1 in cache");
+    ASSERT_EQ(result->value, "value1", "Value should match");
+    ASSERT_EQ(result->seq, 1, "Sequence number should match");
+    ASSERT_TRUE(result->type == EntryType::PUT, "Entry type should match");
+
+    return true;
+}
+
+bool test_get_nonexistent_key(RowCacheTest &fixture) {
+    fixture.setUp();
+    RowCache cache(RowCacheTest::entries(10), 0);
+
+    auto result = cache.get("nonexistent");
+    ASSERT_TRUE(!result.has_value(), "Should not find nonexistent key");
+
+    return true;
+}
+
+bool test_update_existing_key(RowCacheTest &fixture) {
+    fixture.setUp();
+    RowCache cache(RowCacheTest::entries(10), 0);
+
+    Entry entry1{"value1", 1, EntryType::PUT};
+    cache.put("key1", entry1);
+
+    Entry entry2{"value2", 2, EntryType::PUT};
+    cache.put("key1", entry2);
+
+    auto result = cache.get("key1");
+    ASSERT_TRUE(result.has_value(), "Should find updated key");
+    ASSERT_EQ(result->value, "value2", "Value should be updated");
+    ASSERT_EQ(result->seq, 2, "Sequence number should be updated");
+
+    return true;
+}
+
+bool test_capacity_limit(RowCacheTest &fixture) {
+    fixture.setUp();
+    RowCache cache(RowCacheTest::entries(3), 0);
+
+    Entry entry1{"value1", 1, EntryType::PUT};
+    Entry entry2{"value2", 2, EntryType::PUT};
+    Entry entry3{"value3", 3, EntryType::PUT};
+    Entry entry4{"value4", 4, EntryType::PUT};
+
+    cache.put("key1", entry1);
+    cache.put("key2", entry2);
+    cache.put("key3", entry3);
+
+    ASSERT_EQ(cache.size(), 3, "Cache size should be at capacity");
+
+    // This should evict key1 (least recently used)
+    cache.put("key4", entry4);
+
+    ASSERT_EQ(cache.size(), 3, "Cache size should remain at capacity");
+
+    auto result1 = cache.get("key1");
+    ASSERT_TRUE(!result1.has_value(), "key1 should be evicted");
+
+    auto result4 = cache.get("key4");
+    ASSERT_TRUE(result4.has_value(), "key4 should be in cache");
+
+    return true;
+}
+
+bool test_lru_eviction_order(RowCacheTest &fixture) {
+    fixture.setUp();
+    RowCache cache(RowCacheTest::entries(3), 0);
+
+    Entry entry1{"value1", 1, EntryType::PUT};
+    Entry entry2{"value2", 2, EntryType::PUT};
+    Entry entry3{"value3", 3, EntryType::PUT};
+    Entry entry4{"value4", 4, EntryType::PUT};
+
+    cache.put("key1", entry1);
+    cache.put("key2", entry2);
+    cache.put("key3", entry3);
+
+    // Access key1 to make it recently used
+    cache.get("key1");
+
+    // Now key2 is the least recently used
+    // Adding key4 should evict key2
+    cache.put("key4", entry4);
+
+    auto result1 = cache.get("key1");
+    ASSERT_TRUE(result1.has_value(), "key1 should still be in cache (was accessed)");
+
+    auto result2 = cache.get("key2");
+    ASSERT_TRUE(!result2.has_value(), "key2 should be evicted (least recently used)");
+
+    auto result3 = cache.get("key3");
+    ASSERT_TRUE(result3.has_value(), "key3 should still be in cache");
+
+    auto result4 = cache.get("key4");
+    ASSERT_TRUE(result4.has_value(), "key4 should be in cache");
+
+    return true;
+}
+
+bool test_put_updates_recency(RowCacheTest &fixture) {
+    fixture.setUp();
+    RowCache cache(RowCacheTest::entries(3), 0);
+
+    Entry entry1{"value1", 1, EntryType::PUT};
+    Entry entry2{"value2", 2, EntryType::PUT};
+    Entry entry3{"value3", 3, EntryType::PUT};
+    Entry entry4{"value4", 4, EntryType::PUT};
+
+    cache.put("key1", entry1);
+    cache.put("key2", entry2);
+    cache.put("key3", entry3);
+
+    // Update key1 (should move it to front)
+    Entry entry1_updated{"value1_updated", 5, EntryType::PUT};
+    cache.put("key1", entry1_updated);
+
+    // Now key2 is least recently used
+    cache.put("key4", entry4);
+
+    auto result1 = cache.get("key1");
+    ASSERT_TRUE(result1.has_value(), "key1 should still be in cache (was updated)");
+    ASSERT_EQ(result1->value, "value1_updated", "Value should be updated");
+
+    auto result2 = cache.get("key2");
+    ASSERT_TRUE(!result2.has_value(), "key2 should be evicted");
+
+    return true;
+}
+
+bool test_clear(RowCacheTest &fixture) {
+    fixture.setUp();
+    RowCache cache(RowCacheTest::entries(10), 0);
+
+    Entry entry1{"value1", 1, EntryType::PUT};
+    Entry entry2{"value2", 2, EntryType::PUT};
+    Entry entry3{"value3", 3, EntryType::PUT};
+
+    cache.put("key1", entry1);
+    cache.put("key2", entry2);
+    cache.put("key3", entry3);
+
+    ASSERT_EQ(cache.size(), 3, "Cache should contain 3 items");
+
+    cache.clear();
+
+    ASSERT_EQ(cache.size(), 0, "Cache should be empty after clear");
+
+    auto result1 = cache.get("key1");
+    ASSERT_TRUE(!result1.has_value(), "key1 should not be found after clear");
+
+    auto result2 = cache.get("key2");
+    ASSERT_TRUE(!result2.has_value(), "key2 should not be found after clear");
+
+    return true;
+}
+
+bool test_invalidate(RowCacheTest &fixture) {
+    fixture.setUp();
+    RowCache cache(RowCacheTest::entries(10), 0);
+
+    Entry entry1{"value1", 1, EntryType::PUT};
+    Entry entry2{"value2", 2, EntryType::PUT};
+    Entry entry3{"value3", 3, EntryType::PUT};
+
+    cache.put("key1", entry1);
+    cache.put("key2", entry2);
+    cache.put("key3", entry3);
+
+    ASSERT_EQ(cache.size(), 3, "Cache should contain 3 items");
+
+    cache.invalidate("key2");
+
+    ASSERT_EQ(cache.size(), 2, "Cache should contain 2 items after invalidation");
+
+    auto result1 = cache.get("key1");
+    ASSERT_TRUE(result1.has_value(), "key1 should still be in cache");
+
+    auto result2 = cache.get("key2");
+    ASSERT_TRUE(!result2.has_value(), "key2 should be invalidated");
+
+    auto result3 = cache.get("key3");
+    ASSERT_TRUE(result3.has_value(), "key3 should still be in cache");
+
+    return true;
+}
+
+bool test_invalidate_nonexistent_key(RowCacheTest &fixture) {
+    fixture.setUp();
+    RowCache cache(RowCacheTest::entries(10), 0);
+
+    Entry entry1{"value1", 1, EntryType::PUT};
+    cache.put("key1", entry1);
+
+    ASSERT_EQ(cache.size(), 1, "Cache should contain 1 item");
+
+    // Should not throw or crash
+    cache.invalidate("nonexistent");
+
+    ASSERT_EQ(cache.size(), 1, "Cache size should remain unchanged");
+
+    return true;
+}
+
+bool test_size(RowCacheTest &fixture) {
+    fixture.setUp();
+    RowCache cache(RowCacheTest::entries(10), 0);
+
+    ASSERT_EQ(cache.size(), 0, "Empty cache should have size 0");
+
+    Entry entry1{"value1", 1, EntryType::PUT};
+    cache.put("key1", entry1);
+    ASSERT_EQ(cache.size(), 1, "Cache should have size 1");
+
+    Entry entry2{"value2", 2, EntryType::PUT};
+    cache.put("key2", entry2);
+    ASSERT_EQ(cache.size(), 2, "Cache should have size 2");
+
+    cache.invalidate("key1");
+    ASSERT_EQ(cache.size(), 1, "Cache should have size 1 after invalidation");
+
+    cache.clear();
+    ASSERT_EQ(cache.size(), 0, "Cache should have size 0 after clear");
+
+    return true;
+}
+
+bool test_empty_string_key(RowCacheTest &fixture) {
+    fixture.setUp();
+    RowCache cache(RowCacheTest::entries(10), 0);
+
+    Entry entry{"value_for_empty_key", 1, EntryType::PUT};
+    cache.put("", entry);
+
+    auto result = cache.get("");
+    ASSERT_TRUE(result.has_value(), "Should find empty string key");
+    ASSERT_EQ(result->value, "value_for_empty_key", "Value should match");
+
+    return true;
+}
+
+bool test_empty_value(RowCacheTest &fixture) {
+    fixture.setUp();
+    RowCache cache(RowCacheTest::entries(10), 0);
+
+    Entry entry{"", 1, EntryType::PUT};
+    cache.put("key1", entry);
+
+    auto result = cache.get("key1");
+    ASSERT_TRUE(result.has_value(), "Should find key with empty value");
+    ASSERT_EQ(result->value, "", "Value should be empty");
+
+    return true;
+}
+
+bool test_delete_entry_type(RowCacheTest &fixture) {
+    fixture.setUp();
+    RowCache cache(RowCacheTest::entries(10), 0);
+
+    Entry entry{"", 1, EntryType::DELETE};
+    cache.put("key1", entry);
+
+    auto result = cache.get("key1");
+    ASSERT_TRUE(result.has_value(), "Should find DELETE entry");
+    ASSERT_TRUE(result->type == EntryType::DELETE, "Entry type should be DELETE");
+    ASSERT_EQ(result->value, "", "DELETE entry should have empty value");
+
+    return true;
+}
+
+bool test_special_characters_in_key(RowCacheTest &fixture) {
+    fixture.setUp();
+    RowCache cache(RowCacheTest::entries(10), 0);
+
+    Entry entry1{"value1", 1, EntryType::PUT};
+    Entry entry2{"value2", 2, EntryType::PUT};
+    Entry entry3{"value3", 3, EntryType::PUT};
+
+    cache.put("key!@#$%", entry1);
+    cache.put("key\n\t", entry2);
+    cache.put("key with spaces", entry3);
+
+    auto result1 = cache.get("key!@#$%");
+    ASSERT_TRUE(result1.has_value(), "Should handle special characters");
+
+    auto result2 = cache.get("key\n\t");
+    ASSERT_TRUE(result2.has_value(), "Should handle whitespace characters");
+
+    auto result3 = cache.get("key with spaces");
+    ASSERT_TRUE(result3.has_value(), "Should handle spaces");
+
+    return true;
+}
+
+bool test_long_keys_and_values(RowCacheTest &fixture) {
+    fixture.setUp();
+    RowCache cache(64 * 1024, 0);
+
+    std::string long_key(1000, 'k');
+    std::string long_value(10000, 'v');
+    Entry entry{long_value, 1, EntryType::PUT};
+
+    cache.put(long_key, entry);
+
+    auto result = cache.get(long_key);
+    ASSERT_TRUE(result.has_value(), "Should handle long keys");
+    ASSERT_EQ(result->value, long_value, "Long value should match");
+
+    return true;
+}
+
+bool test_capacity_one(RowCacheTest &fixture) {
+    fixture.setUp();
+    RowCache cache(RowCacheTest::entries(1), 0);
+
+    Entry entry1{"value1", 1, EntryType::PUT};
+    Entry entry2{"value2", 2, EntryType::PUT};
+
+    cache.put("key1", entry1);
+    ASSERT_EQ(cache.size(), 1, "Cache should have size 1");
+
+    cache.put("key2", entry2);
+    ASSERT_EQ(cache.size(), 1, "Cache should still have size 1");
+
+    auto result1 = cache.get("key1");
+    ASSERT_TRUE(!result1.has_value(), "key1 should be evicted");
+
+    auto result2 = cache.get("key2");
+    ASSERT_TRUE(result2.has_value(), "key2 should be in cache");
+
+    return true;
+}
+
+bool test_large_capacity(RowCacheTest &fixture) {
+    fixture.setUp();
+    RowCache cache(RowCacheTest::entries(10000), 0);
+
+    // Add many entries
+    for (int i = 0; i < 5000; i++) {
+        Entry entry{"value" + std::to_string(i), static_cast<uint64_t>(i), EntryType::PUT};
+        cache.put("key" + std::to_string(i), entry);
+    }
+
+    ASSERT_EQ(cache.size(), 5000, "Cache should contain all 5000 entries");
+
+    // Verify random access
+    auto result1 = cache.get("key100");
+    ASSERT_TRUE(result1.has_value(), "Should find key100");
+    ASSERT_EQ(result1->value, "value100", "Value should match");
+
+    auto result2 = cache.get("key2500");
+    ASSERT_TRUE(result2.has_value(), "Should find key2500");
+    ASSERT_EQ(result2->value, "value2500", "Value should match");
+
+    return true;
+}
+
+bool test_sequential_access_pattern(RowCacheTest &fixture) {
+    fixture.setUp();
+    RowCache cache(RowCacheTest::entries(5), 0);
+
+    // Fill cache
+    for (int i = 0; i < 5; i++) {
+        Entry entry{"value" + std::to_string(i), static_cast<uint64_t>(i), EntryType::PUT};
+        cache.put("key" + std::to_string(i), entry);
+    }
+
+    // Access in reverse order to change LRU order
+    for (int i = 4; i >= 0; i--) {
+        cache.get("key" + std::to_string(i));
+    }
+
+    // Add new entry - should evict key4 (now least recently used)
+    Entry entry{"value5", 5, EntryType::PUT};
+    cache.put("key5", entry);
+
+    auto result4 = cache.get("key4");
+    ASSERT_TRUE(!result4.has_value(), "key4 should be evicted");
+
+    auto result0 = cache.get("key0");
+    ASSERT_TRUE(result0.has_value(), "key0 should still be in cache");
+
+    return true;
+}
+
+bool test_thread_safety_basic(RowCacheTest &fixture) {
+    fixture.setUp();
+    RowCache cache(RowCacheTest::entries(1000));
+
+    const int num_threads = 4;
+    const int ops_per_thread = 100;
+    std::vector<std::thread> threads;
+
+    // Multiple threads inserting
+    for (int t = 0; t < num_threads; t++) {
+        threads.emplace_back([&cache, t]() {
+            for (int i = 0; i < ops_per_thread; i++) {
+                std::string key = "key_" + std::to_string(t) + "_" + std::to_string(i);
+                Entry entry{"value_" + std::to_string(i), static_cast<uint64_t>(i), EntryType::PUT};
+                cache.put(key, entry);
+            }
+        });
+    }
+
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    // Cache should not crash and should have reasonable size
+    ASSERT_TRUE(cache.size() <= 1000, "Cache size should not exceed capacity");
+    ASSERT_TRUE(cache.size() > 0, "Cache should contain some entries");
+
+    return true;
+}
+
+bool test_thread_safety_mixed_operations(RowCacheTest &fixture) {
+    fixture.setUp();
+    RowCache cache(RowCacheTest::entries(500));
+
+    const int num_threads = 4;
+    const int ops_per_thread = 50;
+    std::vector<std::thread> threads;
+
+    // Multiple threads doing mixed operations
+    for (int t = 0; t < num_threads; t++) {
+        threads.emplace_back([&cache]() {
+            for (int i = 0; i < ops_per_thread; i++) {
+                std::string key = "shared_key_" + std::to_string(i % 10);
+
+                if (i % 3 == 0) {
+                    Entry entry{"value_" + std::to_string(i), static_cast<uint64_t>(i), EntryType::PUT};
+                    cache.put(key, entry);
+                } else if (i % 3 == 1) {
+                    cache.get(key);
+                } else {
+                    cache.invalidate(key);
+                }
+            }
+        });
+    }
+
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    // Should not crash - basic safety check
+    ASSERT_TRUE(true, "Thread safety test completed without crash");
+
+    return true;
+}
+
+bool test_usage_bounded_by_capacity(RowCacheTest &fixture) {
+    fixture.setUp();
+    const size_t capacity = 16 * 1024;
+    RowCache cache(capacity, 2);
+
+    for (int i = 0; i < 1000; i++) {
+        Entry entry{std::string(static_cast<size_t>(i % 50), 'v'), static_cast<uint64_t>(i), EntryType::PUT};
+        cache.put("key" + std::to_string(i), entry);
+        ASSERT_TRUE(cache.usage() <= capacity, "Usage should never exceed capacity");
+    }
+    ASSERT_TRUE(cache.size() > 0, "Cache should hold entries");
+    ASSERT_TRUE(cache.size() < 1000, "Cache should have evicted entries");
+
+    cache.clear();
+    ASSERT_EQ(cache.usage(), 0, "Usage should be zero after clear");
+
+    return true;
+}
+
+bool test_usage_tracks_replacement(RowCacheTest &fixture) {
+    fixture.setUp();
+    RowCache cache(64 * 1024, 0);
+
+    Entry small{"v", 1, EntryType::PUT};
+    Entry large{std::string(1000, 'v'), 2, EntryType::PUT};
+
+    cache.put("key1", small);
+    ASSERT_EQ(cache.usage(), RowCache::charge("key1", small), "Usage should match the entry's charge");
+
+    cache.put("key1", large);
+    ASSERT_EQ(cache.usage(), RowCache::charge("key1", large), "Replacing an entry should replace its charge");
+    ASSERT_EQ(cache.size(), 1, "Replacement should not add an entry");
+
+    cache.invalidate("key1");
+    ASSERT_EQ(cache.usage(), 0, "Usage should be zero after invalidation");
+
+    return true;
+}
+
+bool test_oversized_entry_not_cached(RowCacheTest &fixture) {
+    fixture.setUp();
+    RowCache cache(RowCacheTest::entries(2), 0);
+
+    Entry entry1{"value1", 1, EntryType::PUT};
+    cache.put("key1", entry1);
+
+    Entry huge{std::string(4096, 'v'), 2, EntryType::PUT};
+    cache.put("key2", huge);
+
+    ASSERT_TRUE(!cache.get("key2").has_value(), "Entry larger than the shard should not be cached");
+    ASSERT_TRUE(cache.get("key1").has_value(), "Oversized entry should not evict others");
+
+    return true;
+}
+
+// A lookup that began before a write must not put the old version back once the write has left the cache
+bool test_stale_fill_after_drop(RowCacheTest &fixture) {
+    fixture.setUp();
+    RowCache cache(RowCacheTest::entries(1), 0);
+    Entry old{"value0", 1, EntryType::PUT};
+
+    // The write at seq 5 is evicted by another key before the lookup that read seq 1 finishes
+    cache.put("key1", Entry{"value1", 5, EntryType::PUT});
+    cache.put("key2", Entry{"value2", 6, EntryType::PUT});
+    cache.putIfCurrent("key1", old, 4);
+    ASSERT_TRUE(!cache.get("key1").has_value(), "Fill older than an evicted write should be dropped");
+    cache.putIfCurrent("key1", Entry{"value1", 5, EntryType::PUT}, 6);
+    ASSERT_TRUE(cache.get("key1").has_value(), "Fill that started after the eviction should be cached");
+
+    // Keys a range delete covers may never have been cached at all
+    RowCache ranged(RowCacheTest::entries(10), 0);
+    ranged.invalidateRange("a", "z", 10);
+    ranged.putIfCurrent("key1", old, 9);
+    ASSERT_TRUE(!ranged.get("key1").has_value(), "Fill older than a range delete should be dropped");
+    ranged.putIfCurrent("key1", old, 10);
+    ASSERT_TRUE(ranged.get("key1").has_value(), "Fill that saw the range delete should be cached");
+
+    // Too large to be cached, so nothing shadows the old version
+    RowCache small(RowCacheTest::entries(1), 0);
+    small.put("key1", Entry{std::string(1024, 'x'), 3, EntryType::PUT});
+    small.putIfCurrent("key1", old, 2);
+    ASSERT_TRUE(!small.get("key1").has_value(), "Fill older than an uncacheable write should be dropped");
+
+    return true;
+}
+
+bool test_min_capacity(RowCacheTest &fixture) {
+    fixture.setUp();
+    Entry empty{"", 1, EntryType::PUT};
+
+    RowCache tooSmall(RowCache::minCapacity(2) - 1, 2);
+    for (int i = 0; i < 16; i++) {
+        tooSmall.put(std::string(1, static_cast<char>('a' + i)), empty);
+    }
+    ASSERT_EQ(tooSmall.size(), 0, "A cache below the minimum capacity should hold nothing");
+
+    RowCache smallest(RowCache::minCapacity(0), 0);
+    smallest.put("", empty);
+    ASSERT_EQ(smallest.size(), 1, "A cache at the minimum capacity should hold an empty entry");
+
+    return true;
+}
+
+bool test_zero_capacity(RowCacheTest &fixture) {
+    fixture.setUp();
+    RowCache cache(0);
+
+    Entry entry{"value1", 1, EntryType::PUT};
+    cache.put("key1", entry);
+
+    ASSERT_TRUE(!cache.get("key1").has_value(), "Zero-capacity cache should hold nothing");
+    ASSERT_EQ(cache.size(), 0, "Zero-capacity cache should be empty");
+
+    return true;
+}
+
+bool test_sharded_concurrent_readers(RowCacheTest &fixture) {
+    fixture.setUp();
+    RowCache cache(1024 * 1024, 4);
+
+    const int num_keys = 256;
+    for (int i = 0; i < num_keys; i++) {
+        cache.put("key" + std::to_string(i), Entry{"value" + std::to_string(i), static_cast<uint64_t>(i), EntryType::PUT});
+    }
+
+    const int num_threads = 8;
+    std::atomic<int> mismatches{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; t++) {
+        threads.emplace_back([&cache, &mismatches, t]() {
+            for (int round = 0; round < 100; round++) {
+                for (int i = t; i < num_keys; i += num_threads) {
+                    auto result = cache.get("key" + std::to_string(i));
+                    if (!result.has_value() || result->value != "value" + std::to_string(i)) {
+                        mismatches++;
+                    }
+                }
+            }
+        });
+    }
+
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    ASSERT_EQ(mismatches.load(), 0, "Every reader should see its keys");
+    ASSERT_EQ(cache.size(), static_cast<size_t>(num_keys), "No entry should have been evicted");
+
+    return true;
+}
+
+bool test_tiny_lfu_scan_keeps_hot_set(RowCacheTest &fixture) {
+    fixture.setUp();
+    RowCache cache(RowCacheTest::entries(200), 0, RowCachePolicy::TINY_LFU);
+
+    // Sketch collisions may cost a key or two; plain LRU keeps none
+    ASSERT_TRUE(RowCacheTest::hotKeysAfterScan(cache) >= 45, "Scan should not evict frequently read keys");
+    ASSERT_TRUE(cache.stats().rejected > 0, "Cold keys should have been refused admission");
+
+    return true;
+}
+
+bool test_lru_scan_flushes_hot_set(RowCacheTest &fixture) {
+    fixture.setUp();
+    RowCache cache(RowCacheTest::entries(200), 0, RowCachePolicy::LRU);
+
+    ASSERT_EQ(RowCacheTest::hotKeysAfterScan(cache), 0, "Plain LRU should lose the hot set to a scan");
+    ASSERT_EQ(cache.stats().rejected, 0, "Plain LRU admits every key");
+
+    return true;
+}
+
+bool test_tiny_lfu_admits_while_not_full(RowCacheTest &fixture) {
+    fixture.setUp();
+    RowCache cache(RowCacheTest::entries(100), 0, RowCachePolicy::TINY_LFU);
+
+    for (int i = 0; i < 50; i++) {
+        RowCacheTest::readThrough(cache, "key" + std::to_string(i));
+    }
+
+    ASSERT_EQ(cache.size(), 50, "Every key should be admitted while there is room");
+    for (int i = 0; i < 50; i++) {
+        ASSERT_TRUE(cache.get("key" + std::to_string(i)).has_value(), "Key should be cached");
+    }
+
+    return true;
+}
+
+bool test_tiny_lfu_usage_bounded_by_capacity(RowCacheTest &fixture) {
+    fixture.setUp();
+    const size_t capacity = 16 * 1024;
+    RowCache cache(capacity, 2, RowCachePolicy::TINY_LFU);
+
+    for (int i = 0; i < 2000; i++) {
+        std::string key = "key" + std::to_string(i % 300);
+        if (!cache.get(key)) {
+            cache.put(key, Entry{std::string(static_cast<size_t>(i % 70), 'v'), static_cast<uint64_t>(i), EntryType::PUT});
+        }
+        ASSERT_TRUE(cache.usage() <= capacity, "Usage should never exceed capacity");
+    }
+
+    cache.clear();
+    ASSERT_EQ(cache.usage(), 0, "Usage should be zero after clear");
+    ASSERT_EQ(cache.size(), 0, "Cache should be empty after clear");
+
+    return true;
+}
+
+bool test_stats_count_hits_and_misses(RowCacheTest &fixture) {
+    fixture.setUp();
+    RowCache cache(RowCacheTest::entries(10), 0, RowCachePolicy::TINY_LFU);
+
+    RowCacheTest::readThrough(cache, "key1");
+    RowCacheTest::readThrough(cache, "key1");
+    RowCacheTest::readThrough(cache, "key1");
+    RowCacheTest::readThrough(cache, "key2");
+
+    RowCacheStats stats = cache.stats();
+    ASSERT_EQ(stats.hits, 2, "Repeat reads should hit");
+    ASSERT_EQ(stats.misses, 2, "First reads should miss");
+    ASSERT_TRUE(stats.hitRate() == 0.5, "Hit rate should be hits over lookups");
+
+    return true;
+}
+
+bool test_put_keeps_newer_version(RowCacheTest &fixture) {
+    fixture.setUp();
+    RowCache cache(RowCacheTest::entries(10), 0);
+
+    cache.put("key1", Entry{"new", 5, EntryType::PUT});
+    cache.put("key1", Entry{"old", 3, EntryType::PUT});
+
+    auto result = cache.get("key1");
+    ASSERT_TRUE(result.has_value(), "Should find key1");
+    ASSERT_EQ(result->value, "new", "Older version should not replace a newer one");
+
+    return true;
+}
+
+bool test_invalidate_range(RowCacheTest &fixture) {
+    fixture.setUp();
+    RowCache cache(64 * 1024, 2);
+
+    for (char c = 'a'; c <= 'f'; c++) {
+        cache.put(std::string(1, c), Entry{"value", 1, EntryType::PUT});
+    }
+    cache.invalidateRange("b", "e", 10);
+
+    ASSERT_TRUE(cache.get("a").has_value(), "Key before the range should stay");
+    ASSERT_TRUE(!cache.get("b").has_value(), "Range start is inclusive");
+    ASSERT_TRUE(!cache.get("d").has_value(), "Key inside the range should go");
+    ASSERT_TRUE(cache.get("e").has_value(), "Range end is exclusive");
+    ASSERT_EQ(cache.size(), 3, "Only the range should be dropped");
+
+    return true;
+}
+
+void run_row_cache_tests(TestFramework &framework) {
+    RowCacheTest fixture;
+
+    std::cout << "Running Row Cache Tests" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    framework.run("test_basic_put_and_get", [&]() { return test_basic_put_and_get(fixture); });
+    framework.run("test_get_nonexistent_key", [&]() { return test_get_nonexistent_key(fixture); });
+    framework.run("test_update_existing_key", [&]() { return test_update_existing_key(fixture); });
+    framework.run("test_capacity_limit", [&]() { return test_capacity_limit(fixture); });
+    framework.run("test_lru_eviction_order", [&]() { return test_lru_eviction_order(fixture); });
+    framework.run("test_put_updates_recency", [&]() { return test_put_updates_recency(fixture); });
+    framework.run("test_clear", [&]() { return test_clear(fixture); });
+    framework.run("test_invalidate", [&]() { return test_invalidate(fixture); });
+    framework.run("test_invalidate_nonexistent_key", [&]() { return test_invalidate_nonexistent_key(fixture); });
+    framework.run("test_size", [&]() { return test_size(fixture); });
+    framework.run("test_empty_string_key", [&]() { return test_empty_string_key(fixture); });
+    framework.run("test_empty_value", [&]() { return test_empty_value(fixture); });
+    framework.run("test_delete_entry_type", [&]() { return test_delete_entry_type(fixture); });
+    framework.run("test_special_characters_in_key", [&]() { return test_special_characters_in_key(fixture); });
+    framework.run("test_long_keys_and_values", [&]() { return test_long_keys_and_values(fixture); });
+    framework.run("test_capacity_one", [&]() { return test_capacity_one(fixture); });
+    framework.run("test_large_capacity", [&]() { return test_large_capacity(fixture); });
+    framework.run("test_sequential_access_pattern", [&]() { return test_sequential_access_pattern(fixture); });
+    framework.run("test_thread_safety_basic", [&]() { return test_thread_safety_basic(fixture); });
+    framework.run("test_thread_safety_mixed_operations", [&]() { return test_thread_safety_mixed_operations(fixture); });
+    framework.run("test_usage_bounded_by_capacity", [&]() { return test_usage_bounded_by_capacity(fixture); });
+    framework.run("test_usage_tracks_replacement", [&]() { return test_usage_tracks_replacement(fixture); });
+    framework.run("test_oversized_entry_not_cached", [&]() { return test_oversized_entry_not_cached(fixture); });
+    framework.run("test_min_capacity", [&]() { return test_min_capacity(fixture); });
+    framework.run("test_stale_fill_after_drop", [&]() { return test_stale_fill_after_drop(fixture); });
+    framework.run("test_zero_capacity", [&]() { return test_zero_capacity(fixture); });
+    framework.run("test_sharded_concurrent_readers", [&]() { return test_sharded_concurrent_readers(fixture); });
+    framework.run("test_tiny_lfu_scan_keeps_hot_set", [&]() { return test_tiny_lfu_scan_keeps_hot_set(fixture); });
+    framework.run("test_lru_scan_flushes_hot_set", [&]() { return test_lru_scan_flushes_hot_set(fixture); });
+    framework.run("test_tiny_lfu_admits_while_not_full", [&]() { return test_tiny_lfu_admits_while_not_full(fixture); });
+    framework.run("test_tiny_lfu_usage_bounded_by_capacity", [&]() { return test_tiny_lfu_usage_bounded_by_capacity(fixture); });
+    framework.run("test_stats_count_hits_and_misses", [&]() { return test_stats_count_hits_and_misses(fixture); });
+    framework.run("test_put_keeps_newer_version", [&]() { return test_put_keeps_newer_version(fixture); });
+    framework.run("test_invalidate_range", [&]() { return test_invalidate_range(fixture); });
+}
@@ -1,5 +1,6 @@
 #include "sstable.h"
 #include "test_framework.h"
+#include <algorithm>
 #include <filesystem>
 #include <map>
 
@@ -454,6 +455,204 @@ bool test_sequence_numbers(SSTableTest &fixture) {
     return true;
 }
 
+bool test_prefix_compressed_blocks(SSTableTest &fixture) {
+    fixture.setUp();
+
+    std::map<std::string, Entry> snapshot;
+    // Size of the same entries with fixed-width headers and full keys
+    size_t legacy_bytes = 0;
+    for (size_t i = 0; i < 5000; i++) {
+        std::string id = std::to_string(i);
+        std::string key = "user:" + std::string(7 - id.size(), '0') + id + ":profile:settings";
+        legacy_bytes += sizeof(uint64_t) + 1 + 2 * sizeof(uint32_t) + key.size() + 1;
+        snapshot[key] = Entry{"v", i, EntryType::PUT};
+    }
+
+    std::string filename;
+    {
+        SSTable table = SSTable::flush(snapshot, fixture.getTestDir(), fixture.getNextFlushCounter());
+        filename = table.filename();
+    }
+
+    ASSERT_TRUE(std::filesystem::file_size(filename) < legacy_bytes, "Shared key prefixes should be stored once per restart run");
+
+    // Reopen so the index is decoded from disk
+    SSTable reopened(filename);
+    for (const auto &[key, entry] : snapshot) {
+        auto result = reopened.get(key);
+        ASSERT_TRUE(result.has_value(), "Should find every key across block boundaries: " + key);
+        ASSERT_EQ(result->seq, entry.seq, "Sequence number should match");
+    }
+
+    ASSERT_TRUE(!reopened.get("user:0000001:profile:settingsx").has_value(), "Key between entries should not be found");
+
+    size_t count = 0;
+    for (SSTable::Iterator it(reopened); it.valid(); it.next()) {
+        count++;
+    }
+    ASSERT_EQ(count, snapshot.size(), "Iterator should visit every entry across blocks");
+
+    return true;
+}
+
+bool test_compressed_blocks(SSTableTest &fixture) {
+    fixture.setUp();
+
+    std::map<std::string, Entry> snapshot;
+    for (size_t i = 0; i < 2000; i++) {
+        std::string value = "{\"id\":" + std::to_string(i) + ",\"status\":\"active\",\"region\":\"us-east-1\",\"tier\":\"gold\"}";
+        snapshot["key" + std::to_string(i)] = Entry{value, i, EntryType::PUT};
+    }
+
+    std::string plain_name;
+    std::string zlib_name;
+    {
+        SSTable plain = SSTable::flush(snapshot, fixture.getTestDir(), fixture.getNextFlushCounter());
+        SSTable zlib = SSTable::flush(snapshot, fixture.getTestDir(), fixture.getNextFlushCounter(), CompressionType::ZLIB);
+        plain_name = plain.filename();
+        zlib_name = zlib.filename();
+    }
+
+    ASSERT_TRUE(std::filesystem::file_size(zlib_name) * 2 < std::filesystem::file_size(plain_name),
+                "Compressed SSTable should be much smaller");
+
+    SSTable table(zlib_name);
+    auto cache = std::make_shared<BlockCache>(1024 * 1024);
+    table.setBlockCache(cache);
+
+    for (const auto &[key, entry] : snapshot) {
+        auto result = table.get(key);
+        ASSERT_TRUE(result.has_value(), "Should find key in compressed table: " + key);
+        ASSERT_EQ(result->value, entry.value, "Value should survive compression");
+    }
+    ASSERT_TRUE(cache->size() > 0, "Decompressed blocks should be cached");
+
+    size_t count = 0;
+    for (SSTable::Iterator it(table); it.valid(); it.next()) {
+        count++;
+    }
+    ASSERT_EQ(count, snapshot.size(), "Iterator should decode compressed blocks");
+
+    return true;
+}
+
+bool test_dictionary_compressed_table(SSTableTest &fixture) {
+    fixture.setUp();
+
+    std::map<std::string, Entry> snapshot;
+    std::vector<std::string> samples;
+    for (size_t i = 0; i < 1000; i++) {
+        std::string value = "{\"id\":" + std::to_string(i) + ",\"kind\":\"event\",\"source\":\"ingest\"}";
+        snapshot["key" + std::to_string(i)] = Entry{value, i, EntryType::PUT};
+        samples.push_back(value);
+    }
+
+    std::string dictionary = trainDictionary(samples, 2048);
+    ASSERT_TRUE(!dictionary.empty(), "Should train a dictionary");
+
+    std::string filename;
+    {
+        SSTable table = SSTable::flush(snapshot, fixture.getTestDir(), fixture.getNextFlushCounter(), CompressionType::ZLIB, dictionary);
+        filename = table.filename();
+    }
+
+    SSTable reopened(filename);
+    ASSERT_EQ(reopened.dictionary(), dictionary, "Dictionary should be loaded from the meta section");
+
+    for (const auto &[key, entry] : snapshot) {
+        auto result = reopened.get(key);
+        ASSERT_TRUE(result.has_value(), "Should find key: " + key);
+        ASSERT_EQ(result->value, entry.value, "Value should survive dictionary compression");
+    }
+
+    return true;
+}
+
+bool test_range_tombstones(SSTableTest &fixture) {
+    fixture.setUp();
+
+    std::map<std::string, Entry> snapshot;
+    snapshot["key5"] = Entry{"value5", 10, EntryType::PUT};
+    std::vector<RangeTombstone> tombstones = {{"key1", "key5", 7}, {"key4", "key9", 3}};
+
+    std::string filename;
+    {
+        SSTable table = SSTable::flush(snapshot, fixture.getTestDir(), fixture.getNextFlushCounter(), CompressionType::NONE, "",
+                                       nullptr, IOPriority::HIGH, tombstones);
+        filename = table.filename();
+    }
+
+    SSTable reopened(filename);
+    ASSERT_EQ(reopened.rangeTombstones().size(), static_cast<size_t>(2), "Range tombstones should be loaded from the meta section");
+    ASSERT_EQ(reopened.minKey(), std::string("key1"), "Key range should start at the first tombstone");
+    ASSERT_EQ(reopened.maxKey(), std::string("key9"), "Key range should end at the last tombstone");
+    ASSERT_EQ(reopened.coveringTombstoneSeq("key4"), static_cast<uint64_t>(7), "Newest covering tombstone should win");
+    ASSERT_EQ(reopened.coveringTombstoneSeq("key8"), static_cast<uint64_t>(3), "Older tombstone should cover the rest");
+    ASSERT_EQ(reopened.coveringTombstoneSeq("key9"), static_cast<uint64_t>(0), "Tombstone end should be exclusive");
+    ASSERT_TRUE(reopened.get("key5").has_value(), "Point entries should still be readable");
+
+    return true;
+}
+
+bool test_tombstone_only_table(SSTableTest &fixture) {
+    fixture.setUp();
+
+    std::string filename;
+    {
+        SSTable table = SSTable::flush({}, fixture.getTestDir(), fixture.getNextFlushCounter(), CompressionType::NONE, "", nullptr,
+                                       IOPriority::HIGH, {{"a", "m", 1}});
+        filename = table.filename();
+    }
+
+    SSTable reopened(filename);
+    ASSERT_EQ(reopened.minKey(), std::string("a"), "Key range should come from the tombstone");
+    ASSERT_EQ(reopened.maxKey(), std::string("m"), "Key range should come from the tombstone");
+    ASSERT_TRUE(!reopened.get("b").has_value(), "Table should hold no point entries");
+    ASSERT_TRUE(!SSTable::Iterator(reopened).valid(), "Iterator over a tombstone-only table should be empty");
+
+    return true;
+}
+
+bool test_iterator_seek(SSTableTest &fixture) {
+    fixture.setUp();
+
+    std::map<std::string, Entry> snapshot;
+    for (int i = 0; i < 2000; i += 2) {
+        std::string n = std::to_string(i);
+        snapshot["key" + std::string(5 - n.size(), '0') + n] = Entry{std::string(100, 'v'), static_cast<uint64_t>(i), EntryType::PUT};
+    }
+
+    SSTable table = SSTable::flush(snapshot, fixture.getTestDir(), fixture.getNextFlushCounter());
+    auto indexKeys = table.indexKeys();
+    ASSERT_TRUE(indexKeys.size() > 10, "Table should span many blocks");
+    ASSERT_EQ(indexKeys.front(), snapshot.begin()->first, "First index key should be the first key");
+    ASSERT_TRUE(std::is_sorted(indexKeys.begin(), indexKeys.end()), "Index keys should be sorted");
+
+    SSTable::Iterator it(table);
+    it.seek("key01000");
+    ASSERT_TRUE(it.valid(), "Seek to existing key should be valid");
+    ASSERT_EQ(it.entry().key, "key01000", "Seek should land on exact key");
+
+    it.seek("key01001");
+    ASSERT_TRUE(it.valid(), "Seek between keys should be valid");
+    ASSERT_EQ(it.entry().key, "key01002", "Seek should land on next larger key");
+
+    // Seeking to a block boundary must not skip the block's first entry
+    it.seek(indexKeys[5]);
+    ASSERT_TRUE(it.valid(), "Seek to block start should be valid");
+    ASSERT_EQ(it.entry().key, indexKeys[5], "Seek should land on block's first key");
+    it.next();
+    ASSERT_TRUE(it.valid() && it.entry().key > indexKeys[5], "Iteration should continue after seek");
+
+    it.seek("");
+    ASSERT_EQ(it.entry().key, snapshot.begin()->first, "Seek before first key should land on first key");
+
+    it.seek("zzz");
+    ASSERT_TRUE(!it.valid(), "Seek past last key should be invalid");
+
+    return true;
+}
+
 void run_sstable_tests(TestFramework &framework) {
     SSTableTest fixture;
 
@@ -479,4 +678,10 @@ void run_sstable_tests(TestFramework &framework) {
     framework.run("test_move_semantics", [&]() { return test_move_semantics(fixture); });
     framework.run("test_bloom_filter_optimization", [&]() { return test_bloom_filter_optimization(fixture); });
     framework.run("test_sequence_numbers", [&]() { return test_sequence_numbers(fixture); });
+    framework.run("test_prefix_compressed_blocks", [&]() { return test_prefix_compressed_blocks(fixture); });
+    framework.run("test_compressed_blocks", [&]() { return test_compressed_blocks(fixture); });
+    framework.run("test_dictionary_compressed_table", [&]() { return test_dictionary_compressed_table(fixture); });
+    framework.run("test_iterator_seek", [&]() { return test_iterator_seek(fixture); });
+    framework.run("test_range_tombstones", [&]() { return test_range_tombstones(fixture); });
+    framework.run("test_tombstone_only_table", [&]() { return test_tombstone_only_table(fixture); });
 }
@@ -468,6 +468,55 @@ bool test_empty_levels_between(TableVersionTest &fixture) {
     return true;
 }
 
+bool test_version_manager_apply_edit(TableVersionTest &fixture) {
+    fixture.setUp();
+
+    VersionManager manager;
+    auto base = manager.getVersionForModification();
+    base->addSSTable(fixture.createTestSSTable(1), SSTableMeta{1, "key1", "key1", 1, 100, 0});
+    base->addSSTable(fixture.createTestSSTable(2), SSTableMeta{2, "key2", "key2", 2, 100, 0});
+    manager.installVersion(base);
+
+    VersionEdit edit;
+    edit.removed_ids = {1, 2};
+    edit.added.emplace_back(fixture.createTestSSTable(4), SSTableMeta{4, "key4", "key4", 2, 100, 1});
+    edit.added.emplace_back(fixture.createTestSSTable(3), SSTableMeta{3, "key3", "key3", 2, 100, 1});
+    ASSERT_TRUE(manager.applyEdit(edit), "Edit over live files should apply");
+
+    auto current = manager.getCurrentVersion();
+    ASSERT_TRUE(current->levels[0].empty(), "Removed files should be gone");
+    ASSERT_EQ(current->levels[1].size(), 2, "Added files should be installed");
+    ASSERT_EQ(current->levels[1][0].id, 3, "L1 should be sorted by key");
+    ASSERT_EQ(current->flush_counter, 4, "Flush counter should cover added ids");
+    ASSERT_EQ(current->sstables.size(), 2, "Table list should match levels");
+
+    return true;
+}
+
+bool test_version_manager_apply_edit_conflict(TableVersionTest &fixture) {
+    fixture.setUp();
+
+    VersionManager manager;
+    auto base = manager.getVersionForModification();
+    base->addSSTable(fixture.createTestSSTable(1), SSTableMeta{1, "key1", "key1", 1, 100, 1});
+    manager.installVersion(base);
+
+    VersionEdit first;
+    first.removed_ids = {1};
+    first.added.emplace_back(fixture.createTestSSTable(2), SSTableMeta{2, "key1", "key1", 1, 100, 2});
+    ASSERT_TRUE(manager.applyEdit(first), "First edit should apply");
+    auto afterFirst = manager.getCurrentVersion();
+
+    // A second job that also consumed file 1 must not install
+    VersionEdit second;
+    second.removed_ids = {1};
+    second.added.emplace_back(fixture.createTestSSTable(3), SSTableMeta{3, "key1", "key1", 1, 100, 2});
+    ASSERT_TRUE(!manager.applyEdit(second), "Edit over a removed file should conflict");
+    ASSERT_TRUE(manager.getCurrentVersion() == afterFirst, "Conflicting edit should leave the version untouched");
+
+    return true;
+}
+
 void run_table_version_tests(TestFramework &framework) {
     TableVersionTest fixture;
 
@@ -495,4 +544,6 @@ void run_table_version_tests(TestFramework &framework) {
     framework.run("test_metadata_preservation", [&]() { return test_metadata_preservation(fixture); });
     framework.run("test_level_resizing", [&]() { return test_level_resizing(fixture); });
     framework.run("test_empty_levels_between", [&]() { return test_empty_levels_between(fixture); });
+    framework.run("test_version_manager_apply_edit", [&]() { return test_version_manager_apply_edit(fixture); });
+    framework.run("test_version_manager_apply_edit_conflict", [&]() { return test_version_manager_apply_edit_conflict(fixture); });
 }
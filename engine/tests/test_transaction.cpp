@@ -0,0 +1,262 @@
+#include "engine.h"
+#include "test_framework.h"
+#include "transaction.h"
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+class TransactionTest {
+  public:
+    void setUp() {
+        tearDown();
+        engine_ = std::make_unique<StorageEngine>(DATA_DIR);
+    }
+
+    void tearDown() {
+        engine_.reset();
+        try {
+            std::filesystem::remove_all(DATA_DIR);
+        } catch (...) {
+        }
+    }
+
+    // Closes and reopens the engine on the same directory
+    void reopen() {
+        engine_.reset();
+        engine_ = std::make_unique<StorageEngine>(DATA_DIR);
+    }
+
+    StorageEngine &getEngine() {
+        return *engine_;
+    }
+
+  private:
+    static constexpr const char *DATA_DIR = "data";
+    std::unique_ptr<StorageEngine> engine_;
+};
+
+bool test_transaction_commit(TransactionTest &fixture) {
+    fixture.setUp();
+    auto &engine = fixture.getEngine();
+    engine.put("balance:a", "100");
+    engine.put("balance:b", "0");
+
+    Transaction txn(engine);
+    Entry a;
+    Entry b;
+    ASSERT_TRUE(txn.get("balance:a", a) && txn.get("balance:b", b), "Transaction should read existing keys");
+    txn.put("balance:a", std::to_string(std::stoi(a.value) - 30));
+    txn.put("balance:b", std::to_string(std::stoi(b.value) + 30));
+    txn.del("pending");
+
+    Entry out;
+    ASSERT_TRUE(engine.get("balance:a", out) && out.value == "100", "Buffered writes should not be visible before commit");
+    ASSERT_TRUE(txn.commit(), "Commit without conflicting writes should succeed");
+    ASSERT_TRUE(engine.get("balance:a", out) && out.value == "70", "First write should be visible after commit");
+    ASSERT_TRUE(engine.get("balance:b", out) && out.value == "30", "Second write should be visible after commit");
+    ASSERT_TRUE(!txn.commit(), "A transaction should only commit once");
+
+    return true;
+}
+
+bool test_transaction_reads_own_writes(TransactionTest &fixture) {
+    fixture.setUp();
+    auto &engine = fixture.getEngine();
+    engine.put("k", "old");
+    engine.put("gone", "old");
+
+    Transaction txn(engine);
+    txn.put("k", "new");
+    txn.del("gone");
+
+    Entry out;
+    ASSERT_TRUE(txn.get("k", out) && out.value == "new", "Transaction should read its own put");
+    ASSERT_TRUE(!txn.get("gone", out), "Transaction should read its own delete");
+    ASSERT_TRUE(txn.commit(), "Blind writes should commit");
+
+    return true;
+}
+
+bool test_transaction_conflict(TransactionTest &fixture) {
+    fixture.setUp();
+    auto &engine = fixture.getEngine();
+    engine.put("counter", "1");
+
+    Transaction txn(engine);
+    Entry out;
+    ASSERT_TRUE(txn.get("counter", out), "Transaction should read the counter");
+    txn.put("counter", "2");
+    txn.put("other", "x");
+
+    // Another writer updates the key after the transaction read it
+    engine.put("counter", "5");
+    ASSERT_TRUE(!txn.commit(), "Commit should fail when a read key was written since");
+    ASSERT_TRUE(engine.get("counter", out) && out.value == "5", "Failed commit should not overwrite the key");
+    ASSERT_TRUE(!engine.get("other", out), "Failed commit should write nothing");
+
+    // Deleting or inserting a read key conflicts too
+    Transaction deleted(engine);
+    deleted.get("counter", out);
+    deleted.put("counter", "6");
+    engine.deleteRange("c", "d");
+    ASSERT_TRUE(!deleted.commit(), "Commit should fail when a read key was range deleted since");
+
+    Transaction inserted(engine);
+    ASSERT_TRUE(!inserted.get("fresh", out), "Key should not exist yet");
+    inserted.put("fresh", "mine");
+    engine.put("fresh", "theirs");
+    ASSERT_TRUE(!inserted.commit(), "Commit should fail when a key read as missing was inserted since");
+
+    // Writes to keys the transaction did not read do not conflict
+    Transaction unrelated(engine);
+    unrelated.get("fresh", out);
+    unrelated.put("fresh", "updated");
+    engine.put("elsewhere", "1");
+    ASSERT_TRUE(unrelated.commit(), "Writes to unread keys should not fail the commit");
+    ASSERT_TRUE(engine.get("fresh", out) && out.value == "updated", "Committed value should be visible");
+
+    return true;
+}
+
+bool test_transaction_conflict_after_flush(TransactionTest &fixture) {
+    fixture.setUp();
+    auto &engine = fixture.getEngine();
+    engine.put("k", "1");
+
+    Transaction txn(engine);
+    Entry out;
+    txn.get("k", out);
+    txn.put("k", "2");
+    engine.put("k", "3");
+    engine.flush();
+    engine.waitForCompaction();
+    ASSERT_TRUE(!txn.commit(), "A conflicting write flushed to an SSTable should still fail the commit");
+    ASSERT_TRUE(engine.get("k", out) && out.value == "3", "Failed commit should not overwrite the key");
+
+    return true;
+}
+
+bool test_transaction_conflict_with_unapplied_write(TransactionTest &fixture) {
+    fixture.setUp();
+    auto &engine = fixture.getEngine();
+    engine.put("k", "1");
+
+    // The async write may still be on its way through the pipeline when the writer checks the transaction
+    for (int i = 0; i < 20; i++) {
+        Transaction txn(engine);
+        Entry out;
+        txn.get("k", out);
+        txn.put("k", "txn");
+        auto written = engine.putAsync("k", std::to_string(i));
+        ASSERT_TRUE(!txn.commit(), "A write queued after the read should fail the commit");
+        ASSERT_TRUE(written.get(), "The async write should commit");
+        ASSERT_TRUE(engine.get("k", out) && out.value == std::to_string(i), "Failed commit should not overwrite the key");
+    }
+
+    return true;
+}
+
+// Read-modify-write increments retried on conflict never lose an update
+bool test_transaction_concurrent_increments(TransactionTest &fixture) {
+    fixture.setUp();
+    auto &engine = fixture.getEngine();
+    engine.put("counter", "0");
+
+    const int num_threads = 4;
+    const int increments = 50;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; t++) {
+        threads.emplace_back([&engine]() {
+            for (int i = 0; i < increments; i++) {
+                while (true) {
+                    Transaction txn(engine);
+                    Entry out;
+                    txn.get("counter", out);
+                    txn.put("counter", std::to_string(std::stoi(out.value) + 1));
+                    if (txn.commit()) {
+                        break;
+                    }
+                }
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    Entry out;
+    ASSERT_TRUE(engine.get("counter", out), "Counter should exist");
+    ASSERT_EQ(out.value, std::to_string(num_threads * increments), "No increment should be lost");
+
+    return true;
+}
+
+bool test_transaction_recovered_from_wal(TransactionTest &fixture) {
+    fixture.setUp();
+    {
+        auto &engine = fixture.getEngine();
+        engine.put("a", "old");
+        engine.put("c", "old");
+        Transaction txn(engine);
+        txn.put("a", "new");
+        txn.put("b", "new");
+        txn.del("c");
+        ASSERT_TRUE(txn.commit(), "Commit should succeed");
+        engine.put("d", "after");
+    }
+
+    fixture.reopen();
+    auto &engine = fixture.getEngine();
+    Entry out;
+    ASSERT_TRUE(engine.get("a", out) && out.value == "new", "Recovered transaction should overwrite a");
+    ASSERT_TRUE(engine.get("b", out) && out.value == "new", "Recovered transaction should insert b");
+    ASSERT_TRUE(!engine.get("c", out), "Recovered transaction should delete c");
+    ASSERT_TRUE(engine.get("d", out) && out.value == "after", "Writes after the transaction should recover");
+
+    // Sequence numbers continue past every write of the transaction
+    engine.put("a", "newest");
+    ASSERT_TRUE(engine.get("a", out) && out.value == "newest", "Writes after recovery should win");
+
+    return true;
+}
+
+bool test_transaction_encoding(TransactionTest &) {
+    std::map<std::string, std::optional<std::string>> writes{{"a", "1"}, {"b", std::nullopt}, {"c", std::string(300, 'x')}};
+    std::string encoded = encodeTransactionWrites(writes);
+
+    std::vector<MemTableWrite> decoded;
+    ASSERT_TRUE(decodeTransactionWrites(encoded, 10, decoded), "Encoded writes should decode");
+    ASSERT_EQ(decoded.size(), 3u, "Every write should decode");
+    ASSERT_TRUE(decoded[0].op == Operation::PUT && decoded[0].key == "a" && decoded[0].value == "1", "First write should match");
+    ASSERT_TRUE(decoded[1].op == Operation::DELETE && decoded[1].key == "b", "Second write should be a delete");
+    ASSERT_EQ(decoded[2].value.size(), 300u, "Long value should decode");
+    ASSERT_TRUE(decoded[0].seq == 10 && decoded[1].seq == 11 && decoded[2].seq == 12, "Writes should take consecutive seqs");
+
+    std::vector<MemTableWrite> truncated;
+    ASSERT_TRUE(!decodeTransactionWrites(encoded.substr(0, encoded.size() - 1), 10, truncated), "Truncated writes should fail");
+    ASSERT_TRUE(truncated.empty(), "A failed decode should append nothing");
+
+    return true;
+}
+
+void run_transaction_tests(TestFramework &framework) {
+    TransactionTest fixture;
+    std::cout << "Running Transaction Tests" << std::endl;
+    std::cout << "========================================" << std::endl;
+    framework.run("test_transaction_commit", [&]() { return test_transaction_commit(fixture); });
+    framework.run("test_transaction_reads_own_writes", [&]() { return test_transaction_reads_own_writes(fixture); });
+    framework.run("test_transaction_conflict", [&]() { return test_transaction_conflict(fixture); });
+    framework.run("test_transaction_conflict_after_flush", [&]() { return test_transaction_conflict_after_flush(fixture); });
+    framework.run("test_transaction_conflict_with_unapplied_write",
+                  [&]() { return test_transaction_conflict_with_unapplied_write(fixture); });
+    framework.run("test_transaction_concurrent_increments", [&]() { return test_transaction_concurrent_increments(fixture); });
+    framework.run("test_transaction_recovered_from_wal", [&]() { return test_transaction_recovered_from_wal(fixture); });
+    framework.run("test_transaction_encoding", [&]() { return test_transaction_encoding(fixture); });
+    fixture.tearDown();
+    std::cout << "========================================" << std::endl;
+}
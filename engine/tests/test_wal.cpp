@@ -151,6 +151,57 @@ bool test_empty_wal(WriteAheadLogTest &fixture) {
     return true;
 }
 
+bool test_sync_ticket_covers_earlier_appends(WriteAheadLogTest &fixture) {
+    fixture.setUp();
+    auto &wal = fixture.wal();
+
+    wal.append(Operation::PUT, "key1", "value1", 1);
+    uint64_t first = wal.requestSync();
+    wal.append(Operation::PUT, "key2", "value2", 2);
+    uint64_t second = wal.requestSync();
+    ASSERT_TRUE(second > first, "Later requests should get later tickets");
+
+    wal.waitForSync(second);
+
+    std::vector<std::string> keys;
+    wal.replay([&](uint64_t, Operation, std::string &key, std::string &) { keys.push_back(key); });
+    ASSERT_EQ(keys.size(), 2, "Both appends should be durable once the later ticket is synced");
+    ASSERT_EQ(keys[1], "key2", "Records should keep their order");
+
+    return true;
+}
+
+bool test_rotated_log_replayed_until_removed(WriteAheadLogTest &fixture) {
+    fixture.setUp();
+    auto &wal = fixture.wal();
+
+    wal.append(Operation::PUT, "a", "1", 1);
+    wal.rotate();
+    wal.append(Operation::PUT, "b", "2", 2);
+    wal.flush();
+
+    std::vector<uint64_t> seqs;
+    auto collect = [&seqs](uint64_t seq, Operation, std::string &, std::string &) { seqs.push_back(seq); };
+    wal.replay(collect);
+    ASSERT_TRUE(seqs == std::vector<uint64_t>({1, 2}), "Rotated records should replay ahead of the current ones");
+
+    // A rotated log left over from before a restart takes in the next one rather than being replaced
+    fixture.restartWal();
+    fixture.wal().rotate();
+    fixture.wal().append(Operation::PUT, "c", "3", 3);
+    fixture.wal().flush();
+    seqs.clear();
+    fixture.wal().replay(collect);
+    ASSERT_TRUE(seqs == std::vector<uint64_t>({1, 2, 3}), "No record should be lost across rotations");
+
+    fixture.wal().removeRotated();
+    seqs.clear();
+    fixture.wal().replay(collect);
+    ASSERT_TRUE(seqs == std::vector<uint64_t>({3}), "Removed rotated log should no longer replay");
+
+    return true;
+}
+
 void run_wal_tests(TestFramework &framework) {
     WriteAheadLogTest fixture("data/log.bin");
     std::cout << "Running WAL Tests" << std::endl;
@@ -161,5 +212,7 @@ void run_wal_tests(TestFramework &framework) {
     framework.run("test_corruption_stops_replay", [&]() { return test_corruption_stops_replay(fixture); });
     framework.run("test_truncated_record_not_applied", [&]() { return test_truncated_record_not_applied(fixture); });
     framework.run("test_empty_wal", [&]() { return test_empty_wal(fixture); });
+    framework.run("test_sync_ticket_covers_earlier_appends", [&]() { return test_sync_ticket_covers_earlier_appends(fixture); });
+    framework.run("test_rotated_log_replayed_until_removed", [&]() { return test_rotated_log_replayed_until_removed(fixture); });
     std::cout << "========================================" << std::endl;
 }
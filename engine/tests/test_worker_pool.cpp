@@ -0,0 +1,111 @@
+#include "test_framework.h"
+#include "worker_pool.h"
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+class WorkerPoolTest {
+  public:
+    WorkerPoolTest() {
+        setUp();
+    }
+
+    static void setUp() {
+        // Tests create their own pools as needed
+    }
+};
+
+bool test_worker_pool_runs_jobs(WorkerPoolTest &fixture) {
+    fixture.setUp();
+    WorkerPool pool(4);
+    ASSERT_EQ(pool.size(), 4u, "Pool should start the requested threads");
+
+    std::atomic<int> counter{0};
+    std::vector<std::future<void>> futures;
+    for (int i = 0; i < 100; i++) {
+        futures.push_back(pool.submit([&counter] { counter.fetch_add(1); }));
+    }
+    for (auto &f : futures) {
+        f.get();
+    }
+
+    ASSERT_EQ(counter.load(), 100, "Every job should run once");
+
+    return true;
+}
+
+bool test_worker_pool_runs_in_parallel(WorkerPoolTest &fixture) {
+    fixture.setUp();
+    WorkerPool pool(2);
+
+    // Each job waits for the other, so they can only finish if both run at once
+    std::atomic<int> arrived{0};
+    auto rendezvous = [&arrived] {
+        arrived.fetch_add(1);
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (arrived.load() < 2 && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::yield();
+        }
+    };
+
+    auto a = pool.submit(rendezvous);
+    auto b = pool.submit(rendezvous);
+    a.get();
+    b.get();
+
+    ASSERT_EQ(arrived.load(), 2, "Both jobs should have run concurrently");
+
+    return true;
+}
+
+bool test_worker_pool_propagates_exceptions(WorkerPoolTest &fixture) {
+    fixture.setUp();
+    WorkerPool pool(1);
+
+    auto failing = pool.submit([] { throw std::runtime_error("job failed"); });
+    bool caught = false;
+    try {
+        failing.get();
+    } catch (const std::runtime_error &) {
+        caught = true;
+    }
+    ASSERT_TRUE(caught, "Job exception should surface through its future");
+
+    std::atomic<bool> ran{false};
+    pool.submit([&ran] { ran = true; }).get();
+    ASSERT_TRUE(ran.load(), "Worker should keep running after a failed job");
+
+    return true;
+}
+
+bool test_worker_pool_drains_on_destruction(WorkerPoolTest &fixture) {
+    fixture.setUp();
+    std::atomic<int> counter{0};
+    {
+        WorkerPool pool(1);
+        for (int i = 0; i < 20; i++) {
+            pool.submit([&counter] {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                counter.fetch_add(1);
+            });
+        }
+    }
+
+    ASSERT_EQ(counter.load(), 20, "Queued jobs should finish before the pool is destroyed");
+
+    return true;
+}
+
+void run_worker_pool_tests(TestFramework &framework) {
+    WorkerPoolTest fixture;
+
+    std::cout << "Running Worker Pool Tests" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    framework.run("test_worker_pool_runs_jobs", [&]() { return test_worker_pool_runs_jobs(fixture); });
+    framework.run("test_worker_pool_runs_in_parallel", [&]() { return test_worker_pool_runs_in_parallel(fixture); });
+    framework.run("test_worker_pool_propagates_exceptions", [&]() { return test_worker_pool_propagates_exceptions(fixture); });
+    framework.run("test_worker_pool_drains_on_destruction", [&]() { return test_worker_pool_drains_on_destruction(fixture); });
+}
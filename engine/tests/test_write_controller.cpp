@@ -0,0 +1,159 @@
+#include "test_framework.h"
+#include "write_controller.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+class WriteControllerTest {
+  public:
+    WriteControllerTest() {
+        setUp();
+    }
+
+    static void setUp() {
+        // Tests create their own controllers as needed
+    }
+
+    static double elapsedMs(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+};
+
+bool test_write_controller_normal(WriteControllerTest &fixture) {
+    fixture.setUp();
+    WriteController controller(4, 8, 1000, 2000, 1024);
+
+    controller.update(3, 999);
+    ASSERT_TRUE(controller.condition() == WriteStallCondition::NORMAL, "Below every limit should be normal");
+
+    auto start = std::chrono::steady_clock::now();
+    controller.throttle(1024 * 1024);
+    ASSERT_TRUE(WriteControllerTest::elapsedMs(start) < 50.0, "Normal writes should not be delayed");
+
+    WriteStallStats stats = controller.stats();
+    ASSERT_EQ(stats.l0_slowdowns + stats.l0_stops + stats.pending_compaction_slowdowns + stats.pending_compaction_stops, 0u,
+              "No stall should be counted");
+
+    return true;
+}
+
+bool test_write_controller_l0_slowdown(WriteControllerTest &fixture) {
+    fixture.setUp();
+    WriteController controller(4, 8, 0, 0, 1024 * 1024);
+
+    controller.update(4, 0);
+    ASSERT_TRUE(controller.condition() == WriteStallCondition::DELAYED, "L0 at the slowdown trigger should delay writes");
+
+    // 100 KiB at 1 MiB/s
+    auto start = std::chrono::steady_clock::now();
+    controller.throttle(100 * 1024);
+    double ms = WriteControllerTest::elapsedMs(start);
+    ASSERT_TRUE(ms >= 80.0, "Delayed writes should be paced at the delayed write rate");
+
+    WriteStallStats stats = controller.stats();
+    ASSERT_EQ(stats.l0_slowdowns, 1u, "Slowdown should be attributed to L0");
+    ASSERT_EQ(stats.pending_compaction_slowdowns, 0u, "Pending bytes are under their limit");
+    ASSERT_TRUE(stats.delayed_micros > 0, "Delay time should be recorded");
+
+    return true;
+}
+
+bool test_write_controller_delay_grows_towards_stop(WriteControllerTest &fixture) {
+    fixture.setUp();
+    WriteController controller(0, 0, 1000, 2000, 1024 * 1024);
+
+    controller.update(0, 1000);
+    auto start = std::chrono::steady_clock::now();
+    controller.throttle(50 * 1024);
+    double atSoft = WriteControllerTest::elapsedMs(start);
+
+    // Nearly at the hard limit the pace drops to a tenth
+    controller.update(0, 1990);
+    start = std::chrono::steady_clock::now();
+    controller.throttle(50 * 1024);
+    double nearHard = WriteControllerTest::elapsedMs(start);
+
+    ASSERT_TRUE(nearHard > atSoft * 3, "Delay should grow as pending bytes approach the hard limit");
+    ASSERT_EQ(controller.stats().pending_compaction_slowdowns, 2u, "Both slowdowns should be attributed to pending bytes");
+
+    return true;
+}
+
+bool test_write_controller_stop_until_cleared(WriteControllerTest &fixture) {
+    fixture.setUp();
+    WriteController controller(4, 8, 0, 0, 1024 * 1024);
+    controller.update(8, 0);
+    ASSERT_TRUE(controller.condition() == WriteStallCondition::STOPPED, "L0 at the stop trigger should stop writes");
+
+    std::atomic<bool> done{false};
+    std::thread writer([&] {
+        controller.throttle(10);
+        done = true;
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    bool blocked = !done.load();
+
+    controller.update(2, 0);
+    writer.join();
+
+    ASSERT_TRUE(blocked, "Writer should block while stopped");
+    ASSERT_TRUE(done.load(), "Writer should resume once compaction catches up");
+
+    WriteStallStats stats = controller.stats();
+    ASSERT_EQ(stats.l0_stops, 1u, "Stop should be attributed to L0");
+    ASSERT_TRUE(stats.stopped_micros >= 40'000, "Stop time should be recorded");
+    ASSERT_TRUE(stats.condition == WriteStallCondition::NORMAL, "Condition should be reported");
+
+    return true;
+}
+
+bool test_write_controller_shutdown_releases_writer(WriteControllerTest &fixture) {
+    fixture.setUp();
+    WriteController controller(0, 0, 0, 100, 1024);
+    controller.update(0, 100);
+    ASSERT_TRUE(controller.condition() == WriteStallCondition::STOPPED, "Pending bytes at the hard limit should stop writes");
+
+    std::thread writer([&] { controller.throttle(10); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    controller.shutdown();
+    writer.join();
+
+    ASSERT_EQ(controller.stats().pending_compaction_stops, 1u, "Stop should be attributed to pending bytes");
+
+    auto start = std::chrono::steady_clock::now();
+    controller.throttle(1024 * 1024);
+    ASSERT_TRUE(WriteControllerTest::elapsedMs(start) < 50.0, "No throttling after shutdown");
+
+    return true;
+}
+
+bool test_write_controller_memtable_stops(WriteControllerTest &fixture) {
+    fixture.setUp();
+    WriteController controller(4, 8, 0, 0, 1024);
+
+    controller.recordMemtableStop(1500);
+    controller.recordMemtableStop(500);
+
+    WriteStallStats stats = controller.stats();
+    ASSERT_EQ(stats.memtable_stops, 2u, "Memtable stops should be counted");
+    ASSERT_EQ(stats.stopped_micros, 2000u, "Memtable stop time should be recorded");
+
+    return true;
+}
+
+void run_write_controller_tests(TestFramework &framework) {
+    WriteControllerTest fixture;
+
+    std::cout << "Running Write Controller Tests" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    framework.run("test_write_controller_normal", [&]() { return test_write_controller_normal(fixture); });
+    framework.run("test_write_controller_l0_slowdown", [&]() { return test_write_controller_l0_slowdown(fixture); });
+    framework.run("test_write_controller_delay_grows_towards_stop",
+                  [&]() { return test_write_controller_delay_grows_towards_stop(fixture); });
+    framework.run("test_write_controller_stop_until_cleared", [&]() { return test_write_controller_stop_until_cleared(fixture); });
+    framework.run("test_write_controller_shutdown_releases_writer",
+                  [&]() { return test_write_controller_shutdown_releases_writer(fixture); });
+    framework.run("test_write_controller_memtable_stops", [&]() { return test_write_controller_memtable_stops(fixture); });
+}
@@ -2,6 +2,7 @@
 #include "write_queue.h"
 #include <atomic>
 #include <chrono>
+#include <memory>
 #include <ostream>
 #include <thread>
 #include <vector>
@@ -303,7 +304,7 @@ bool test_completion_promise(WriteQueueTest &fixture) {
     std::thread processor([&queue]() {
         auto req = queue.pop();
         if (req.has_value()) {
-            (*req)->completion.set_value(true);
+            (*req)->completion->set_value(true);
         }
     });
 
@@ -534,6 +535,237 @@ bool test_stress_rapid_push_pop(WriteQueueTest &fixture) {
     return true;
 }
 
+bool test_ring_wraps_around(WriteQueueTest &fixture) {
+    fixture.setUp();
+
+    WriteQueue queue(3);
+
+    for (int i = 0; i < 100; i++) {
+        queue.push(Operation::PUT, "key" + std::to_string(i), "value" + std::to_string(i));
+        if (i % 3 == 2) {
+            auto batch = queue.popBatch(10);
+            ASSERT_EQ(batch.size(), 3, "Batch should drain the full ring");
+            for (int j = 0; j < 3; j++) {
+                ASSERT_EQ(batch[j]->key, "key" + std::to_string(i - 2 + j), "Order should survive wrapping");
+            }
+        }
+    }
+    ASSERT_EQ(queue.size(), 1, "Last push should still be queued");
+
+    return true;
+}
+
+bool test_parked_consumer_woken_by_push(WriteQueueTest &fixture) {
+    fixture.setUp();
+
+    WriteQueue queue(100);
+
+    std::atomic<size_t> received{0};
+    std::thread consumer([&queue, &received]() {
+        auto batch = queue.popBatch(10);
+        received = batch.size();
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    ASSERT_EQ(received.load(), 0, "Consumer should be parked on the empty queue");
+
+    queue.push(Operation::PUT, "key1", "value1");
+    consumer.join();
+    ASSERT_EQ(received.load(), 1, "Push should wake the parked consumer");
+
+    return true;
+}
+
+bool test_producers_keep_their_order(WriteQueueTest &fixture) {
+    fixture.setUp();
+
+    WriteQueue queue(16);
+    const int num_producers = 4;
+    const int items_per_producer = 2000;
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < num_producers; p++) {
+        producers.emplace_back([&queue, p]() {
+            for (int i = 0; i < items_per_producer; i++) {
+                queue.push(Operation::PUT, std::to_string(p), std::to_string(i));
+            }
+        });
+    }
+
+    std::vector<int> next(num_producers, 0);
+    bool ordered = true;
+    int consumed = 0;
+    while (consumed < num_producers * items_per_producer) {
+        for (auto &request : queue.popBatch(64)) {
+            int producer = std::stoi(request->key);
+            ordered = ordered && std::stoi(request->value) == next[producer];
+            next[producer]++;
+            consumed++;
+        }
+    }
+
+    for (auto &producer : producers) {
+        producer.join();
+    }
+
+    ASSERT_TRUE(ordered, "Requests from one producer should be popped in push order");
+    ASSERT_EQ(queue.size(), 0, "Queue should be empty");
+
+    return true;
+}
+
+bool test_waiter_wakes_caller_owned_request(WriteQueueTest &fixture) {
+    fixture.setUp();
+
+    WriteQueue queue(100);
+    WriteWaiter waiter;
+    WriteRequest request(Operation::PUT, "key1", "value1", &waiter);
+
+    std::thread processor([&queue]() {
+        // Give the waiter time to park so the futex wake-up is exercised
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        auto req = queue.pop();
+        if (req.has_value()) {
+            WriteQueue::complete(std::move(*req), true);
+        }
+    });
+
+    queue.push(request);
+    ASSERT_TRUE(waiter.wait(), "Waiter should report the completed write");
+
+    processor.join();
+
+    return true;
+}
+
+// The waiter is freed the moment wait() returns, so the waking thread must be done with it by then
+bool test_waiter_freed_right_after_wait(WriteQueueTest &fixture) {
+    fixture.setUp();
+
+    WriteQueue queue(100);
+    const int rounds = 500;
+    std::thread processor([&queue]() {
+        for (int i = 0; i < rounds; i++) {
+            auto req = queue.pop();
+            if (req.has_value()) {
+                WriteQueue::complete(std::move(*req), true);
+            }
+        }
+    });
+
+    bool all_ok = true;
+    for (int i = 0; i < rounds; i++) {
+        auto waiter = std::make_unique<WriteWaiter>();
+        WriteRequest request(Operation::PUT, "key", "value", waiter.get());
+        queue.push(request);
+        all_ok &= waiter->wait();
+        waiter.reset();
+    }
+    processor.join();
+    ASSERT_TRUE(all_ok, "Every write should be reported as successful");
+
+    return true;
+}
+
+bool test_waiter_counts_down_a_batch(WriteQueueTest &fixture) {
+    fixture.setUp();
+
+    WriteQueue queue(100);
+    WriteWaiter waiter(3);
+    std::vector<WriteRequest> requests;
+    requests.reserve(3);
+    for (int i = 0; i < 3; i++) {
+        requests.emplace_back(Operation::PUT, "key" + std::to_string(i), "value", &waiter);
+    }
+    for (auto &request : requests) {
+        queue.push(request);
+    }
+
+    std::atomic<bool> done{false};
+    std::atomic<bool> ok{true};
+    std::thread waiting([&]() {
+        ok.store(waiter.wait());
+        done.store(true);
+    });
+
+    auto batch = queue.popBatch(10);
+    ASSERT_EQ(batch.size(), 3, "Batch should hold every request");
+    WriteQueue::complete(std::move(batch[0]), true);
+    WriteQueue::complete(std::move(batch[1]), false);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    ASSERT_TRUE(!done.load(), "Waiter should not wake before the last write");
+
+    WriteQueue::complete(std::move(batch[2]), true);
+    waiting.join();
+    ASSERT_TRUE(done.load(), "Waiter should wake after the last write");
+    ASSERT_TRUE(!ok.load(), "One failed write should fail the batch");
+
+    return true;
+}
+
+bool test_completion_callback(WriteQueueTest &fixture) {
+    fixture.setUp();
+
+    WriteQueue queue(100);
+    std::atomic<int> calls{0};
+    std::atomic<bool> result{false};
+    queue.push(Operation::PUT, "key1", "value1", [&](bool ok) {
+        result.store(ok);
+        calls++;
+    });
+
+    auto req = queue.pop();
+    ASSERT_TRUE(req.has_value(), "Callback request should be queued");
+    ASSERT_EQ((*req)->key, "key1", "Key should match");
+    WriteQueue::complete(std::move(*req), true);
+    ASSERT_EQ(calls.load(), 1, "Callback should run once on completion");
+    ASSERT_TRUE(result.load(), "Callback should get the result");
+
+    queue.shutdown();
+    queue.push(Operation::PUT, "key2", "value2", [&](bool ok) {
+        result.store(ok);
+        calls++;
+    });
+    ASSERT_EQ(calls.load(), 2, "Callback should run right away after shutdown");
+    ASSERT_TRUE(!result.load(), "Callback should report failure after shutdown");
+
+    return true;
+}
+
+bool test_push_after_shutdown_notifies_waiter(WriteQueueTest &fixture) {
+    fixture.setUp();
+
+    WriteQueue queue(100);
+    queue.shutdown();
+
+    WriteWaiter waiter;
+    WriteRequest request(Operation::PUT, "key1", "value1", &waiter);
+    queue.push(request);
+
+    ASSERT_TRUE(!waiter.wait(), "Waiter should report failure after shutdown");
+    ASSERT_EQ(queue.size(), 0, "Request should not be queued");
+
+    return true;
+}
+
+bool test_destroyed_queue_fails_pending_requests(WriteQueueTest &fixture) {
+    fixture.setUp();
+
+    std::future<bool> future;
+    WriteWaiter waiter;
+    WriteRequest request(Operation::DELETE, "key2", "", &waiter);
+    {
+        WriteQueue queue(100);
+        future = queue.push(Operation::PUT, "key1", "value1");
+        queue.push(request);
+    }
+
+    ASSERT_TRUE(!future.get(), "Queued future should fail when the queue is destroyed");
+    ASSERT_TRUE(!waiter.wait(), "Queued waiter should fail when the queue is destroyed");
+
+    return true;
+}
+
 void run_write_queue_tests(TestFramework &framework) {
     WriteQueueTest fixture;
 
@@ -560,4 +792,13 @@ void run_write_queue_tests(TestFramework &framework) {
     framework.run("test_empty_key_and_value", [&]() { return test_empty_key_and_value(fixture); });
     framework.run("test_special_characters_in_keys", [&]() { return test_special_characters_in_keys(fixture); });
     framework.run("test_stress_rapid_push_pop", [&]() { return test_stress_rapid_push_pop(fixture); });
+    framework.run("test_ring_wraps_around", [&]() { return test_ring_wraps_around(fixture); });
+    framework.run("test_parked_consumer_woken_by_push", [&]() { return test_parked_consumer_woken_by_push(fixture); });
+    framework.run("test_producers_keep_their_order", [&]() { return test_producers_keep_their_order(fixture); });
+    framework.run("test_waiter_wakes_caller_owned_request", [&]() { return test_waiter_wakes_caller_owned_request(fixture); });
+    framework.run("test_waiter_counts_down_a_batch", [&]() { return test_waiter_counts_down_a_batch(fixture); });
+    framework.run("test_waiter_freed_right_after_wait", [&]() { return test_waiter_freed_right_after_wait(fixture); });
+    framework.run("test_completion_callback", [&]() { return test_completion_callback(fixture); });
+    framework.run("test_push_after_shutdown_notifies_waiter", [&]() { return test_push_after_shutdown_notifies_waiter(fixture); });
+    framework.run("test_destroyed_queue_fails_pending_requests", [&]() { return test_destroyed_queue_fails_pending_requests(fixture); });
 }
@@ -14,6 +14,8 @@ namespace kv {
 class ConfigParser {
   public:
     static std::optional<ServerConfig> load(const std::string &filepath);
+    // Row cache bytes for a cache_size given in entries, as configs written before the cache was sized in bytes do
+    static size_t cacheBytesForEntries(size_t entries);
 
   private:
     static std::string trim(const std::string &s);
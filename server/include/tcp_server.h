@@ -43,7 +43,10 @@ struct ServerConfig {
     uint16_t port = 9000;
     int num_threads = 4;
     std::string data_dir = "data";
-    size_t cache_size = 1000;
+    size_t cache_bytes = 8 * 1024 * 1024;
+    // DELETE writes the tombstone without reading the key first and answers MAYBE_DELETED.
+    // Off: every DELETE looks the key up and answers DELETED or DELETE_FAILED.
+    bool blind_deletes = true;
     int accept_timeout_ms = 1000;
     size_t max_connections = 1000;
 
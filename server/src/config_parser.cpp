@@ -123,7 +123,15 @@ std::optional<kv::ServerConfig> kv::ConfigParser::load(const std::string &filepa
         config.data_dir = it->second;
     }
     if (auto it = values.find("storage.cache_size"); it != values.end()) {
-        config.cache_size = static_cast<size_t>(std::stoi(it->second));
+        config.cache_bytes = cacheBytesForEntries(static_cast<size_t>(std::stoull(it->second)));
+        std::cerr << "[ConfigParser] Warning: storage.cache_size counts entries and is deprecated; using " << config.cache_bytes
+                  << " bytes. Set storage.cache_bytes instead" << std::endl;
+    }
+    if (auto it = values.find("storage.cache_bytes"); it != values.end()) {
+        config.cache_bytes = static_cast<size_t>(std::stoull(it->second));
+    }
+    if (auto it = values.find("storage.blind_deletes"); it != values.end()) {
+        config.blind_deletes = it->second != "false";
     }
     if (auto it = values.find("node.id"); it != values.end()) {
         config.node_id = static_cast<uint32_t>(std::stoi(it->second));
@@ -146,6 +154,12 @@ std::optional<kv::ServerConfig> kv::ConfigParser::load(const std::string &filepa
     return config;
 }
 
+size_t kv::ConfigParser::cacheBytesForEntries(size_t entries) {
+    // A small record: key, value and the cache's per-entry bookkeeping
+    constexpr size_t bytesPerEntry = 256;
+    return entries * bytesPerEntry;
+}
+
 std::string kv::ConfigParser::trim(const std::string &s) {
     size_t start = s.find_first_not_of(" \t\r\n");
     if (start == std::string::npos)
@@ -24,8 +24,10 @@ void printUsage(const char *prog) {
               << "  -p, --port PORT      Port to listen on (default: 9000)\n"
               << "  -h, --host HOST      Host to bind to (default: 127.0.0.1)\n"
               << "  -t, --threads NUM    Number of worker threads (default: 4)\n"
-              << "  -c, --cache SIZE     LRU cache size (default: 1000)\n"
+              << "  -c, --cache ENTRIES  Row cache size in entries, converted to bytes (deprecated)\n"
+              << "  --cache-bytes BYTES  Row cache size in bytes (default: 8388608)\n"
               << "  -d, --data DIR       Data directory (default: data)\n"
+              << "  --checked-deletes    Look keys up before DELETE to report whether they existed\n"
               << "  --node-id ID         Node ID for replication\n"
               << "  --role ROLE          Node role: leader or follower\n"
               << "  --help               Show this help message\n"
@@ -82,13 +84,17 @@ int main(int argc, char *argv[]) {
         } else if ((arg == "-t" || arg == "--threads") && i + 1 < argc) {
             config.num_threads = static_cast<size_t>(std::stoi(argv[++i]));
         } else if ((arg == "-c" || arg == "--cache") && i + 1 < argc) {
-            config.cache_size = static_cast<size_t>(std::stoi(argv[++i]));
+            config.cache_bytes = kv::ConfigParser::cacheBytesForEntries(static_cast<size_t>(std::stoull(argv[++i])));
+        } else if (arg == "--cache-bytes" && i + 1 < argc) {
+            config.cache_bytes = static_cast<size_t>(std::stoull(argv[++i]));
         } else if ((arg == "-d" || arg == "--data") && i + 1 < argc) {
             config.data_dir = argv[++i];
         } else if (arg == "--node-id" && i + 1 < argc) {
             config.node_id = static_cast<uint32_t>(std::stoi(argv[++i]));
         } else if (arg == "--role" && i + 1 < argc) {
             config.role = argv[++i];
+        } else if (arg == "--checked-deletes") {
+            config.blind_deletes = false;
         } else {
             std::cerr << "Unknown argument: " << arg << std::endl;
             printUsage(argv[0]);
@@ -110,7 +116,7 @@ int main(int argc, char *argv[]) {
     std::cout << "  Host:       " << config.host << std::endl;
     std::cout << "  Port:       " << config.port << std::endl;
     std::cout << "  Threads:    " << config.num_threads << std::endl;
-    std::cout << "  Cache Size: " << config.cache_size << std::endl;
+    std::cout << "  Cache Bytes: " << config.cache_bytes << std::endl;
     std::cout << "  Data Dir:   " << config.data_dir << std::endl;
     std::cout << "  Peers:      " << config.peers.size() << std::endl;
     for (const auto &[host, port] : config.peers) {
@@ -94,7 +94,7 @@ void ThreadPool::workerLoop() {
 TcpServer::TcpServer(const ServerConfig &config) : config_(config), thread_pool_(std::make_unique<ThreadPool>(config.num_threads)) {
 
     // Initialize storage engine
-    engine_ = std::make_unique<StorageEngine>(config_.data_dir, config_.cache_size);
+    engine_ = std::make_unique<StorageEngine>(config_.data_dir, EngineOptions{.row_cache_bytes = config_.cache_bytes});
     std::cout << "[Server] Storage engine initialized with data directory: " << config_.data_dir << std::endl;
 
     // Initialize distributed layer if configured
@@ -319,6 +319,10 @@ Response TcpServer::executeCommand(const Request &req) {
         }
 
         case CommandType::DELETE: {
+            if (config_.blind_deletes) {
+                bool success = engine_->blindDel(req.key);
+                return success ? Response::ok("MAYBE_DELETED") : Response::error("DELETE_FAILED");
+            }
             bool success = engine_->del(req.key);
             return success ? Response::ok("DELETED") : Response::error("DELETE_FAILED");
         }
@@ -368,7 +372,7 @@ void TcpServer::applyLogEntry(const distributed::LogEntry &entry) {
             break;
 
         case distributed::ReplicationOp::DELETE:
-            engine_->del(entry.key);
+            engine_->blindDel(entry.key);
             break;
         }
     } catch (const std::exception &e) {
@@ -48,7 +48,7 @@ peers:
     port: 9102
 storage:
   data_dir: "/app/data"
-  cache_size: 1000
+  cache_bytes: 8388608
 logging:
   level: "info"
 EOF
@@ -70,7 +70,7 @@ peers:
     port: 910$((NODE_ID==2?2:1))
 storage:
   data_dir: "/app/data"
-  cache_size: 1000
+  cache_bytes: 8388608
 logging:
   level: "info"
 EOF
@@ -39,7 +39,7 @@ peers:
 %{ endif ~}
 storage:
   data_dir: "/app/data"
-  cache_size: 1000
+  cache_bytes: 8388608
 logging:
   level: "info"
 EOF